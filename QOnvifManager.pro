@@ -1,8 +1,21 @@
 TEMPLATE = subdirs
 
-SUBDIRS += QOnvifManger QOnvifMangerTester
+SUBDIRS += QOnvifManger QOnvifMangerTester QOnvifManagerBench \
+    QOnvifDiscoveryBench QOnvifSimulator OnvifSim OnvifLoadgen \
+    QOnvifManagerTests
 
 QOnvifManger.file = src/QOnvifManager.pro
 QOnvifMangerTester.file = test/QOnvifManagerTester.pro
+QOnvifManagerBench.file = bench/QOnvifManagerBench.pro
+QOnvifDiscoveryBench.file = bench/QOnvifDiscoveryBench.pro
+QOnvifSimulator.file = sim/QOnvifSimulator.pro
+OnvifSim.file = sim/onvif-sim.pro
+OnvifLoadgen.file = loadgen/onvif-loadgen.pro
+QOnvifManagerTests.file = tests/QOnvifManagerTests.pro
 
 QOnvifMangerTester.depends = QOnvifManger
+QOnvifManagerBench.depends = QOnvifManger
+QOnvifDiscoveryBench.depends = QOnvifManger
+OnvifSim.depends = QOnvifSimulator
+OnvifLoadgen.depends = QOnvifManger
+QOnvifManagerTests.depends = QOnvifManger QOnvifSimulator
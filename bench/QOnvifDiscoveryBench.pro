@@ -0,0 +1,30 @@
+#-------------------------------------------------
+#
+# Discovery storm: synthetic ProbeMatches flooded at the DeviceSearcher
+# socket on loopback, counted per stage and gated on the drop rate
+#
+#   QOnvifDiscoveryBench -o results.xml,xml
+#
+#-------------------------------------------------
+
+QT       += core network xml xmlpatterns testlib
+QT       -= gui
+
+CONFIG   += c++11 console testcase
+CONFIG   -= app_bundle
+
+QMAKE_RPATHDIR += .
+
+DESTDIR  = ../../../bin
+TARGET = QOnvifDiscoveryBench
+TEMPLATE = app
+
+DEFINES += FIXTURES_DIR=\\\"$$PWD/fixtures\\\"
+
+SOURCES += \
+    discoverystorm.cpp
+
+LIBS += -L$$PWD/../../../bin/ -lQOnvifManager
+
+INCLUDEPATH += $$PWD/../include
+DEPENDPATH += $$PWD/../include
@@ -0,0 +1,39 @@
+#-------------------------------------------------
+#
+# Parser and serializer benchmarks over recorded responses
+#
+#   QOnvifManagerBench -o results.xml,xml
+#   python3 compare_baseline.py results.xml            (compare)
+#   python3 compare_baseline.py results.xml --update   (new baseline)
+#
+#-------------------------------------------------
+
+QT       += core network xml xmlpatterns testlib
+QT       -= gui
+
+CONFIG   += c++11 console testcase
+CONFIG   -= app_bundle
+
+QMAKE_RPATHDIR += .
+
+DESTDIR  = ../../../bin
+TARGET = QOnvifManagerBench
+TEMPLATE = app
+
+DEFINES += FIXTURES_DIR=\\\"$$PWD/fixtures\\\"
+
+SOURCES += \
+    fixturenetwork.cpp \
+    qonvifmanagerbench.cpp
+
+HEADERS += \
+    fixturenetwork.hpp
+
+LIBS += -L$$PWD/../../../bin/ -lQOnvifManager
+
+INCLUDEPATH += $$PWD/../include
+INCLUDEPATH += $$PWD/../include/QOnvifManager
+INCLUDEPATH += $$PWD/../include/QOnvifManager/device_management
+INCLUDEPATH += $$PWD/../include/QOnvifManager/media_management
+INCLUDEPATH += $$PWD/../include/QOnvifManager/ptz_management
+DEPENDPATH += $$PWD/../include
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Compares a QOnvifManagerBench run against baseline.json.
+
+    QOnvifManagerBench -o results.xml,xml
+    compare_baseline.py results.xml [--threshold 10] [--update]
+
+Results are keyed "function/tag" with the per iteration value of the metric
+(wall time in ms unless the bench ran with -tickcounter, -callgrind, ...).
+Exits with 1 when any result is slower than the baseline by more than the
+threshold, --update writes the run as the new baseline instead.
+"""
+
+import argparse
+import json
+import os
+import sys
+import xml.etree.ElementTree as ElementTree
+
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        "baseline.json")
+
+
+def read_results(path):
+    results = {}
+    root = ElementTree.parse(path).getroot()
+    for function in root.iter("TestFunction"):
+        for result in function.iter("BenchmarkResult"):
+            key = function.get("name")
+            if result.get("tag"):
+                key += "/" + result.get("tag")
+            results[key] = {
+                "metric": result.get("metric"),
+                "value": float(result.get("value")),
+            }
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("results", help="xml output of QOnvifManagerBench")
+    parser.add_argument("--baseline", default=BASELINE)
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent")
+    parser.add_argument("--update", action="store_true",
+                        help="write the results as the new baseline")
+    args = parser.parse_args()
+
+    results = read_results(args.results)
+    if not results:
+        sys.exit("no benchmark results in " + args.results)
+
+    if args.update:
+        with open(args.baseline, "w") as file:
+            json.dump(results, file, indent=2, sort_keys=True)
+            file.write("\n")
+        print("%d results written to %s" % (len(results), args.baseline))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        sys.exit("no baseline yet, record one on the reference machine with "
+                 "--update")
+    with open(args.baseline) as file:
+        baseline = json.load(file)
+
+    regressions = 0
+    for key in sorted(results):
+        result = results[key]
+        reference = baseline.get(key)
+        if reference is None or reference["metric"] != result["metric"]:
+            print("%-60s %12.4f  (new)" % (key, result["value"]))
+            continue
+        change = 0.0
+        if reference["value"] > 0:
+            change = (result["value"] / reference["value"] - 1.0) * 100.0
+        slower = change > args.threshold
+        regressions += slower
+        print("%-60s %12.4f %+7.1f%%%s" % (
+            key, result["value"], change, "  REGRESSION" if slower else ""))
+    for key in sorted(set(baseline) - set(results)):
+        print("%-60s %12s  (missing)" % (key, "-"))
+
+    if regressions:
+        print("%d benchmarks slower than %.0f%%" %
+              (regressions, args.threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
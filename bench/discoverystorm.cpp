@@ -0,0 +1,194 @@
+#include "qonvifmanager.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QThread>
+#include <QUdpSocket>
+#include <QtTest>
+
+namespace {
+// ProbeMatch of camera _index, padded with extra scopes to about _size bytes
+QByteArray
+probeMatch(const QByteArray& _template, int _index, int _size) {
+    static const QRegularExpression endpoint(
+        "(<wsa:Address>)urn:uuid:[^<]*(</wsa:Address>)");
+    static const QRegularExpression xaddrs(
+        "(<d:XAddrs>)[^<]*(</d:XAddrs>)");
+    QString address = QString("10.%1.%2.%3")
+                          .arg((_index >> 16) & 0xff)
+                          .arg((_index >> 8) & 0xff)
+                          .arg(_index & 0xff);
+    QString text = QString::fromUtf8(_template);
+    text.replace(
+        endpoint,
+        QString("\\1urn:uuid:d15c0000-0000-4000-8000-%1\\2")
+            .arg(_index, 12, 10, QChar('0')));
+    text.replace(
+        xaddrs, "\\1http://" + address + "/onvif/device_service\\2");
+
+    QString padding;
+    int     missing = _size - text.toUtf8().size();
+    for (int i = 0; padding.size() < missing; i++)
+        padding += QString(" onvif://www.onvif.org/extension/%1").arg(i);
+    text.replace("</d:Scopes>", padding + "</d:Scopes>");
+    return text.toUtf8();
+}
+
+// sends the datagrams from its own thread, as the cameras would, evenly
+// spread at _rate per second or as fast as possible
+class Flooder : public QThread
+{
+public:
+    Flooder(
+        const QList<QByteArray>& _datagrams,
+        quint16                  _port,
+        int                      _rate,
+        const QElapsedTimer&     _clock)
+        : idatagrams(_datagrams), iport(_port), irate(_rate), iclock(_clock),
+          isent(0), ilastUsecs(0) {}
+
+    QList<QByteArray>    idatagrams;
+    quint16              iport;
+    int                  irate;
+    const QElapsedTimer& iclock;
+    int                  isent;
+    qint64               ilastUsecs;
+
+protected:
+    void run() override {
+        QUdpSocket socket;
+        qint64     start = iclock.nsecsElapsed() / 1000;
+        for (int i = 0; i < idatagrams.size(); i++) {
+            if (irate > 0) {
+                qint64 due  = start + qint64(i) * 1000000 / irate;
+                qint64 wait = due - iclock.nsecsElapsed() / 1000;
+                if (wait > 0)
+                    QThread::usleep(wait);
+            }
+            if (socket.writeDatagram(
+                    idatagrams.at(i), QHostAddress::LocalHost, iport) > 0)
+                isent++;
+        }
+        ilastUsecs = iclock.nsecsElapsed() / 1000;
+    }
+};
+
+struct Stage {
+    const char* name;
+    quint64     count;
+    qint64      lastUsecs; // when the count last changed
+};
+}
+
+// floods the DeviceSearcher socket of a QOnvifManager on loopback and
+// follows the ProbeMatches through the stages of the discovery: sent,
+// read from the socket, decoded and turned into QOnvifDevice objects.
+// QOnvifDiscoveryBench -o results.xml,xml feeds compare_baseline.py too.
+class QOnvifDiscoveryBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void storm_data();
+    void storm();
+};
+
+void
+QOnvifDiscoveryBench::storm_data() {
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("rate");
+    QTest::addColumn<int>("size");
+    // gate on the share of ProbeMatches that did not become devices
+    QTest::addColumn<double>("maxDropPercent");
+
+    QTest::newRow("1000 at 500/s, 1 KiB") << 1000 << 500 << 1024 << 0.0;
+    QTest::newRow("4000 at 2000/s, 1 KiB") << 4000 << 2000 << 1024 << 1.0;
+    QTest::newRow("5000 at 5000/s, 4 KiB") << 5000 << 5000 << 4096 << 5.0;
+    // unpaced, reported but not gated
+    QTest::newRow("5000 flood, 1 KiB") << 5000 << 0 << 1024 << 100.0;
+}
+
+void
+QOnvifDiscoveryBench::storm() {
+    QFETCH(int, count);
+    QFETCH(int, rate);
+    QFETCH(int, size);
+    QFETCH(double, maxDropPercent);
+
+    QFile fixture(QString(FIXTURES_DIR) + "/hikvision/ProbeMatch.xml");
+    QVERIFY2(fixture.open(QIODevice::ReadOnly), qPrintable(fixture.fileName()));
+    QByteArray        probeTemplate = fixture.readAll();
+    QList<QByteArray> datagrams;
+    for (int i = 0; i < count; i++)
+        datagrams.append(probeMatch(probeTemplate, i, size));
+
+    // the probe of the manager tells the port of its searcher socket
+    QUdpSocket responder;
+    QVERIFY(responder.bind(QHostAddress::LocalHost, 0));
+    QOnvifManager manager("admin", "admin");
+    manager.setDiscoveryTarget(QHostAddress::LocalHost, responder.localPort());
+    manager.refreshDevicesList();
+    QTRY_VERIFY(responder.hasPendingDatagrams());
+    QHostAddress sender;
+    quint16      searcherPort = 0;
+    QByteArray   probe(responder.pendingDatagramSize(), 0);
+    responder.readDatagram(probe.data(), probe.size(), &sender, &searcherPort);
+    QVERIFY(searcherPort != 0);
+
+    MetricsSnapshot::Discovery before = manager.metrics().discovery;
+    Stage stages[] = {
+        {"read", 0, 0}, {"decoded", 0, 0}, {"devices", 0, 0}};
+
+    QElapsedTimer clock;
+    clock.start();
+    Flooder flooder(datagrams, searcherPort, rate, clock);
+    flooder.start();
+
+    // until every datagram became a device or nothing moved for a while
+    qint64 quietUsecs = 2000000;
+    forever {
+        QTest::qWait(10);
+        qint64                     now     = clock.nsecsElapsed() / 1000;
+        MetricsSnapshot::Discovery current = manager.metrics().discovery;
+        quint64 counts[] = {current.datagrams - before.datagrams,
+                            current.probeMatches - before.probeMatches,
+                            quint64(manager.devicesMap().size())};
+        for (int i = 0; i < 3; i++) {
+            if (counts[i] != stages[i].count) {
+                stages[i].count     = counts[i];
+                stages[i].lastUsecs = now;
+            }
+        }
+        qint64 lastChange =
+            qMax(stages[0].lastUsecs,
+                 qMax(stages[1].lastUsecs, stages[2].lastUsecs));
+        if (flooder.isFinished() &&
+            (stages[2].count >= quint64(count) ||
+             now - qMax(lastChange, flooder.ilastUsecs) > quietUsecs))
+            break;
+    }
+    flooder.wait();
+
+    qDebug("%-8s %7d  %9.1f ms", "sent", flooder.isent,
+           flooder.ilastUsecs / 1000.0);
+    quint64 previous = flooder.isent;
+    for (const Stage& stage : stages) {
+        double dropped =
+            previous > 0 ? 100.0 * (previous - stage.count) / previous : 0;
+        qDebug("%-8s %7llu  %9.1f ms  %5.1f%% dropped", stage.name,
+               (unsigned long long)stage.count, stage.lastUsecs / 1000.0,
+               dropped);
+        previous = stage.count;
+    }
+
+    QTest::setBenchmarkResult(
+        stages[2].lastUsecs / 1000.0, QTest::WalltimeMilliseconds);
+    double lost = 100.0 * (count - qint64(stages[2].count)) / count;
+    QVERIFY2(
+        lost <= maxDropPercent,
+        qPrintable(QString("%1% of the devices lost").arg(lost, 0, 'f', 1)));
+}
+
+QTEST_GUILESS_MAIN(QOnvifDiscoveryBench)
+
+#include "discoverystorm.moc"
@@ -0,0 +1,118 @@
+#include "fixturenetwork.hpp"
+#include <QFile>
+#include <QRegularExpression>
+#include <QTimer>
+
+FixtureReply::FixtureReply(
+    const QNetworkRequest& _request,
+    const QByteArray&      _body,
+    int                    _httpStatus,
+    QObject*               _parent)
+    : QNetworkReply(_parent), ibody(_body), ioffset(0) {
+    setRequest(_request);
+    setUrl(_request.url());
+    setOperation(QNetworkAccessManager::PostOperation);
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, _httpStatus);
+    setHeader(
+        QNetworkRequest::ContentTypeHeader,
+        "application/soap+xml; charset=utf-8");
+    setHeader(QNetworkRequest::ContentLengthHeader, ibody.size());
+    if (_httpStatus >= 400)
+        setError(
+            QNetworkReply::InternalServerError,
+            QString("http status %1").arg(_httpStatus));
+    open(QIODevice::ReadOnly);
+    QTimer::singleShot(0, this, SLOT(deliver()));
+}
+
+void
+FixtureReply::abort() {
+    ioffset = ibody.size();
+}
+
+bool
+FixtureReply::isSequential() const {
+    return true;
+}
+
+qint64
+FixtureReply::bytesAvailable() const {
+    return ibody.size() - ioffset + QIODevice::bytesAvailable();
+}
+
+qint64
+FixtureReply::readData(char* _data, qint64 _maxSize) {
+    qint64 size = qMin(_maxSize, ibody.size() - ioffset);
+    if (size <= 0)
+        return ioffset >= ibody.size() ? -1 : 0;
+    memcpy(_data, ibody.constData() + ioffset, size);
+    ioffset += size;
+    return size;
+}
+
+void
+FixtureReply::deliver() {
+    emit metaDataChanged();
+    emit downloadProgress(ibody.size(), ibody.size());
+    emit readyRead();
+    setFinished(true);
+    emit finished();
+}
+
+FixtureNetworkManager::FixtureNetworkManager(
+    const QString& _vendor, QObject* _parent)
+    : QNetworkAccessManager(_parent), ivendor(_vendor) {}
+
+QString
+FixtureNetworkManager::fixturesDir() {
+    return QString(FIXTURES_DIR);
+}
+
+QByteArray
+FixtureNetworkManager::fixture(const QString& _vendor, const QString& _name) {
+    foreach (const QString& dir, QStringList() << _vendor << "common") {
+        QFile file(fixturesDir() + "/" + dir + "/" + _name + ".xml");
+        if (file.open(QIODevice::ReadOnly))
+            return file.readAll();
+    }
+    return QByteArray();
+}
+
+QString
+FixtureNetworkManager::operation(const QByteArray& _request) {
+    static const QRegularExpression body(
+        "<(?:[\\w-]+:)?Body\\b[^>]*>\\s*<(?:[\\w-]+:)?([\\w-]+)");
+    return body.match(QString::fromUtf8(_request)).captured(1);
+}
+
+QNetworkReply*
+FixtureNetworkManager::createRequest(
+    Operation              _op,
+    const QNetworkRequest& _request,
+    QIODevice*             _outgoingData) {
+    Q_UNUSED(_op);
+    QByteArray request;
+    if (_outgoingData != NULL)
+        request = _outgoingData->readAll();
+    QString name = operation(request);
+
+    if (!icache.contains(name))
+        icache.insert(name, fixture(ivendor, name));
+    QByteArray body = icache.value(name);
+    if (!body.isEmpty())
+        return new FixtureReply(_request, body, 200, this);
+
+    // what a camera answers for an operation it does not implement
+    static const QByteArray fault =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+        "<env:Envelope xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\" "
+        "xmlns:ter=\"http://www.onvif.org/ver10/error\">"
+        "<env:Body><env:Fault>"
+        "<env:Code><env:Value>env:Receiver</env:Value>"
+        "<env:Subcode><env:Value>ter:ActionNotSupported</env:Value>"
+        "</env:Subcode></env:Code>"
+        "<env:Reason><env:Text xml:lang=\"en\">Optional Action Not "
+        "Implemented</env:Text></env:Reason>"
+        "</env:Fault></env:Body></env:Envelope>";
+    return new FixtureReply(_request, fault, 500, this);
+}
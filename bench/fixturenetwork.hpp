@@ -0,0 +1,63 @@
+#ifndef FIXTURENETWORK_HPP
+#define FIXTURENETWORK_HPP
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+// a finished reply over a canned body, delivered on the next event loop turn
+// like a real one
+class FixtureReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    FixtureReply(
+        const QNetworkRequest& _request,
+        const QByteArray&      _body,
+        int                    _httpStatus,
+        QObject*               _parent = NULL);
+
+    void   abort() override;
+    bool   isSequential() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* _data, qint64 _maxSize) override;
+
+private slots:
+    void deliver();
+
+private:
+    QByteArray ibody;
+    qint64     ioffset;
+};
+
+// answers every soap request from fixtures/<vendor>/<Operation>.xml, falling
+// back to fixtures/common/<Operation>.xml, so the services can be driven
+// without a camera
+class FixtureNetworkManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    explicit FixtureNetworkManager(
+        const QString& _vendor, QObject* _parent = NULL);
+
+    static QString    fixturesDir();
+    static QByteArray fixture(const QString& _vendor, const QString& _name);
+    // local name of the first element of the soap Body
+    static QString operation(const QByteArray& _request);
+
+protected:
+    QNetworkReply* createRequest(
+        Operation              _op,
+        const QNetworkRequest& _request,
+        QIODevice*             _outgoingData) override;
+
+private:
+    QString                    ivendor;
+    QHash<QString, QByteArray> icache;
+};
+
+#endif // FIXTURENETWORK_HPP
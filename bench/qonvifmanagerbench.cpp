@@ -0,0 +1,264 @@
+#include "devicemanagement.h"
+#include "devicesearcher.h"
+#include "fixturenetwork.hpp"
+#include "mediamanagement.h"
+#include "message.h"
+#include "messageparser.h"
+#include "ptzmanagement.h"
+#include <QtTest>
+#include <functional>
+
+using namespace ONVIF;
+
+namespace {
+const char* kUrl      = "http://192.0.2.10/onvif/device_service";
+const char* kUsername = "admin";
+const char* kPassword = "bench-password";
+
+// response documents every vendor has its own fixture for
+const char* kVendorFixtures[] = {
+    "GetDeviceInformation",
+    "GetProfiles",
+    "GetVideoEncoderConfigurationOptions",
+    "ProbeMatch"};
+
+QStringList
+vendors() {
+    return QStringList() << "hikvision"
+                         << "dahua"
+                         << "axis"
+                         << "hanwha";
+}
+
+QHash<QString, QString>
+namespaces() {
+    QHash<QString, QString> names;
+    names.insert("SOAP-ENV", "http://www.w3.org/2003/05/soap-envelope");
+    names.insert("tt", "http://www.onvif.org/ver10/schema");
+    names.insert("tds", "http://www.onvif.org/ver10/device/wsdl");
+    names.insert("trt", "http://www.onvif.org/ver10/media/wsdl");
+    names.insert("tptz", "http://www.onvif.org/ver20/ptz/wsdl");
+    names.insert("d", "http://schemas.xmlsoap.org/ws/2005/04/discovery");
+    names.insert("wsa", "http://schemas.xmlsoap.org/ws/2004/08/addressing");
+    return names;
+}
+
+// the services are created once per vendor and share one manager, as
+// QOnvifDevice does per camera. the manager outlives them
+struct Services {
+    FixtureNetworkManager network;
+    DeviceManagement      device;
+    MediaManagement       media;
+    PtzManagement         ptz;
+
+    explicit Services(const QString& _vendor)
+        : network(_vendor), device(kUrl, kUsername, kPassword),
+          media(kUrl, kUsername, kPassword), ptz(kUrl, kUsername, kPassword) {
+        device.shareNetworkAccessManager(&network);
+        media.shareNetworkAccessManager(&network);
+        ptz.shareNetworkAccessManager(&network);
+    }
+};
+
+typedef std::function<void(Services&)> Decoder;
+
+QList<QPair<QString, Decoder>>
+decoders() {
+    QList<QPair<QString, Decoder>> list;
+    auto add = [&list](const QString& _name, Decoder _decoder) {
+        list.append(qMakePair(_name, _decoder));
+    };
+
+    add("getDeviceInformation",
+        [](Services& s) { s.device.getDeviceInformation(); });
+    add("getDeviceScopes", [](Services& s) { s.device.getDeviceScopes(); });
+    add("getSystemDateAndTime",
+        [](Services& s) { delete s.device.getSystemDateAndTime(); });
+    add("getUsers", [](Services& s) { delete s.device.getUsers(); });
+    add("getNetworkInterfaces",
+        [](Services& s) { delete s.device.getNetworkInterfaces(); });
+    add("getNetworkProtocols",
+        [](Services& s) { delete s.device.getNetworkProtocols(); });
+    add("getNetworkDefaultGateway",
+        [](Services& s) { delete s.device.getNetworkDefaultGateway(); });
+    add("getNetworkDiscoverMode",
+        [](Services& s) { delete s.device.getNetworkDiscoverMode(); });
+    add("getNetworkDNS", [](Services& s) { delete s.device.getNetworkDNS(); });
+    add("getNetworkHostname",
+        [](Services& s) { delete s.device.getNetworkHostname(); });
+    add("getNetworkNTP", [](Services& s) { delete s.device.getNetworkNTP(); });
+    add("getCapabilitiesDevice",
+        [](Services& s) { delete s.device.getCapabilitiesDevice(); });
+    add("getCapabilitiesMedia",
+        [](Services& s) { delete s.device.getCapabilitiesMedia(); });
+    add("getCapabilitiesPtz",
+        [](Services& s) { delete s.device.getCapabilitiesPtz(); });
+    add("getCapabilitiesImaging",
+        [](Services& s) { delete s.device.getCapabilitiesImaging(); });
+
+    add("getVideoSourceConfigurations",
+        [](Services& s) { delete s.media.getVideoSourceConfigurations(); });
+    add("getVideoEncoderConfigurations",
+        [](Services& s) { delete s.media.getVideoEncoderConfigurations(); });
+    add("getProfiles", [](Services& s) { delete s.media.getProfiles(); });
+    add("getProfile",
+        [](Services& s) { delete s.media.getProfile("Profile_1"); });
+    add("getAudioSourceConfigurations",
+        [](Services& s) { delete s.media.getAudioSourceConfigurations(); });
+    add("getAudioEncoderConfigurations",
+        [](Services& s) { delete s.media.getAudioEncoderConfigurations(); });
+    add("getVideoSourceConfiguration",
+        [](Services& s) { delete s.media.getVideoSourceConfiguration(); });
+    add("getVideoEncoderConfiguration",
+        [](Services& s) { delete s.media.getVideoEncoderConfiguration(); });
+    add("getAudioEncoderConfiguration",
+        [](Services& s) { delete s.media.getAudioEncoderConfiguration(); });
+    add("getAudioEncoderConfigurationOptions", [](Services& s) {
+        delete s.media.getAudioEncoderConfigurationOptions();
+    });
+    add("getVideoEncoderConfigurationOptions", [](Services& s) {
+        delete s.media.getVideoEncoderConfigurationOptions(
+            "VideoEncoder_1", "Profile_1");
+    });
+    add("getStreamUri",
+        [](Services& s) { delete s.media.getStreamUri("Profile_1"); });
+
+    add("ptz.getConfigurations",
+        [](Services& s) { delete s.ptz.getConfigurations(); });
+    add("ptz.getConfiguration", [](Services& s) {
+        Configuration configuration;
+        configuration.setPtzConfigurationToken("PTZConfiguration_1");
+        s.ptz.getConfiguration(&configuration);
+    });
+    add("ptz.getNode", [](Services& s) {
+        Node node;
+        node.setPtzNodeToken("PTZNode_1");
+        s.ptz.getNode(&node);
+    });
+    add("ptz.getPresets", [](Services& s) {
+        Presets presets;
+        presets.setProfileToken("Profile_1");
+        s.ptz.getPresets(&presets);
+    });
+    add("ptz.getNodes", [](Services& s) { delete s.ptz.getNodes(); });
+    return list;
+}
+}
+
+// every decoder runs the full request path against a FixtureNetworkManager:
+// building and signing the message, the (in process) reply and the QXmlQuery
+// decoding. The other benchmarks isolate the parts.
+class QOnvifManagerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void messageParser_data();
+    void messageParser();
+    void decoder_data();
+    void decoder();
+    void messageWithUserInfo();
+    void probeMatch_data();
+    void probeMatch();
+
+private:
+    QHash<QString, QSharedPointer<Services>> iservices;
+};
+
+void
+QOnvifManagerBench::initTestCase() {
+    QDir dir(FixtureNetworkManager::fixturesDir());
+    QVERIFY2(dir.exists("common"), qPrintable(dir.path()));
+    foreach (const QString& vendor, vendors())
+        iservices.insert(vendor, QSharedPointer<Services>::create(vendor));
+}
+
+void
+QOnvifManagerBench::cleanup() {
+    // replies are deleteLater()ed inside nested event loops
+    QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+}
+
+void
+QOnvifManagerBench::messageParser_data() {
+    QTest::addColumn<QByteArray>("document");
+    foreach (const QString& vendor, vendors()) {
+        for (const char* name : kVendorFixtures) {
+            QByteArray document = FixtureNetworkManager::fixture(vendor, name);
+            QTest::newRow(qPrintable(vendor + "/" + name)) << document;
+        }
+    }
+}
+
+void
+QOnvifManagerBench::messageParser() {
+    QFETCH(QByteArray, document);
+    QVERIFY(!document.isEmpty());
+    QHash<QString, QString> names = namespaces();
+    QBENCHMARK {
+        MessageParser parser(document, names);
+        QVERIFY(parser.find("//SOAP-ENV:Body"));
+        parser.getValue("//tt:Name");
+    }
+}
+
+void
+QOnvifManagerBench::decoder_data() {
+    QTest::addColumn<QString>("vendor");
+    QTest::addColumn<int>("index");
+    QList<QPair<QString, Decoder>> list = decoders();
+    foreach (const QString& vendor, vendors()) {
+        for (int i = 0; i < list.size(); i++)
+            QTest::newRow(qPrintable(vendor + "/" + list.at(i).first))
+                << vendor << i;
+    }
+}
+
+void
+QOnvifManagerBench::decoder() {
+    QFETCH(QString, vendor);
+    QFETCH(int, index);
+    Decoder   decode   = decoders().at(index).second;
+    Services& services = *iservices.value(vendor);
+    QBENCHMARK {
+        decode(services);
+    }
+}
+
+void
+QOnvifManagerBench::messageWithUserInfo() {
+    QHash<QString, QString> names = namespaces();
+    QBENCHMARK {
+        Message* msg =
+            Message::getMessageWithUserInfo(names, kUsername, kPassword);
+        msg->appendToBody(newElement("wsdl:GetProfiles"));
+        QByteArray xml = msg->toXml();
+        Q_UNUSED(xml);
+        delete msg;
+    }
+}
+
+void
+QOnvifManagerBench::probeMatch_data() {
+    QTest::addColumn<QByteArray>("datagram");
+    foreach (const QString& vendor, vendors())
+        QTest::newRow(qPrintable(vendor))
+            << FixtureNetworkManager::fixture(vendor, "ProbeMatch");
+}
+
+void
+QOnvifManagerBench::probeMatch() {
+    QFETCH(QByteArray, datagram);
+    QHash<QString, QString> match;
+    QBENCHMARK {
+        match = DeviceSearcher::parseProbeMatch(datagram);
+    }
+    QVERIFY(!match.value("device_service_address").isEmpty());
+}
+
+QTEST_GUILESS_MAIN(QOnvifManagerBench)
+
+#include "qonvifmanagerbench.moc"
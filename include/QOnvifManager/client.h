@@ -3,6 +3,11 @@
 
 #include <QObject>
 #include <QNetworkReply>
+#include "datastruct.hpp"
+#include "tlssessions.h"
+
+class QNetworkAccessManager;
+
 namespace ONVIF
 {
 class Client : public QObject
@@ -10,10 +15,44 @@ class Client : public QObject
     Q_OBJECT
 public:
     explicit Client(const QString &url);
-    QString sendData(const QString &data);
+    QString url() const { return mUrl; }
+    void setUrl(const QString &url) { mUrl = url; }
+    // sends the requests with a manager that stays with the caller and has to
+    // outlive the client, e.g. one for all services of a device so they share
+    // its connections (and tls sessions), or one serving recorded responses
+    void shareNetworkAccessManager(QNetworkAccessManager *manager);
+    // what an https device has to present, the system trust store by default
+    void setTlsTrust(const TlsTrust &trust);
+    void setCredentials(const QString &username, const QString &password);
+    // the http authentication of the device, shared by its clients and owned
+    // by the caller. once it holds a Digest challenge every request carries
+    // an Authorization for its nonce, NULL turns http authentication off
+    void setAuthentication(Data::Authentication *authentication);
+    // request and response bodies are utf-8 and passed through untouched
+    QByteArray sendData(const QByteArray &data);
+
+    // asynchronous post, caller owns the reply (use readReply()). the
+    // priority orders the requests Qt has queued for the host
+    QNetworkReply *postData(const QByteArray &data,
+                            QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
+    // to another address of the device, e.g. an event subscription
+    QNetworkReply *postData(const QByteArray &data, const QString &address,
+                            QNetworkRequest::Priority priority = QNetworkRequest::NormalPriority);
+    static QByteArray readReply(QNetworkReply *reply);
+    // a 401 whose Digest challenge was taken, worth sending again
+    static bool isChallenge(QNetworkReply *reply);
+    static void waitForReplies(const QList<QNetworkReply *> &replies);
 private:
+    void learn(QNetworkReply *reply);
+
     QString mUrl;
+    QString mUsername;
+    QString mPassword;
+    Data::Authentication *mAuthentication;
     bool mTimerIsTrue;
+    QNetworkAccessManager *mNetworkManager;
+    bool mOwnsNetworkManager;
+    TlsTrust mTlsTrust;
 };
 }
 
@@ -0,0 +1,62 @@
+#ifndef ONVIF_CLOCKOFFSET_H
+#define ONVIF_CLOCKOFFSET_H
+
+#include <QDateTime>
+#include <functional>
+
+namespace ONVIF {
+// how far the clock of a device is ahead of ours, added to the wsu:Created
+// of the WS-Security header so a camera with a drifted clock does not
+// reject the digest as expired. Measured when first needed with an
+// unauthenticated GetSystemDateAndTime and again when the device rejects
+// the authentication, at most once per kMinIntervalMs either way.
+class ClockOffset
+{
+public:
+    static const qint64 kMinIntervalMs = 60000;
+    // offsets that moved less are taken as the same clock
+    static const qint64 kToleranceMs = 1000;
+
+    // _measure sets the offset in msecs, false when the device did not
+    // answer
+    typedef std::function<bool(qint64&)> Measure;
+
+    ClockOffset();
+
+    void setMeasure(Measure _measure);
+    // measures first when there is no offset yet or it was invalidated
+    qint64 offsetMsecs();
+    // the offset as it is, 0 until measured
+    qint64 lastOffsetMsecs() const;
+    bool   isMeasured() const;
+
+    // after an authentication fault: measures again (when allowed) and
+    // tells whether the offset moved, so a request is worth signing again
+    bool remeasure();
+    // the next offsetMsecs() measures again (when allowed)
+    void invalidate();
+
+    // a measurement sent by the caller without a nested event loop, for a
+    // clock without a Measure: wanted and allowed now
+    bool needsMeasure() const;
+    void startMeasure();
+    void finishMeasure(bool _measured, qint64 _offsetMsecs);
+
+    // from the utc time a device reported (whole seconds, truncated)
+    // between _sentMsecs and _receivedMsecs since the epoch
+    static qint64 fromDeviceTime(
+        const QDateTime& _utc, qint64 _sentMsecs, qint64 _receivedMsecs);
+
+private:
+    bool measure();
+    bool mayMeasure(qint64 _now) const;
+
+    Measure mMeasure;
+    qint64  mOffsetMs;
+    bool    mMeasured;
+    bool    mMeasuring;
+    qint64  mLastAttempt; // msecs since the epoch, 0: never
+};
+}
+
+#endif // ONVIF_CLOCKOFFSET_H
@@ -0,0 +1,129 @@
+#ifndef ONVIF_CREDENTIALVAULT_H
+#define ONVIF_CREDENTIALVAULT_H
+
+#include "clockoffset.h"
+#include "datastruct.hpp"
+#include "tlssessions.h"
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QQueue>
+#include <QSharedPointer>
+
+class QNetworkReply;
+
+namespace ONVIF {
+class DeviceManagement;
+
+// user names and passwords of the devices: set for one device, for a site
+// (an ip subnet such as "10.1.0.0/16", which may have several) or as the
+// default of every device. A device with more than one candidate tries
+// them concurrently with an authenticated GetDeviceInformation, at most
+// maxInFlight() checks over all devices, and the first one the device
+// accepts is remembered for it.
+class CredentialVault : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Credential {
+        QString username;
+        QString password;
+
+        bool operator==(const Credential& _other) const {
+            return username == _other.username && password == _other.password;
+        }
+        bool operator!=(const Credential& _other) const {
+            return !(*this == _other);
+        }
+    };
+
+    explicit CredentialVault(QObject* _parent = NULL);
+    ~CredentialVault();
+
+    void       setDefault(const Credential& _credential);
+    Credential defaultCredential() const;
+    // false if _site is not a subnet
+    bool addSite(const QString& _site, const Credential& _credential);
+    void removeSite(const QString& _site);
+    void setDevice(const QString& _endPoint, const Credential& _credential);
+    // forgets the credential set for _endPoint and the one it accepted
+    void removeDevice(const QString& _endPoint);
+
+    // what to try on a device, most specific first: the credential set for
+    // it, the one it accepted last, those of its sites (longest prefix
+    // first) and the default. never empty
+    QList<Credential> candidates(
+        const QString& _endPoint, const QString& _serviceAddress) const;
+    // the device has a set or accepted credential, nothing to try
+    bool isSettled(const QString& _endPoint) const;
+
+    void setMaxInFlight(int _checks);
+    int  maxInFlight() const;
+    // what https devices have to present to the checks
+    void setTlsTrust(const TlsTrust& _trust);
+    // tries the candidates on the device, trialFinished() once one was
+    // accepted or all were refused. starting it again restarts it
+    void startTrial(const QString& _endPoint, const QString& _serviceAddress);
+    bool isTrialRunning(const QString& _endPoint) const;
+    void cancelTrials();
+
+signals:
+    // _accepted false: no candidate was accepted (or the device did not
+    // answer), _credential is then the first candidate
+    void trialFinished(
+        const QString&    _endPoint,
+        const Credential& _credential,
+        bool              _accepted);
+
+private:
+    struct Site {
+        QPair<QHostAddress, int> subnet;
+        QList<Credential>        credentials;
+    };
+    // the clock of a device on trial, measured once for its attempts so a
+    // camera with a drifted clock does not refuse every candidate
+    struct DeviceClock {
+        QSharedPointer<DeviceManagement> service; // GetSystemDateAndTime
+        ClockOffset                      offset;
+    };
+    typedef QSharedPointer<DeviceClock> DeviceClockPtr;
+    struct Trial {
+        quint32    generation = 0;
+        int        pending    = 0; // attempts not finished yet
+        Credential first;
+    };
+    // one candidate on one device, with a service of its own
+    struct Attempt {
+        QString              endPoint;
+        QString              serviceAddress;
+        quint32              generation = 0;
+        Credential           credential;
+        DeviceClockPtr       clock;
+        DeviceManagement*    service    = NULL;
+        QNetworkReply*       reply      = NULL;
+        bool                 challenged = false;
+        Data::Authentication authentication;
+    };
+    typedef QSharedPointer<Attempt> AttemptPtr;
+
+    void post(AttemptPtr _attempt);
+    void finished(AttemptPtr _attempt);
+    void pump();
+    // the learned credentials equal to _credential are tried again
+    void forget(const Credential& _credential);
+
+    Credential                 mDefault;
+    QList<Site>                mSites;
+    QHash<QString, Credential> mDevices;
+    QHash<QString, Credential> mLearned;
+    QHash<QString, Trial>      mTrials;
+    QQueue<AttemptPtr>         mQueue;
+    QList<AttemptPtr>          mRunning;
+    quint32                    mGeneration;
+    int                        mMaxInFlight;
+    TlsTrust                   mTlsTrust;
+};
+}
+
+#endif // ONVIF_CREDENTIALVAULT_H
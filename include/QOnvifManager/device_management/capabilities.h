@@ -8,6 +8,7 @@ namespace ONVIF {
         Q_ENUMS(Category)
         Q_PROPERTY(QString ptzXAddr READ ptzXAddr WRITE setPtzXAddr)
         Q_PROPERTY(QString imagingXAddr READ imagingXAddr WRITE setImagingXAddr)
+        Q_PROPERTY(QString eventsXAddr READ eventsXAddr WRITE setEventsXAddr)
         Q_PROPERTY(QString mediaXAddr READ mediaXAddr WRITE setMediaXAddr)
         Q_PROPERTY(bool rtpMulticast READ rtpMulticast WRITE setRtpMulticast)
         Q_PROPERTY(bool rtpTcp READ rtpTcp WRITE setRtpTcp)
@@ -58,6 +59,11 @@ namespace ONVIF {
             return m_imagingXAddr;
         }
 
+        QString eventsXAddr() const
+        {
+            return m_eventsXAddr;
+        }
+
         QString mediaXAddr() const
         {
             return m_mediaXAddr;
@@ -238,6 +244,11 @@ namespace ONVIF {
             m_imagingXAddr = arg;
         }
 
+        void setEventsXAddr(QString arg)
+        {
+            m_eventsXAddr = arg;
+        }
+
         void setMediaXAddr(QString arg)
         {
             m_mediaXAddr = arg;
@@ -411,6 +422,7 @@ namespace ONVIF {
     private:
         QString m_ptzXAddr;
         QString m_imagingXAddr;
+        QString m_eventsXAddr;
         QString m_mediaXAddr;
         bool m_rtpMulticast;
         bool m_rtpTcp;
@@ -28,11 +28,23 @@ public:
         const QString& password);
     QHash<QString, QString> getDeviceInformation();
     QHash<QString, QString> getDeviceScopes();
+    // asynchronous GetDeviceInformation, which every device answers only
+    // to valid credentials: tells whether the ones of the service work
+    QNetworkReply* postCredentialCheck();
+    ResponseStatus readCredentialCheck(QNetworkReply* reply);
     SystemDateAndTime* getSystemDateAndTime();
-    void setSystemDateAndTime(SystemDateAndTime* systemDateAndTime);
-    void setDeviceScopes(SystemScopes* systemScopes);
-    void setSystemFactoryDefault(SystemFactoryDefault* systemFactoryDefault);
-    void systemReboot(SystemReboot* systemReboot);
+    // how far the device clock is ahead of ours, from an unauthenticated
+    // GetSystemDateAndTime. false when the device did not tell its time
+    bool getClockOffset(qint64& offsetMsecs);
+    // asynchronous getClockOffset, sentMsecs is the time of the post
+    QNetworkReply* postClockOffset();
+    bool readClockOffset(
+        QNetworkReply* reply, qint64 sentMsecs, qint64& offsetMsecs);
+    ResponseStatus setSystemDateAndTime(SystemDateAndTime* systemDateAndTime);
+    ResponseStatus setDeviceScopes(SystemScopes* systemScopes);
+    ResponseStatus
+    setSystemFactoryDefault(SystemFactoryDefault* systemFactoryDefault);
+    ResponseStatus systemReboot(SystemReboot* systemReboot);
     Users*                 getUsers();
     NetworkInterfaces*     getNetworkInterfaces();
     NetworkProtocols*      getNetworkProtocols();
@@ -42,13 +54,16 @@ public:
     NetworkHostname*       getNetworkHostname();
     NetworkNTP*            getNetworkNTP();
 
-    void setNetworkInterfaces(NetworkInterfaces* networkInterfaces);
-    void setNetworkProtocols(NetworkProtocols* networkProtocols);
-    void setDefaultGateway(NetworkDefaultGateway* networkDefaultGateway);
-    void setDiscoveryMode(NetworkDiscoveryMode* networkDiscoveryMode);
-    void setDNS(NetworkDNS* networkDns);
-    void setHostname(NetworkHostname* networkHostname);
-    void setNTP(NetworkNTP* networkNtp);
+    ResponseStatus setNetworkInterfaces(NetworkInterfaces* networkInterfaces);
+    ResponseStatus setNetworkProtocols(NetworkProtocols* networkProtocols);
+    ResponseStatus
+    setDefaultGateway(NetworkDefaultGateway* networkDefaultGateway);
+    ResponseStatus setDiscoveryMode(NetworkDiscoveryMode* networkDiscoveryMode);
+    ResponseStatus setDNS(NetworkDNS* networkDns);
+    ResponseStatus setHostname(NetworkHostname* networkHostname);
+    ResponseStatus setNTP(NetworkNTP* networkNtp);
+    // all categories in one request
+    Capabilities* getCapabilities();
     Capabilities* getCapabilitiesPtz();
     Capabilities* getCapabilitiesImaging();
     Capabilities* getCapabilitiesMedia();
@@ -57,6 +72,14 @@ public:
 protected:
     Message* newMessage();
     QHash<QString, QString> namespaces(const QString& key);
+
+private:
+    Message*    newClockMessage();
+    static bool clockOffset(
+        MessageParser* result,
+        qint64         sent,
+        qint64         received,
+        qint64&        offsetMsecs);
 };
 }
 
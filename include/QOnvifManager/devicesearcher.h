@@ -15,6 +15,11 @@ namespace ONVIF {
         ~DeviceSearcher();
         
         void sendSearchMsg();
+        // probes go to the ws-discovery multicast group unless set, e.g. to
+        // a simulator on loopback
+        void setProbeTarget(const QHostAddress &address, quint16 port);
+        // endpoint address, types, xaddrs, ... of one ProbeMatches datagram
+        static QHash<QString, QString> parseProbeMatch(const QByteArray &datagram);
     signals:
         void receiveData(const QHash<QString, QString> &data);
         void deviceSearchingEnded();
@@ -23,6 +28,8 @@ namespace ONVIF {
         void readPendingDatagrams();
     private:
         QUdpSocket *mUdpSocket;
+        QHostAddress mProbeAddress;
+        quint16 mProbePort;
     };
 }
 #endif // ONVIF_DEVICESEARCHER_H
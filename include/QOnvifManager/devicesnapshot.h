@@ -0,0 +1,30 @@
+#ifndef ONVIF_DEVICESNAPSHOT_H
+#define ONVIF_DEVICESNAPSHOT_H
+
+#include "datastruct.hpp"
+#include <QList>
+#include <QString>
+
+namespace ONVIF {
+// on-disk copy of the Data of many devices, so a restart does not have to
+// interrogate every camera again before it can serve them.
+//
+// The file is a header (magic, format version, device count) followed by one
+// length-prefixed QDataStream record per device. load() maps the file to
+// skip a copy, but every record is decoded into a Data: this is not a fixed
+// layout used in place. A file of another format version is refused, so
+// kFormatVersion has to be bumped whenever Data changes.
+class DeviceSnapshot
+{
+public:
+    static const quint32 kMagic         = 0x514f5653; // "QOVS"
+    static const quint32 kFormatVersion = 3;
+
+    // written aside and renamed, a crash never leaves a partial snapshot
+    static bool save(const QString& _fileName, const QList<Data>& _devices);
+    // false when the file is missing, damaged or of another format version
+    static bool load(const QString& _fileName, QList<Data>& _devices);
+};
+}
+
+#endif // ONVIF_DEVICESNAPSHOT_H
@@ -0,0 +1,47 @@
+#ifndef ONVIF_ELEMENTSTREAM_H
+#define ONVIF_ELEMENTSTREAM_H
+
+#include <QByteArray>
+#include <QList>
+#include <QXmlStreamReader>
+
+class QXmlStreamWriter;
+
+namespace ONVIF {
+// cuts every occurrence of one element out of a document that arrives in
+// chunks. Each element is handed out as soon as its end tag is read, as a
+// standalone utf-8 document that keeps the namespace declarations of its
+// ancestors, so only the element being cut is ever buffered.
+class ElementStream
+{
+public:
+    // an empty _namespaceUri matches the local name in any namespace
+    ElementStream(const QString& _namespaceUri, const QString& _name);
+    ~ElementStream();
+
+    void              addData(const QByteArray& _data);
+    QList<QByteArray> takeElements();
+
+    // the whole document has been read
+    bool isFinished() const;
+    // the document is not well formed
+    bool hasError() const;
+
+private:
+    void startElement();
+    void endElement();
+
+    QXmlStreamReader                       mReader;
+    QString                                mNamespaceUri;
+    QString                                mName;
+    QList<QXmlStreamNamespaceDeclarations> mScopes;
+    QByteArray                             mElement;
+    QXmlStreamWriter*                      mWriter;
+    int                                    mDepth;
+    QList<QByteArray>                      mElements;
+    bool                                   mFinished;
+    bool                                   mError;
+};
+}
+
+#endif // ONVIF_ELEMENTSTREAM_H
@@ -0,0 +1,66 @@
+#ifndef ONVIF_EVENTMANAGEMENT_H
+#define ONVIF_EVENTMANAGEMENT_H
+
+#include "datastruct.hpp"
+#include "service.h"
+#include <QDateTime>
+
+namespace ONVIF {
+// the pull point interface of the event service (ONVIF Core 9.1). A
+// subscription lives at its own address, the requests after
+// CreatePullPointSubscription go there with WS-Addressing headers. The
+// service should have no scheduler: a PullMessages waits on the device up
+// to its timeout and would hold a slot that long.
+class EventManagement : public Service
+{
+    Q_OBJECT
+public:
+    explicit EventManagement(
+        const QString& wsdlUrl,
+        const QString& username,
+        const QString& password);
+
+    // filter is a topic expression (ConcreteSet dialect), empty for all
+    // events. termination is when the subscription ends, in our clock
+    bool createPullPointSubscription(
+        int            terminationSecs,
+        QString&       address,
+        QDateTime&     termination,
+        const QString& filter = QString());
+    // waits up to timeoutSecs on the device for at most messageLimit
+    // messages. false if the pull failed (the subscription may be gone)
+    bool pullMessages(
+        const QString&      address,
+        int                 timeoutSecs,
+        int                 messageLimit,
+        QList<Data::Event>& events);
+    bool renew(
+        const QString& address, int terminationSecs, QDateTime& termination);
+    bool unsubscribe(const QString& address);
+
+    // the asynchronous requests behind them. a PullMessages response is
+    // read with a NotificationDecoder while it arrives
+    QNetworkReply* postCreatePullPointSubscription(
+        int terminationSecs, const QString& filter = QString());
+    bool readCreatePullPointSubscription(
+        QNetworkReply* reply, QString& address, QDateTime& termination);
+    QNetworkReply* postPullMessages(
+        const QString& address, int timeoutSecs, int messageLimit);
+    QNetworkReply* postRenew(const QString& address, int terminationSecs);
+    bool readRenew(QNetworkReply* reply, QDateTime& termination);
+    QNetworkReply* postUnsubscribe(const QString& address);
+    ResponseStatus readUnsubscribe(QNetworkReply* reply);
+
+protected:
+    Message* newMessage();
+    // addressed to the subscription at address, action is the wsa:Action
+    Message* newSubscriptionMessage(
+        const QString& address, const QString& action);
+    QHash<QString, QString> namespaces(const QString& key);
+    // the TerminationTime of a response in our clock, the device tells its
+    // CurrentTime along so its clock may be off
+    static QDateTime terminationTime(MessageParser* result);
+};
+}
+
+#endif // ONVIF_EVENTMANAGEMENT_H
@@ -0,0 +1,132 @@
+#ifndef ONVIF_EVENTMULTIPLEXER_H
+#define ONVIF_EVENTMULTIPLEXER_H
+
+#include "clockoffset.h"
+#include "datastruct.hpp"
+#include "notificationdecoder.h"
+#include "timerwheel.h"
+#include "tlssessions.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace ONVIF {
+class DeviceManagement;
+class EventManagement;
+
+// keeps the pull point subscriptions of many devices on the thread it
+// lives in: each subscription has one PullMessages long poll in flight at
+// a time, so an event arrives as soon as the device has it while an idle
+// device costs one request per pull timeout. The messages of a response
+// are handed out as they are decoded. Subscriptions are renewed between
+// two pulls, created again when the device lost them and retried with a
+// growing backoff when it did not answer; all timers are entries of one
+// TimerWheel. The device clock, for the WS-Security timestamps, is
+// measured by a GetSystemDateAndTime posted before the create while it is
+// unknown or was rejected, nothing waits in a nested event loop.
+class EventMultiplexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EventMultiplexer(QObject* _parent = NULL);
+    ~EventMultiplexer();
+
+    // a PullMessages waits up to _timeoutSecs on the device (10 by
+    // default) for at most _messageLimit messages (64 by default)
+    void setPull(int _timeoutSecs, int _messageLimit);
+    // asked for on every create and renew (60 by default), at least three
+    // pull timeouts
+    void setTerminationTime(int _secs);
+    // CreatePullPointSubscription in flight over all devices, the others
+    // wait for a slot
+    void setMaxCreating(int _requests);
+
+    // subscribes to the events of the device whose event service is at
+    // _eventsAddress. its clock is measured at _deviceAddress, the device
+    // service, for the WS-Security timestamps. subscribing a known _key
+    // again starts over
+    void subscribe(
+        const QString&  _key,
+        const QString&  _eventsAddress,
+        const QString&  _deviceAddress,
+        const QString&  _username,
+        const QString&  _password,
+        const TlsTrust& _trust = TlsTrust());
+    // sends an Unsubscribe and forgets _key
+    void unsubscribe(const QString& _key);
+    void clear();
+    int  count() const;
+    bool contains(const QString& _key) const;
+
+    // the subscription exists and is pulled
+    bool isActive(const QString& _key) const;
+
+signals:
+    void eventsReceived(const QString& _key, const QList<Data::Event>& _events);
+    void activeChanged(const QString& _key, bool _active);
+
+private:
+    enum State { Waiting, Measuring, Creating, Pulling, Renewing };
+    struct Subscription {
+        QString                            key;
+        EventManagement*                   service = NULL;
+        Data::Authentication               authentication;
+        // GetSystemDateAndTime only, no scheduler slot is taken
+        QSharedPointer<DeviceManagement>   clockService;
+        ClockOffset                        clock;
+        qint64                             measureSentMs = 0;
+        QString                            address;       // once created
+        qint64                             terminationMs; // in mClock time
+        State                              state = Waiting;
+        QNetworkReply*                     reply = NULL;
+        QScopedPointer<NotificationDecoder> decoder; // of the current pull
+        qint64                             pulledAt = 0;
+        int                                events   = 0; // of the pull
+        quint32 generation = 0;     // bumped by every schedule
+        int     failures   = 0;     // in a row
+        bool    queued     = false; // in mWaiting
+        bool    challenged = false; // a Digest 401 was answered
+        bool    active     = false;
+    };
+    typedef QSharedPointer<Subscription> SubscriptionPtr;
+
+    void    start(quint32 _id);
+    void    create(quint32 _id);
+    void    post(quint32 _id, State _state);
+    void    received(quint32 _id);
+    void    finished(quint32 _id);
+    void    measured(quint32 _id, QNetworkReply* _reply);
+    void    created(quint32 _id, QNetworkReply* _reply);
+    void    pulled(quint32 _id, QNetworkReply* _reply);
+    void    renewed(quint32 _id, QNetworkReply* _reply);
+    void    failed(quint32 _id, bool _lost);
+    void    setActive(quint32 _id, bool _active);
+    void    drop(Subscription& _subscription);
+    void    schedule(quint32 _id, qint64 _delayMs);
+    void    tick();
+    quint64 cookie(quint32 _id, quint32 _generation) const;
+
+    int                             mPullTimeoutSecs;
+    int                             mMessageLimit;
+    int                             mTerminationSecs;
+    int                             mMaxCreating;
+    int                             mCreating;
+    quint32                         mNextId;
+    QNetworkAccessManager*          mManager;
+    TimerWheel                      mWheel;
+    QElapsedTimer                   mClock;
+    QTimer                          mTicker;
+    QHash<quint32, SubscriptionPtr> mSubscriptions;
+    QHash<QString, quint32>         mIds;
+    QQueue<quint32>                 mWaiting; // to create, for a slot
+};
+}
+
+#endif // ONVIF_EVENTMULTIPLEXER_H
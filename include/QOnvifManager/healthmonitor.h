@@ -0,0 +1,101 @@
+#ifndef ONVIF_HEALTHMONITOR_H
+#define ONVIF_HEALTHMONITOR_H
+
+#include "timerwheel.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTcpSocket;
+
+namespace ONVIF {
+// probes the liveness of many devices without a thread or a timer per
+// device: every probe and probe timeout is a TimerWheel entry driven by one
+// QTimer, and the probes are asynchronous. A probe is either an
+// unauthenticated GetSystemDateAndTime (any http answer is alive) or a tcp
+// connect to the service port.
+//
+// An online device is probed every interval(); a failed probe is confirmed
+// at interval() / 8 before the device counts as offline; an offline device
+// is probed with an interval that doubles up to maxInterval().
+class HealthMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ProbeKind { SoapProbe, TcpProbe };
+
+    explicit HealthMonitor(QObject* _parent = NULL);
+    ~HealthMonitor();
+
+    void setProbeKind(ProbeKind _kind);
+    void setInterval(int _msecs);
+    int  interval() const;
+    void setMaxInterval(int _msecs);
+    int  maxInterval() const;
+    void setTimeout(int _msecs);
+    // probes in flight over all devices, the others wait for a slot
+    void setMaxInFlight(int _probes);
+    // the network access manager of the soap probes, taken over
+    void setNetworkAccessManager(QNetworkAccessManager* _manager);
+
+    // _serviceAddress as Data::ProbeData::deviceServiceAddress, adding a
+    // known _endPoint moves it to the new address. the first probes are
+    // spread over one interval
+    void addDevice(const QString& _endPoint, const QString& _serviceAddress);
+    void removeDevice(const QString& _endPoint);
+    void clear();
+    int  count() const;
+
+    // false until the first probe of _endPoint succeeded
+    bool isOnline(const QString& _endPoint) const;
+
+signals:
+    // on the first probe result of a device and on every change after it
+    void onlineChanged(const QString& _endPoint, bool _online);
+
+private:
+    enum State { Unknown, Online, Suspect, Offline };
+    enum Event { ProbeDue = 0, ProbeTimeout = 1 };
+    struct Target {
+        QString        endPoint;
+        QUrl           url;
+        State          state      = Unknown;
+        int            backoffMs  = 0;
+        quint32        generation = 0; // bumped by every schedule
+        bool           used       = false;
+        QNetworkReply* reply      = NULL;
+        QTcpSocket*    socket     = NULL;
+    };
+
+    void    schedule(int _index, Event _event, qint64 _delayMs);
+    void    tick();
+    void    probe(int _index);
+    void    finished(int _index, quint32 _generation, bool _alive);
+    void    abort(Target& _target);
+    qint64  nextDelay(const Target& _target) const;
+    quint64 cookie(int _index, Event _event, quint32 _generation) const;
+
+    ProbeKind              mKind;
+    int                    mIntervalMs;
+    int                    mMaxIntervalMs;
+    int                    mTimeoutMs;
+    int                    mMaxInFlight;
+    int                    mInFlight;
+    QNetworkAccessManager* mManager;
+    TimerWheel             mWheel;
+    QElapsedTimer          mClock;
+    QTimer                 mTicker;
+    QVector<Target>        mTargets;
+    QVector<int>           mFree; // unused indexes of mTargets
+    QHash<QString, int>    mIndexes;
+    QQueue<quint64>        mWaiting; // due while mMaxInFlight were running
+};
+}
+
+#endif // ONVIF_HEALTHMONITOR_H
@@ -0,0 +1,37 @@
+#ifndef ONVIF_HTTPDIGEST_H
+#define ONVIF_HTTPDIGEST_H
+
+#include "datastruct.hpp"
+#include <QByteArray>
+
+class QNetworkReply;
+
+namespace ONVIF {
+// HTTP Digest (RFC 7616: MD5, SHA-256, their -sess variants and qop auth)
+// over the challenge kept in Data::Authentication. The nonce of the last
+// challenge is reused with a growing nc until the device calls it stale,
+// so only the first request to a device pays for the 401.
+class HttpDigest
+{
+public:
+    // takes the Digest challenge of a 401 reply, false if it has none
+    static bool
+    takeChallenge(Data::Authentication& _auth, QNetworkReply* _reply);
+    // parses one WWW-Authenticate value, false if it has no Digest
+    // challenge. a new challenge (a stale nonce) starts over at nc 1
+    static bool
+    setChallenge(Data::Authentication& _auth, const QByteArray& _header);
+
+    // Authorization header of one request, counts the use of the nonce.
+    // empty without a challenge. _cnonce is random when empty
+    static QByteArray authorization(
+        Data::Authentication& _auth,
+        const QByteArray&     _method,
+        const QByteArray&     _uri,
+        const QString&        _user,
+        const QString&        _password,
+        const QByteArray&     _cnonce = QByteArray());
+};
+}
+
+#endif // ONVIF_HTTPDIGEST_H
@@ -12,6 +12,13 @@ namespace ONVIF {
     public:
         explicit StreamUri(QObject *parent = NULL);
         virtual ~StreamUri();
+        enum Transport { RtspUnicast, RtpMulticast, Http };
+
+        // Timeout (xs:duration) in msecs, 0 means the uri never expires and
+        // -1 that the camera sent nothing we can rely on
+        qint64 timeoutMsecs() const;
+        static qint64 durationToMsecs(const QString &duration);
+
         QString uri() const
         {
             return m_uri;
@@ -27,8 +27,7 @@ public:
     VideoSourceConfigurations*        getVideoSourceConfigurations();
     VideoEncoderConfigurations*       getVideoEncoderConfigurations();
     Profiles*                         getProfiles();
-    Profile*                          getProfile720P();
-    Profile*                          getProfileD1();
+    Profile*                          getProfile(const QString& token);
     AudioSourceConfigurations*        getAudioSourceConfigurations();
     AudioEncoderConfigurations*       getAudioEncoderConfigurations();
     VideoSourceConfiguration*         getVideoSourceConfiguration();
@@ -37,13 +36,38 @@ public:
     AudioEncoderConfigurationOptions* getAudioEncoderConfigurationOptions();
     VideoEncoderConfigurationOptions* getVideoEncoderConfigurationOptions(
         QString _configToken, QString _profileToken);
+    // one concurrent request per token, NULL entries for failed ones
+    QList<VideoEncoderConfigurationOptions*>
+    getVideoEncoderConfigurationOptions(const QStringList& _configTokens);
 
-    void
+    ResponseStatus
     setVideoEncoderConfiguration(VideoEncoderConfiguration* videoConfiguration);
+    QNetworkReply*
+    postVideoEncoderConfiguration(VideoEncoderConfiguration* videoConfiguration);
+    ResponseStatus readVideoEncoderConfiguration(
+        QNetworkReply* reply, VideoEncoderConfiguration* videoConfiguration);
     StreamUri* getStreamUri(const QString& token);
+    StreamUri*
+    getStreamUri(const QString& token, StreamUri::Transport transport);
+    // tokens[i] is resolved for transports[i], all requests are in flight
+    // together and a failed one leaves a NULL in the result. refused[i]
+    // tells a device that answered without a uri (a fault) from one that
+    // did not answer
+    QList<StreamUri*> getStreamUris(
+        const QStringList&                tokens,
+        const QList<StreamUri::Transport>& transports,
+        QList<bool>*                       refused = NULL);
 
 protected:
     Message* newMessage();
+    void     parseProfile(MessageParser* result, Profiles* profiles);
+    Message* newStreamUriMessage(
+        const QString& token, StreamUri::Transport transport);
+    StreamUri* parseStreamUri(MessageParser* result);
+    Message*   newVideoEncoderConfigurationOptionsMessage(
+          QString _configToken, QString _profileToken);
+    VideoEncoderConfigurationOptions*
+    parseVideoEncoderConfigurationOptions(MessageParser* result);
     QHash<QString, QString> namespaces(const QString& key);
 };
 }
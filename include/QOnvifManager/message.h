@@ -17,21 +17,40 @@ namespace ONVIF {
         Q_OBJECT
     public:
         static Message* getOnvifSearchMessage();
-        static Message* getMessageWithUserInfo(QHash<QString, QString> &namespaces, const QString &name, const QString &passwd);
+        // clockOffsetMsecs: how far the clock of the device is ahead of ours
+        static Message* getMessageWithUserInfo(QHash<QString, QString> &namespaces, const QString &name, const QString &passwd,
+                                               qint64 clockOffsetMsecs = 0);
 
         explicit Message(const QHash<QString, QString> &namespaces, QObject *parent = NULL);
         
         void appendToBody(const QDomElement &body);
         void appendToHeader(const QDomElement &header);
+        // (re)places the WS-Security header with a fresh nonce and Created
+        void setUserInfo(const QString &name, const QString &passwd, qint64 clockOffsetMsecs = 0);
         
         QString toXmlStr();
+        // the envelope as utf-8, what goes on the wire, rendered once and
+        // kept until the message changes
+        QByteArray toXml();
         
         QString uuid();
+        // local name of the first Body element, e.g. "GetProfiles"
+        QString operation() const;
+        // the Body alone, the same for identical requests (the header
+        // carries a fresh nonce each time)
+        QString bodyXml() const;
+
+        // when request tracing is enabled, -1 otherwise
+        qint64 createdUsecs() const { return mCreatedUsecs; }
+        qint64 digestUsecs() const { return mDigestUsecs; }
+        qint64 buildUsecs() const { return mBuildUsecs; }
         
     private:
         QDomDocument mDoc;
         QHash<QString, QString> mNamespaces;
         QDomElement mBody, mHeader, mEnv;
+        QByteArray mXml;
+        qint64 mCreatedUsecs, mDigestUsecs, mBuildUsecs;
     };
 
     
@@ -5,22 +5,30 @@
 #include <QXmlQuery>
 #include <QBuffer>
 #include <QXmlResultItems>
+#include <QScopedPointer>
+#include "requesttrace.h"
 
 namespace ONVIF {
     class MessageParser : public QObject
     {
         Q_OBJECT
     public:
-        explicit MessageParser(const QString &data, QHash<QString, QString> &namespaces, QObject *parent = 0);
+        // data is the utf-8 document, shared and not copied
+        explicit MessageParser(const QByteArray &data, QHash<QString, QString> &namespaces, QObject *parent = 0);
         ~MessageParser();
         QString getValue(const QString &xpath);
         bool find(const QString &xpath);
         QXmlQuery *query();
         QString nameSpace();
+        // the span is recorded, with the parser lifetime as parse time,
+        // when the parser is deleted
+        void setTrace(const TraceSpan &span);
     private:
         QXmlQuery mQuery;
         QString mNamespaceQueryStr;
         QBuffer mBuffer;
+        QScopedPointer<TraceSpan> mTrace;
+        qint64 mCreatedUsecs;
     };
 }
 
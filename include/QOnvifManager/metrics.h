@@ -0,0 +1,39 @@
+#ifndef ONVIF_METRICS_H
+#define ONVIF_METRICS_H
+
+#include "metricssnapshot.hpp"
+#include <QByteArray>
+
+namespace ONVIF {
+// process wide registry fed by Service. Recording only touches atomics, the
+// per device and per operation entries are created once under a lock.
+class Metrics
+{
+public:
+    static void requestStarted(const QString& _device, qint64 _bytesOut);
+    static void requestFinished(
+        const QString& _device,
+        const QString& _operation,
+        qint64         _usecs,
+        qint64         _bytesIn,
+        bool           _error,
+        bool           _timeout);
+    // a request that waited for an identical one instead of being sent
+    static void requestCoalesced();
+    // a request sent again after a transient failure
+    static void requestRetried();
+    // a request refused at once because the circuit of its device is open
+    static void requestRejected();
+    // one datagram read by DeviceSearcher, _decoded when it was a
+    // ProbeMatch with an endpoint address
+    static void discoveryDatagram(bool _decoded);
+    static void discoveredDevice();
+
+    static MetricsSnapshot snapshot();
+    // prometheus text exposition format
+    static QByteArray toPrometheus();
+    static void       reset();
+};
+}
+
+#endif // ONVIF_METRICS_H
@@ -0,0 +1,33 @@
+#ifndef ONVIF_NOTIFICATIONDECODER_H
+#define ONVIF_NOTIFICATIONDECODER_H
+
+#include "datastruct.hpp"
+#include "elementstream.h"
+
+namespace ONVIF {
+// decodes the wsnt:NotificationMessages of a PullMessages response while it
+// is received: each event is ready as soon as the end tag of its message
+// was read, and only the message being read is buffered
+class NotificationDecoder
+{
+public:
+    NotificationDecoder();
+
+    void               addData(const QByteArray& _data);
+    QList<Data::Event> takeEvents();
+
+    bool isFinished() const;
+    bool hasError() const;
+
+    // one NotificationMessage as cut by ElementStream, false if it is not
+    // well formed
+    static bool decode(const QByteArray& _message, Data::Event& _event);
+
+private:
+    ElementStream      mStream;
+    QList<Data::Event> mEvents;
+    bool               mError;
+};
+}
+
+#endif // ONVIF_NOTIFICATIONDECODER_H
@@ -27,15 +27,15 @@ namespace ONVIF {
         void getPresets(Presets *presets);
         Nodes *getNodes();
 
-        void removePreset(RemovePreset *removePreset);
-        void setPreset(Preset *preset);
-        void continuousMove(ContinuousMove *continuousMove);
-        void absoluteMove(AbsoluteMove *absoluteMove);
-        void relativeMove(RelativeMove *relativeMove);
-        void stop(Stop *stop);
-        void gotoPreset(GotoPreset *gotoPreset);
-        void gotoHomePosition(GotoHomePosition *gotoHomePosition);
-        void setHomePosition(HomePosition *homePosition);
+        ResponseStatus removePreset(RemovePreset *removePreset);
+        ResponseStatus setPreset(Preset *preset);
+        ResponseStatus continuousMove(ContinuousMove *continuousMove);
+        ResponseStatus absoluteMove(AbsoluteMove *absoluteMove);
+        ResponseStatus relativeMove(RelativeMove *relativeMove);
+        ResponseStatus stop(Stop *stop);
+        ResponseStatus gotoPreset(GotoPreset *gotoPreset);
+        ResponseStatus gotoHomePosition(GotoHomePosition *gotoHomePosition);
+        ResponseStatus setHomePosition(HomePosition *homePosition);
 
     protected:
         Message *newMessage();
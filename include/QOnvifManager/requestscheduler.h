@@ -0,0 +1,72 @@
+#ifndef ONVIF_REQUESTSCHEDULER_H
+#define ONVIF_REQUESTSCHEDULER_H
+
+#include <QList>
+#include <QObject>
+
+class QEventLoop;
+class QNetworkReply;
+
+namespace ONVIF {
+// admits the requests of one device to the network, at most maxInFlight()
+// at a time. What it guarantees is one reserved non-inventory slot:
+// inventory never takes the last slot, so a PTZ move or a setting issued
+// during an inventory sweep is sent at once, ahead of the queued reads.
+// With setMaxInFlight(1) nothing is reserved. Interactive and Control are
+// admitted alike, the class only sets the network priority of the request
+// (QNetworkRequest::Priority).
+//
+// Waiting runs a nested event loop like Client::waitForReplies, so there
+// is no ordering among the waiters and no preemption: a release wakes
+// them all and the first one to resume takes the slot. That is the
+// innermost waiting frame, the ones below it can not return before it
+// does, so a slot is never held by a frame that is not running, and a
+// waiter below an inventory waiter stays queued until that one is done.
+// A slot is released when the reply finishes, not when it is read.
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Interactive = 0, // ptz moves
+        Control     = 1, // settings, reboot, ...
+        Inventory   = 2, // Get* reads
+        PriorityCount
+    };
+
+    explicit RequestScheduler(QObject* _parent = NULL);
+    ~RequestScheduler();
+
+    // _service as Service::serviceName(), _operation as Message::operation()
+    static Priority
+    classify(const QString& _service, const QString& _operation);
+
+    int  maxInFlight() const;
+    void setMaxInFlight(int _requests);
+    int  inFlight() const;
+    int  queued(Priority _priority) const;
+
+    // blocks until _priority may send a request, the slot is then held
+    // until release(). a class with a free slot never waits
+    void acquire(Priority _priority);
+    void release();
+    // release() once _reply has finished, at once when it is NULL
+    void releaseOn(QNetworkReply* _reply);
+
+private:
+    struct Waiter {
+        QEventLoop* loop;
+        bool        abandoned; // the scheduler is gone
+    };
+
+    bool admits(Priority _priority) const;
+    void wakeWaiters();
+
+    int            mMaxInFlight;
+    int            mInFlight;
+    QList<Waiter*> mQueues[PriorityCount];
+};
+}
+
+#endif // ONVIF_REQUESTSCHEDULER_H
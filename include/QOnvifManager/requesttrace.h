@@ -0,0 +1,71 @@
+#ifndef ONVIF_REQUESTTRACE_H
+#define ONVIF_REQUESTTRACE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class QNetworkReply;
+
+namespace ONVIF {
+// one soap request, times are in usecs and -1 when the phase was not seen
+struct TraceSpan {
+    QString device;    // host of the service
+    QString service;   // "Device", "Media", "Ptz"
+    QString operation; // first element of the request Body
+    int     httpStatus    = 0;
+    qint64  startUsecs    = -1; // message created
+    qint64  postUsecs     = -1; // request handed to the network
+    qint64  digestUsecs   = -1; // ws-security password digest
+    qint64  buildUsecs    = -1; // building and rendering the envelope
+    qint64  connectUsecs  = -1; // dns, connect and upload of the request
+    qint64  ttfbUsecs     = -1; // request sent until response headers
+    qint64  downloadUsecs = -1; // response headers until last byte
+    qint64  parseUsecs    = -1; // decoding the response
+    qint64  applyUsecs    = -1; // storing the result (into Data)
+};
+
+// in-process collector of the spans of the last requests
+class RequestTrace
+{
+public:
+    static void setEnabled(bool _enabled);
+    static bool isEnabled();
+    // spans kept, the oldest are dropped first
+    static void   setCapacity(int _capacity);
+    static qint64 nowUsecs();
+
+    static void             record(const TraceSpan& _span);
+    static QList<TraceSpan> spans();
+    static void             clear();
+    // the span record() kept last on the calling thread, 0 if none. the
+    // apply time of a kept span is set through it
+    static quint64 lastRecorded();
+    static void    setApplyUsecs(quint64 _span, qint64 _usecs);
+
+    // follows the network phases of a posted request, take() returns the
+    // span (with startUsecs -1 if the reply was not watched)
+    static void      watch(QNetworkReply* _reply, const TraceSpan& _span);
+    static TraceSpan take(QNetworkReply* _reply);
+
+    // chrome://tracing (or Perfetto) json, one track per device
+    static QByteArray toChromeTrace();
+    static QByteArray toCsv();
+};
+
+// times how long the caller spends storing the result of the request it
+// has just made: the span its thread recorded last, whatever other devices
+// and threads recorded since
+class ApplyTrace
+{
+public:
+    ApplyTrace();
+    ~ApplyTrace();
+
+private:
+    qint64  mStartUsecs;
+    quint64 mSpan;
+};
+}
+
+#endif // ONVIF_REQUESTTRACE_H
@@ -0,0 +1,71 @@
+#ifndef ONVIF_RESPONSESTATUS_H
+#define ONVIF_RESPONSESTATUS_H
+
+#include <QByteArray>
+#include <QString>
+
+class QNetworkReply;
+
+namespace ONVIF {
+// outcome of a request whose response carries no data (set*, reboot, ptz
+// moves, ...), decoded from the http status and the first element of the
+// soap Body without going through QXmlQuery
+class ResponseStatus
+{
+public:
+    enum Error {
+        NoError,
+        NetworkError,       // no http response at all
+        HttpError,          // http error without a soap fault
+        NotAuthorized,      // http 401, ter:NotAuthorized or
+                            // wsse:FailedAuthentication
+        SoapFault,          // any other soap fault
+        UnexpectedResponse, // Body does not hold the expected element
+        MalformedResponse   // not a soap envelope
+    };
+
+    ResponseStatus();
+
+    // _expectedNamespace may be empty to only match the local name
+    static ResponseStatus fromReply(
+        QNetworkReply* _reply,
+        const QString& _expectedNamespace,
+        const QString& _expectedName);
+    static ResponseStatus classify(
+        int               _httpStatus,
+        const QByteArray& _body,
+        const QString&    _expectedNamespace,
+        const QString&    _expectedName);
+
+    bool isOk() const {
+        return mError == NoError;
+    }
+    Error error() const {
+        return mError;
+    }
+    int httpStatus() const {
+        return mHttpStatus;
+    }
+    // qualified names as sent by the device, e.g. "env:Sender" and
+    // "ter:InvalidArgVal"
+    QString faultCode() const {
+        return mFaultCode;
+    }
+    QString faultSubcode() const {
+        return mFaultSubcode;
+    }
+    QString faultReason() const {
+        return mFaultReason;
+    }
+    QString errorString() const;
+
+private:
+    Error   mError;
+    int     mHttpStatus;
+    QString mFaultCode;
+    QString mFaultSubcode;
+    QString mFaultReason;
+};
+}
+
+#endif // ONVIF_RESPONSESTATUS_H
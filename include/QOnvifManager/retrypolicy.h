@@ -0,0 +1,76 @@
+#ifndef ONVIF_RETRYPOLICY_H
+#define ONVIF_RETRYPOLICY_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+class QNetworkReply;
+
+namespace ONVIF {
+// when a request that got no usable response is sent again. Only
+// idempotent operations are retried and only after transient failures,
+// the delays grow exponentially with full jitter so the requests of many
+// devices that failed together do not come back together.
+class RetryPolicy
+{
+public:
+    RetryPolicy();
+
+    int maxAttempts; // the first one included, 1 never retries
+    int baseDelayMs;
+    int maxDelayMs;
+
+    // Get* and Set* (a setting applied twice leaves the same state), not
+    // moves, reboots or anything that creates or removes
+    static bool isIdempotent(const QString& _operation);
+    // no http response because the connection was refused, reset or timed
+    // out or the host was not found, or a gateway that could not reach the
+    // camera. soap faults and 401 come from a live camera and are final,
+    // tls and protocol errors and aborted requests too
+    static bool isTransient(QNetworkReply* _reply);
+
+    // random in [0, min(maxDelayMs, baseDelayMs * 2^_attempt)]
+    int delayMs(int _attempt) const;
+};
+
+// health of one device, shared by its services. After failureThreshold
+// requests in a row failed transiently the circuit opens and requests fail
+// at once without touching the network. Once the cooldown is over one
+// request goes through (half open): a response closes the circuit, a
+// failure opens it again for twice the cooldown, up to maxCooldownMs.
+class CircuitBreaker
+{
+public:
+    enum State { Closed, Open, HalfOpen };
+
+    CircuitBreaker();
+
+    void setFailureThreshold(int _failures);
+    void setCooldown(int _msecs, int _maxMsecs);
+
+    State state() const;
+    int   consecutiveFailures() const;
+    // until the next half open probe, 0 when not open
+    qint64 retryInMsecs() const;
+
+    // false while open, or half open with the probe in flight
+    bool allowRequest();
+    void recordSuccess();
+    void recordFailure();
+
+private:
+    void open();
+
+    State         mState;
+    int           mFailures;
+    int           mThreshold;
+    int           mBaseCooldownMs;
+    int           mMaxCooldownMs;
+    int           mCooldownMs;
+    bool          mProbing;
+    QElapsedTimer mClock;
+    qint64        mOpenUntil;
+};
+}
+
+#endif // ONVIF_RETRYPOLICY_H
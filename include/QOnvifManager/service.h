@@ -1,10 +1,17 @@
 #ifndef ONVIF_SERVICE_H
 #define ONVIF_SERVICE_H
 
+#include <QHash>
 #include <QObject>
+#include <QSharedPointer>
+#include <functional>
+#include "clockoffset.h"
 #include "message.h"
 #include "client.h"
 #include "messageparser.h"
+#include "requestscheduler.h"
+#include "responsestatus.h"
+#include "retrypolicy.h"
 
 namespace ONVIF {
     class Service : public QObject {
@@ -15,13 +22,84 @@ namespace ONVIF {
         ~Service();
         MessageParser *sendMessage(Message &message, const QString &namespaceKey = "");
         MessageParser *sendMessage(Message *message, const QString &namespaceKey = "");
+        // sends all messages at once and waits for every reply, the returned
+        // list has one (possibly NULL) parser per message in the same order
+        QList<MessageParser *> sendMessages(const QList<Message *> &messages, const QString &namespaceKey = "");
+        // asynchronous send, readMessage() once the reply is finished. goes
+        // to address instead of the service when given (a subscription)
+        QNetworkReply *postMessage(Message *message, const QString &address = QString());
+        // see Client::shareNetworkAccessManager()
+        void shareNetworkAccessManager(QNetworkAccessManager *manager);
+        void setTlsTrust(const TlsTrust &trust);
+        // for the messages created from now on
+        void setCredentials(const QString &username, const QString &password);
+        // moves the service to another url (e.g. the XAddr of GetCapabilities)
+        void setServiceAddress(const QString &wsdlUrl);
+        QString serviceAddress() const;
+        // requests wait for a slot of the scheduler (shared by the services
+        // of a device) before they are posted, NULL posts them at once
+        void setScheduler(RequestScheduler *scheduler);
+        // transient failures of idempotent requests are sent again, not
+        // the ones of postMessage() nor a stream that already delivered
+        void setRetryPolicy(const RetryPolicy &policy);
+        // requests fail at once (NULL reply) while it is open
+        void setCircuitBreaker(CircuitBreaker *breaker);
+        // offset of the device clock for the WS-Security Created, a request
+        // rejected for its authentication is signed and sent again once
+        // when the offset turns out to have moved
+        void setClockOffset(ClockOffset *offset);
+        // the http authentication learned from the device, shared by its
+        // services. a 401 with a Digest challenge is answered once per
+        // request, the requests after it reuse the nonce
+        void setAuthentication(Data::Authentication *authentication);
+        MessageParser *readMessage(QNetworkReply *reply, const QString &namespaceKey = "");
+        // for requests without response data, responseElement is the
+        // expected first element of the Body, e.g. "tds:SetDNSResponse"
+        ResponseStatus sendCommand(Message *message, const QString &responseElement);
+        ResponseStatus readStatus(QNetworkReply *reply, const QString &responseElement);
+        // parses the response while it is received, onElement gets a parser
+        // over each complete element (e.g. "trt:Profiles") as soon as its end
+        // tag arrives. false if the response is missing or not well formed
+        bool streamMessage(Message *message, const QString &element,
+                           std::function<void(MessageParser *)> onElement,
+                           const QString &namespaceKey = "");
         
     protected:
         virtual QHash<QString, QString> namespaces(const QString &key) = 0;
         Message *createMessage(QHash<QString, QString> &namespaces);
+        QString namespaceUri(const QString &qualifiedName, const QString &namespaceKey = "");
+        // "Device", "Media", "Ptz"
+        QString serviceName() const;
     private:
+        // an identical Get request sent while one is in flight does not go
+        // to the camera again, it waits for the first reply and gets a copy
+        struct Flight {
+            QNetworkReply *reply = NULL;
+            int followers = 0;
+            QByteArray consumed; // read by streamMessage while receiving
+            QByteArray response; // for the followers once finished
+            bool failed = false; // transiently or refused, followers send their own
+        };
+        typedef QSharedPointer<Flight> FlightPtr;
+        QString flightKey(Message *message) const;
+        FlightPtr joinFlight(const QString &key);
+        FlightPtr startFlight(const QString &key, QNetworkReply *reply);
+        MessageParser *parseFlight(FlightPtr flight, const QString &namespaceKey);
+        // sends message again while reply failed transiently and the policy
+        // allows it, answered once after a Digest challenge, or signed anew
+        // after a clock skew showed up. returns
+        // the last reply (NULL once the breaker opened)
+        QNetworkReply *retry(Message *message, const QString &key, QNetworkReply *reply, int attempt = 1);
+        bool shouldRetry(Message *message, QNetworkReply *reply, int attempt) const;
+
         QString mUsername, mPassword;
+        QString mHost;
         Client *mClient;
+        RequestScheduler *mScheduler;
+        RetryPolicy mRetryPolicy;
+        CircuitBreaker *mBreaker;
+        ClockOffset *mClockOffset;
+        QHash<QString, FlightPtr> mFlights;
     };
 }
 
@@ -0,0 +1,44 @@
+#ifndef ONVIF_TIMERWHEEL_H
+#define ONVIF_TIMERWHEEL_H
+
+#include <QVector>
+
+namespace ONVIF {
+// hierarchical timer wheel with two levels of 256 slots. Scheduling and
+// expiring cost O(1) whatever the number of timers; the price is a
+// resolution of one tick and a horizon of 255 * 256 ticks, longer delays
+// are cut to it. Timers are cookies chosen by the caller and cannot be
+// cancelled: the caller makes stale ones recognizable (e.g. a generation
+// in the cookie) and ignores them when they expire.
+class TimerWheel
+{
+public:
+    explicit TimerWheel(int _tickMs = 100);
+
+    int tickMs() const;
+    // ticks of the longest delay
+    static int horizon();
+
+    // expires _delayMs (rounded up to whole ticks) after the current tick
+    void schedule(quint64 _cookie, qint64 _delayMs);
+    // moves to the tick of _nowMs (since any fixed origin) and returns the
+    // cookies that expired on the way, in order of their ticks
+    QVector<quint64> advance(qint64 _nowMs);
+    int              size() const;
+
+private:
+    struct Timer {
+        quint64 cookie;
+        qint64  due; // tick
+    };
+    void insert(const Timer& _timer);
+
+    int            mTickMs;
+    qint64         mTick;
+    int            mSize;
+    QVector<Timer> mInner[256]; // the next 256 ticks, by due & 255
+    QVector<Timer> mOuter[256]; // later ones, by (due >> 8) & 255
+};
+}
+
+#endif // ONVIF_TIMERWHEEL_H
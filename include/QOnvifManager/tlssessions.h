@@ -0,0 +1,44 @@
+#ifndef ONVIF_TLSSESSIONS_H
+#define ONVIF_TLSSESSIONS_H
+
+#include <QByteArray>
+#include <QList>
+
+class QNetworkReply;
+class QNetworkRequest;
+class QSslCertificate;
+
+namespace ONVIF {
+// what an https device has to present
+struct TlsTrust {
+    // base64 sha-256 of the SubjectPublicKeyInfo of the certificate
+    // (openssl x509 -pubkey | openssl pkey -pubin -outform der | sha256);
+    // when set, one of them has to match and the chain is not checked
+    QList<QByteArray> pins;
+    // self-signed cameras: any certificate is accepted, pins or not
+    bool trustAny = false;
+};
+
+// tls sessions of the https devices, shared by every client so a
+// handshake with a device is resumed with its session ticket whatever
+// manager, connection or thread made the first one
+class TlsSessions
+{
+public:
+    // asks for session tickets and sets the one kept for the host
+    static void prepare(QNetworkRequest& _request);
+    // the verdict on the reply: ignores the certificate errors _trust
+    // accepts, aborts on a pin mismatch and keeps the session once the
+    // connection is encrypted
+    static void watch(QNetworkReply* _reply, const TlsTrust& _trust);
+    static void clear();
+
+    static QByteArray pin(const QSslCertificate& _certificate);
+
+private:
+    // hosts whose tickets are kept, all are dropped beyond
+    static const int kMaxHosts = 1024;
+};
+}
+
+#endif // ONVIF_TLSSESSIONS_H
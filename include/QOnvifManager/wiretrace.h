@@ -0,0 +1,31 @@
+#ifndef ONVIF_WIRETRACE_H
+#define ONVIF_WIRETRACE_H
+
+#include <QByteArray>
+#include <QLoggingCategory>
+
+class QNetworkReply;
+
+// soap envelopes as sent and received, off unless enabled by a logging rule
+// such as QT_LOGGING_RULES="onvif.wire.debug=true". Callers check
+// onvifWire().isDebugEnabled() first so a disabled trace costs one test.
+// The ws-security header and the http authorization are never written.
+Q_DECLARE_LOGGING_CATEGORY(onvifWire)
+
+namespace ONVIF {
+class WireTrace
+{
+public:
+    // traces one exchange out of _every (1 = all, 0 = none)
+    static void setSampling(int _every);
+    // payloads are cut after _maxBytes, 0 logs only their size
+    static void setMaxBytes(int _maxBytes);
+
+    // decides whether the exchange is sampled and traces the request
+    static void traceRequest(QNetworkReply* _reply, const QByteArray& _body);
+    // traces the response, or a chunk of it, of a sampled exchange
+    static void traceResponse(QNetworkReply* _reply, const QByteArray& _body);
+};
+}
+
+#endif // ONVIF_WIRETRACE_H
@@ -2,6 +2,7 @@
 #define DATASTRUCT_HPP
 
 #include <QDateTime>
+#include <QHash>
 #include <QRect>
 #include <QString>
 
@@ -37,6 +38,9 @@ struct Data {
         // imaging capabilities
         QString imagingXAddress;
 
+        // events capabilities
+        QString eventsXAddress;
+
         // media capabilities
         QString mediaXAddress;
         bool    rtpMulticast;
@@ -144,6 +148,19 @@ struct Data {
         } ntp;
     } network;
 
+    // how the device takes our credentials, learned from its answers and
+    // kept in the snapshot so a warm start reuses the digest nonce
+    struct Authentication {
+        QString scheme; // "", "UsernameToken" or "Digest"
+        // the last HTTP Digest challenge and the uses of its nonce
+        QString realm;
+        QString nonce;
+        QString opaque;
+        QString algorithm;
+        QString qop;
+        quint32 nonceCount;
+    } authentication;
+
     struct DateTime {
         QDateTime utcTime;
         QDateTime localTime;
@@ -309,7 +326,9 @@ struct Data {
     } ptz;
     struct Profiles {
         QList<QString>                             toKenPro;
-        QList<Data::MediaConfig::Video::StreamUri> streamUris;
+        QList<Data::MediaConfig::Video::StreamUri> streamUris; // rtsp
+        QList<Data::MediaConfig::Video::StreamUri> streamUrisMulticast;
+        QList<Data::MediaConfig::Video::StreamUri> streamUrisHttp;
         QList<bool>                                fixed;
         QList<QString>                             namePro;
         QList<QString>                             nameVsc;
@@ -373,6 +392,18 @@ struct Data {
         QList<int>     ttlMc;
         QList<bool>    autoStartMc;
         QList<QString> sessionTimeoutMc;
-    } profiles, profile720p, profileD1;
+    } profiles;
+
+    // event management
+
+    // one NotificationMessage of a pull point, not kept in the device data
+    struct Event {
+        QString   topic;     // e.g. "tns1:VideoSource/MotionAlarm"
+        QDateTime utcTime;
+        QString   operation; // "Initialized", "Changed" or "Deleted"
+        // the SimpleItems of tt:Source (and tt:Key) and of tt:Data
+        QHash<QString, QString> source;
+        QHash<QString, QString> data;
+    };
 };
 #endif // DATASTRUCT_HPP
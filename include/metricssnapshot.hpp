@@ -0,0 +1,44 @@
+#ifndef METRICSSNAPSHOT_HPP
+#define METRICSSNAPSHOT_HPP
+
+#include <QList>
+#include <QString>
+
+// counters of all onvif requests since start (or the last reset), latencies
+// are in usecs with a resolution of 1/8 of their power of two
+struct MetricsSnapshot {
+    struct Operation {
+        QString operation; // "GetProfiles", "GetStreamUri", ...
+        quint64 count    = 0;
+        quint64 sumUsecs = 0;
+        qint64  p50Usecs = 0;
+        qint64  p90Usecs = 0;
+        qint64  p99Usecs = 0;
+        qint64  maxUsecs = 0;
+    };
+    struct Device {
+        QString device; // host of the device services
+        quint64 requests = 0;
+        quint64 errors   = 0; // network, http and soap errors
+        quint64 timeouts = 0;
+        quint64 bytesIn  = 0;
+        quint64 bytesOut = 0;
+        qint64  inFlight = 0;
+    };
+    // ws-discovery answers, each stage only counts what the one before
+    // let through
+    struct Discovery {
+        quint64 datagrams    = 0; // read from the searcher socket
+        quint64 probeMatches = 0; // decoded with an endpoint address
+        quint64 devices      = 0; // new QOnvifDevice objects
+    };
+    QList<Operation> operations;
+    QList<Device>    devices;
+    qint64           inFlight  = 0;
+    quint64          coalesced = 0; // requests answered by one in flight
+    quint64          retried   = 0; // sent again after a transient failure
+    quint64          rejected  = 0; // refused while the circuit was open
+    Discovery        discovery;
+};
+
+#endif // METRICSSNAPSHOT_HPP
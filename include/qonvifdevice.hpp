@@ -6,6 +6,9 @@
 #include <QDateTime>
 #include <QObject>
 #include <QScopedPointer>
+#include <QStringList>
+
+class QNetworkReply;
 
 namespace ONVIF {
 class DeviceManagement;
@@ -18,6 +21,32 @@ class QOnvifDevicePrivate;
 class QOnvifDevice : public QObject
 {
 public:
+    // parts of a device interrogate() brings up to date
+    enum InterrogationStep {
+        Capabilities        = 0x0001,
+        Information         = 0x0002,
+        Scopes              = 0x0004,
+        Users               = 0x0008,
+        Profiles            = 0x0010,
+        VideoConfigs        = 0x0020,
+        VideoConfigsOptions = 0x0040,
+        StreamUris          = 0x0080,
+        AudioConfigs        = 0x0100,
+        PtzConfiguration    = 0x0200,
+        // what a newly found camera is asked for
+        Onboarding = Capabilities | Information | Scopes | Profiles |
+                     VideoConfigs | VideoConfigsOptions | StreamUris |
+                     PtzConfiguration
+    };
+    Q_DECLARE_FLAGS(InterrogationSteps, InterrogationStep)
+
+    // whether the camera is given up on, see setCircuitBreaker()
+    enum CircuitState {
+        CircuitClosed,  // requests go out
+        CircuitOpen,    // requests fail at once
+        CircuitHalfOpen // the next request probes the camera
+    };
+
     QOnvifDevice(
         QString  _serviceAddress,
         QString  _userName,
@@ -27,6 +56,19 @@ public:
     ~QOnvifDevice();
 
     Data& data();
+    // the requests from now on go with these credentials, nothing is
+    // refreshed
+    void    setCredentials(QString _userName, QString _password);
+    QString userName() const;
+    QString password() const;
+    // https: the certificate of the camera is accepted when the sha-256 of
+    // its public key (base64) is one of _pins, or always with _trustAny.
+    // neither: the system trust store decides. tls sessions are resumed
+    // over all devices and connections either way
+    void setTlsTrust(QStringList _pins, bool _trustAny = false);
+    // the events service of the capabilities, routed as the media and ptz
+    // ones. empty until refreshDeviceCapabilities() found one
+    QString eventsAddress() const;
     // date time
     bool deviceDateAndTime(Data::DateTime& _datetime);
     // device management
@@ -39,6 +81,11 @@ public:
         bool      _isLocal);
     bool setScopes(QString _name, QString _location);
     bool setVideoConfig(Data::MediaConfig::Video::EncoderConfig _videoConfig);
+    // asynchronous setVideoConfig, videoConfigResult() reads (and releases)
+    // the reply once it has finished, _error gets the reason of a failure
+    QNetworkReply*
+         postVideoConfig(Data::MediaConfig::Video::EncoderConfig _videoConfig);
+    bool videoConfigResult(QNetworkReply* _reply, QString* _error = NULL);
     bool setInterfaces(Data::Network::Interfaces _interfaces);
     bool setProtocols(Data::Network::Protocols _protocols);
     bool setDefaultGateway(Data::Network::DefaultGateway _defaultGateway);
@@ -47,6 +94,43 @@ public:
     bool setHostname(Data::Network::Hostname _hostname);
     bool setNTP(Data::Network::NTP _ntp);
 
+    // the refresh functions return the data of a successful refresh younger
+    // than _msecs without asking the camera, 0 (the default) always asks
+    void setFreshness(int _msecs);
+    // requests sent to the camera at a time (4 by default), the rest wait
+    // by priority: ptz moves, then settings and commands, then Get reads.
+    // reads never take the last slot, so a move or a setting is not stuck
+    // behind an inventory sweep
+    void setMaxRequestsInFlight(int _requests);
+
+    // a Get* or Set* request that got no response (refused, timed out,
+    // 502/503/504) is sent again up to _maxAttempts in all, after a random
+    // delay below _baseDelayMsecs * 2^retry (at most _maxDelayMsecs).
+    // defaults: 3, 200, 5000
+    void setRetryPolicy(
+        int _maxAttempts, int _baseDelayMsecs, int _maxDelayMsecs);
+    // after _failureThreshold requests in a row got no response, requests
+    // fail at once for _cooldownMsecs. then one request probes the camera
+    // and each failed probe doubles the cooldown up to _maxCooldownMsecs.
+    // defaults: 5, 10000, 300000
+    void setCircuitBreaker(
+        int _failureThreshold, int _cooldownMsecs, int _maxCooldownMsecs);
+    CircuitState circuitState() const;
+    int          consecutiveFailures() const;
+    // until the next probe while the circuit is open, 0 otherwise
+    qint64 circuitRetryInMsecs() const;
+    // how far the camera clock is ahead of ours, measured before the first
+    // request and again when the camera rejects our authentication. the
+    // WS-Security timestamps are sent in the camera time
+    qint64 clockOffsetMsecs() const;
+
+    // refreshes _steps and the steps they depend on (the media and ptz
+    // services are only known after Capabilities, StreamUris needs Profiles,
+    // ...). steps whose dependencies are done run concurrently, at most
+    // _maxParallel requests in flight. false if a step failed
+    bool interrogate(
+        InterrogationSteps _steps = Onboarding, int _maxParallel = 4);
+
     bool refreshDeviceCapabilities();
     bool refreshDeviceInformation();
     bool refreshDeviceScopes();
@@ -58,6 +142,7 @@ public:
     bool refreshHostname();
     bool refreshNTP();
     bool refreshProfiles();
+    bool refreshProfile(const QString& _token);
     bool refreshUsers();
 
     bool resetFactoryDevice(bool isHard);
@@ -81,6 +166,7 @@ private:
     Q_DECLARE_PRIVATE(QOnvifDevice)
     QScopedPointer<QOnvifDevicePrivate> d_ptr;
 };
+Q_DECLARE_OPERATORS_FOR_FLAGS(QOnvifDevice::InterrogationSteps)
 ///////////////////////////////////////////////////////////////////////////////
 } // namespace device
 ///////////////////////////////////////////////////////////////////////////////
@@ -1,11 +1,13 @@
 #ifndef QONVIFMANAGER_HPP
 #define QONVIFMANAGER_HPP
 
+#include "metricssnapshot.hpp"
 #include "qonvifdevice.hpp"
 #include <QDateTime>
 #include <QHostAddress>
 #include <QMap>
 #include <QScopedPointer>
+#include <functional>
 
 //#ifndef QONVIFMANAGER_GLOBAL_HPP
 //#define QONVIFMANAGER_GLOBAL_HPP
@@ -25,6 +27,30 @@ namespace ONVIF {
 class DeviceSearcher;
 }
 
+// video encoder settings rolled out by QOnvifManager::applyVideoEncoderPolicy,
+// negative values leave the current setting of the encoder untouched
+struct VideoEncoderPolicy {
+    QString encoding; // only encoders with this encoding ("H264"), or all
+    int     bitrateLimit     = -1;
+    int     govLength        = -1;
+    int     frameRateLimit   = -1;
+    int     encodingInterval = -1;
+    int     quality          = -1;
+};
+
+struct VideoEncoderPolicyResult {
+    enum Status {
+        Applied,
+        Rejected, // out of the cached EncoderConfigs::Option ranges
+        Failed    // the camera did not accept it (or did not answer)
+    };
+    QString endPointAddress;
+    QString configToken;
+    Status  status;
+    QString reason;
+};
+using VideoEncoderPolicyReport = QList<VideoEncoderPolicyResult>;
+
 //using namespace device;
 class QOnvifManagerPrivate;
 
@@ -37,6 +63,9 @@ public:
     ~QOnvifManager();
 
     bool refreshDevicesList();
+    // where refreshDevicesList() sends its probe, the ws-discovery multicast
+    // group by default (e.g. 127.0.0.1:3702 for onvif-sim)
+    void setDiscoveryTarget(QHostAddress _address, quint16 _port);
     bool refreshDeviceCapabilities(QString _deviceEndPointAddress);
     bool refreshDeviceInformations(QString _deviceEndPointAddress);
 
@@ -46,6 +75,8 @@ public:
     bool refreshDeviceVideoConfigsOptions(QString _deviceEndPointAddress);
 
     bool refreshDeviceProfiles(QString _deviceEndPointAddress);
+    bool refreshDeviceProfile(
+        QString _deviceEndPointAddress, QString _profileToken);
     bool refreshDeviceInterfaces(QString _deviceEndPointAddress);
     bool refreshDeviceProtocols(QString _deviceEndPointAddress);
     bool refreshDeviceDefaultGateway(QString _deviceEndPointAddress);
@@ -63,13 +94,46 @@ public:
     bool
     setDeviceDateAndTime(QString _deviceEndPointAddress, QDateTime _dateTime,
                          QString _zone, bool _daylightSaving, bool _isLocal);
+    // credentials: the default ones of every device, several per site (an
+    // ip subnet such as "192.168.1.0/24", false if it is not one) and the
+    // ones of a device. a new device with more than one candidate tries
+    // them concurrently and is found once one was accepted, which it keeps.
+    // a change applies to the devices at once, without a new discovery
     void setDefaulUsernameAndPassword(QString _username, QString _password);
+    bool addSiteCredentials(
+        QString _site, QString _username, QString _password);
+    void removeSiteCredentials(QString _site);
+    void setDeviceCredentials(
+        QString _deviceEndPointAddress, QString _username, QString _password);
+    void removeDeviceCredentials(QString _deviceEndPointAddress);
+    // credential checks in flight over all devices (8 by default)
+    void setMaxCredentialChecks(int _checks);
+    // https devices, see QOnvifDevice::setTlsTrust(): the trust of every
+    // device and the one of a single device
+    void setTlsTrust(QStringList _pins, bool _trustAny = false);
+    void setDeviceTlsTrust(
+        QString     _deviceEndPointAddress,
+        QStringList _pins,
+        bool        _trustAny = false);
     bool setDeviceScopes(
         QString _deviceEndPointAddress, QString _name, QString _location);
     bool setDeviceVideoConfig(
         QString                                 _deviceEndPointAddress,
         Data::MediaConfig::Video::EncoderConfig _videoConfig);
 
+    // applies _policy to every encoder of the selected devices (all when no
+    // selector is given), using the encoder configs and options already
+    // refreshed on each device. at most _maxConcurrent (at least 1) requests
+    // are in flight and each vendor is limited by setVendorRateLimit(). the
+    // jobs of a device deleted meanwhile by refreshDevicesList() fail
+    using DeviceSelector = std::function<bool(device::QOnvifDevice*)>;
+    VideoEncoderPolicyReport applyVideoEncoderPolicy(
+        const VideoEncoderPolicy& _policy,
+        DeviceSelector            _selector      = DeviceSelector(),
+        int                       _maxConcurrent = 32);
+    // requests per second to the devices of one manufacturer, 0 = unlimited
+    void setVendorRateLimit(QString _manufacturer, int _requestsPerSecond);
+
     bool setDeviceNetworkInterfaces(
         QString _deviceEndPointAddress, Data::Network::Interfaces _interfaces);
 
@@ -106,6 +170,60 @@ public:
 
     bool stopMovement(QString _deviceEndPointAddress);
 
+    // identical requests in flight are always sent once, a refresh of the
+    // same data within _msecs of a successful one is answered from the
+    // device data (0, the default, always asks the camera)
+    void setRefreshFreshness(int _msecs);
+    // per device limit of requests in flight, see
+    // QOnvifDevice::setMaxRequestsInFlight()
+    void setMaxRequestsPerDevice(int _requests);
+    // for every device, see QOnvifDevice::setRetryPolicy() and
+    // QOnvifDevice::setCircuitBreaker()
+    void setRetryPolicy(
+        int _maxAttempts, int _baseDelayMsecs, int _maxDelayMsecs);
+    void setCircuitBreaker(
+        int _failureThreshold, int _cooldownMsecs, int _maxCooldownMsecs);
+
+    // probes every device every _intervalMsecs without credentials (an
+    // unauthenticated GetSystemDateAndTime, or a tcp connect to the service
+    // port with _tcpProbe) and emits deviceOnlineChanged() on the first
+    // result and on every change. a failed probe of an online device is
+    // confirmed after _intervalMsecs / 8, offline devices are probed less
+    // and less often (up to every 5 minutes)
+    void startHealthMonitor(int _intervalMsecs = 30000, bool _tcpProbe = false);
+    void stopHealthMonitor();
+    // false while the health monitor is stopped or has no answer yet
+    bool isDeviceOnline(QString _deviceEndPointAddress) const;
+
+    // request tracing, the trace is written as chrome trace json when
+    // _fileName ends with ".json" and as csv otherwise
+    void setRequestTracing(bool _enabled);
+    bool saveRequestTrace(QString _fileName);
+
+    // request counters and latencies of all devices, saveMetrics() writes
+    // them in prometheus text format (e.g. for the node exporter textfile
+    // collector)
+    MetricsSnapshot metrics() const;
+    bool            saveMetrics(QString _fileName);
+
+    // device inventory for a warm start: saveSnapshot() writes the data of
+    // every device, loadSnapshot() brings the devices back without asking
+    // the cameras and emits newDeviceFinded for each. the restored devices
+    // are revalidated in the background, see deviceRevalidated()
+    bool saveSnapshot(QString _fileName);
+    bool loadSnapshot(QString _fileName);
+
+    // events of a device from a pull point subscription, see
+    // deviceEventsReceived(). its capabilities are refreshed first when they
+    // name no events service (false if they still do not). the subscription
+    // is renewed and created again as needed until it is unsubscribed or
+    // the device moves to another address
+    bool subscribeDeviceEvents(QString _deviceEndPointAddress);
+    void unsubscribeDeviceEvents(QString _deviceEndPointAddress);
+    // a PullMessages waits up to _pullTimeoutSecs on the device for at most
+    // _messageLimit events (10 and 64 by default)
+    void setEventPulling(int _pullTimeoutSecs, int _messageLimit);
+
     // public
     device::QOnvifDevice* device(QString _deviceEndPointAddress);
     QMap<QString, device::QOnvifDevice*>& devicesMap();
@@ -115,6 +233,11 @@ protected:
     Q_DECLARE_PRIVATE(QOnvifManager)
     QScopedPointer<QOnvifManagerPrivate> d_ptr;
     bool cameraExist(const QString& endpoinAddress);
+    void revalidateNext();
+    void addDevice(
+        Data::ProbeData _probeData, QString _username, QString _password);
+    // the credentials of the devices after a change in the vault
+    void applyCredentials();
 
 public slots:
     void onReciveData(QHash<QString, QString> _deviceHash);
@@ -122,6 +245,15 @@ public slots:
 signals:
     void newDeviceFinded(device::QOnvifDevice* _device);
     void deviceSearchingEnded();
+    // a device restored by loadSnapshot() has been checked against the
+    // camera, _refreshed when its data was stale and was asked again
+    void deviceRevalidated(device::QOnvifDevice* _device, bool _refreshed);
+    void deviceOnlineChanged(device::QOnvifDevice* _device, bool _online);
+    // the events of a subscribed device as soon as they are decoded
+    void deviceEventsReceived(
+        device::QOnvifDevice* _device, QList<Data::Event> _events);
+    // the subscription of the device exists and is pulled (or no longer)
+    void deviceEventsActiveChanged(device::QOnvifDevice* _device, bool _active);
 };
 
 #endif // QONVIFMANAGER_HPP
@@ -0,0 +1,402 @@
+#include "loadgenerator.hpp"
+#include "qonvifdevice.hpp"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+using device::QOnvifDevice;
+
+namespace {
+struct Operation {
+    const char*                        name;
+    std::function<bool(QOnvifDevice*)> run;
+    // fetches what run() needs once per device, before the clock starts
+    std::function<bool(QOnvifDevice*)> prepare;
+};
+
+const QList<Operation>&
+operations() {
+    static const QList<Operation> list = {
+        {"capabilities",
+         [](QOnvifDevice* d) { return d->refreshDeviceCapabilities(); }},
+        {"info", [](QOnvifDevice* d) { return d->refreshDeviceInformation(); }},
+        {"scopes", [](QOnvifDevice* d) { return d->refreshDeviceScopes(); }},
+        {"interfaces", [](QOnvifDevice* d) { return d->refreshInterfaces(); }},
+        {"protocols", [](QOnvifDevice* d) { return d->refreshProtocols(); }},
+        {"gateway", [](QOnvifDevice* d) { return d->refreshDefaultGateway(); }},
+        {"discoverymode",
+         [](QOnvifDevice* d) { return d->refreshDiscoveryMode(); }},
+        {"dns", [](QOnvifDevice* d) { return d->refreshDNS(); }},
+        {"hostname", [](QOnvifDevice* d) { return d->refreshHostname(); }},
+        {"ntp", [](QOnvifDevice* d) { return d->refreshNTP(); }},
+        {"users", [](QOnvifDevice* d) { return d->refreshUsers(); }},
+        {"profiles", [](QOnvifDevice* d) { return d->refreshProfiles(); }},
+        {"videoconfigs",
+         [](QOnvifDevice* d) { return d->refreshVideoConfigs(); }},
+        {"videooptions",
+         [](QOnvifDevice* d) { return d->refreshVideoConfigsOptions(); }},
+        {"streamuris", [](QOnvifDevice* d) { return d->refreshStreamUris(); }},
+        {"audio", [](QOnvifDevice* d) { return d->refreshAudioConfigs(); }},
+        {"ptzconfig",
+         [](QOnvifDevice* d) { return d->refreshPtzConfiguration(); }},
+        {"presets", [](QOnvifDevice* d) { return d->refreshPresets(); }},
+        {"onboard", [](QOnvifDevice* d) { return d->interrogate(); }},
+        {"datetime",
+         [](QOnvifDevice* d) {
+             Data::DateTime dateTime;
+             return d->deviceDateAndTime(dateTime);
+         }},
+        {"setscopes",
+         [](QOnvifDevice* d) { return d->setScopes("loadgen", "lab"); }},
+        {"sethostname",
+         [](QOnvifDevice* d) {
+             Data::Network::Hostname hostname = d->data().network.hostname;
+             hostname.dhcp                    = false;
+             if (hostname.name.isEmpty())
+                 hostname.name = "loadgen";
+             return d->setHostname(hostname);
+         },
+         [](QOnvifDevice* d) { return d->refreshHostname(); }},
+        {"setntp",
+         [](QOnvifDevice* d) { return d->setNTP(d->data().network.ntp); },
+         [](QOnvifDevice* d) { return d->refreshNTP(); }},
+        {"setdatetime",
+         [](QOnvifDevice* d) {
+             return d->setDateAndTime(
+                 QDateTime::currentDateTimeUtc(), "UTC0", false, false);
+         }},
+        {"ptzmove",
+         [](QOnvifDevice* d) { return d->continuousMove(0.2f, 0.0f, 0.0f); },
+         [](QOnvifDevice* d) { return d->refreshProfiles(); }},
+        {"ptzstop",
+         [](QOnvifDevice* d) { return d->stopMovement(); },
+         [](QOnvifDevice* d) { return d->refreshProfiles(); }},
+        {"ptzhome",
+         [](QOnvifDevice* d) { return d->goHomePosition(); },
+         [](QOnvifDevice* d) { return d->refreshProfiles(); }}};
+    return list;
+}
+
+int
+operationIndex(const QString& _name) {
+    for (int i = 0; i < operations().size(); i++) {
+        if (_name == operations().at(i).name)
+            return i;
+    }
+    return -1;
+}
+
+qint64
+percentile(const QVector<qint64>& _sorted, double _fraction) {
+    if (_sorted.isEmpty())
+        return 0;
+    int rank = int(_fraction * _sorted.size() + 0.999999) - 1;
+    return _sorted.at(qBound(0, rank, _sorted.size() - 1));
+}
+
+OperationReport
+summarize(const QString& _name, QVector<qint64> _usecs, quint64 _errors) {
+    OperationReport report;
+    report.operation = _name;
+    report.count     = _usecs.size();
+    report.errors    = _errors;
+    if (_usecs.isEmpty())
+        return report;
+    std::sort(_usecs.begin(), _usecs.end());
+    double sum = 0;
+    foreach (qint64 usecs, _usecs)
+        sum += usecs;
+    report.meanUsecs = sum / _usecs.size();
+    report.p50Usecs  = percentile(_usecs, 0.50);
+    report.p99Usecs  = percentile(_usecs, 0.99);
+    report.p999Usecs = percentile(_usecs, 0.999);
+    report.maxUsecs  = _usecs.last();
+    return report;
+}
+
+// resident set size now and at its peak, in bytes
+void
+memoryUsage(qint64* _rss, qint64* _peakRss) {
+    *_rss     = 0;
+    *_peakRss = 0;
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(
+            GetCurrentProcess(), &counters, sizeof(counters))) {
+        *_rss     = counters.WorkingSetSize;
+        *_peakRss = counters.PeakWorkingSetSize;
+    }
+#elif defined(Q_OS_LINUX)
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly))
+        return;
+    foreach (const QByteArray& line, status.readAll().split('\n')) {
+        qint64 kbytes = line.simplified().split(' ').value(1).toLongLong();
+        if (line.startsWith("VmRSS:"))
+            *_rss = kbytes * 1024;
+        else if (line.startsWith("VmHWM:"))
+            *_peakRss = kbytes * 1024;
+    }
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        *_peakRss = usage.ru_maxrss; // bytes on macos
+#endif
+}
+
+double
+cpuSeconds() {
+#if defined(Q_OS_WIN)
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(
+            GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    auto seconds = [](const FILETIME& _time) {
+        return ((quint64(_time.dwHighDateTime) << 32) | _time.dwLowDateTime) /
+               1e7;
+    };
+    return seconds(kernel) + seconds(user);
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#else
+    return 0;
+#endif
+}
+
+struct Shared {
+    const LoadOptions*  options;
+    QVector<int>        weights; // cumulative, by index in the mix
+    QVector<int>        mixOperations;
+    QElapsedTimer       clock;
+    qint64              endUsecs;
+    std::atomic<qint64> nextSlot{0};
+    std::atomic<qint64> started{0};
+    // workers done with their preparation, the clock runs once all are
+    std::atomic<int>  prepared{0};
+    std::atomic<bool> go{false};
+};
+
+class LoadWorker : public QThread
+{
+public:
+    LoadWorker(Shared* _shared, int _index)
+        : ishared(_shared), iindex(_index),
+          iusecs(_shared->mixOperations.size()),
+          ierrors(_shared->mixOperations.size(), 0) {}
+
+    Shared*                  ishared;
+    int                      iindex;
+    QVector<QVector<qint64>> iusecs; // by index in the mix
+    QVector<quint64>         ierrors;
+
+protected:
+    void run() override {
+        const LoadOptions& options = *ishared->options;
+        QList<QOnvifDevice*> devices;
+        for (int i = iindex; i < options.serviceAddresses.size();
+             i += options.concurrency)
+            devices.append(new QOnvifDevice(
+                options.serviceAddresses.at(i),
+                options.username,
+                options.password,
+                NULL));
+        // workers beyond the number of devices share them round robin
+        if (devices.isEmpty())
+            devices.append(new QOnvifDevice(
+                options.serviceAddresses.at(
+                    iindex % options.serviceAddresses.size()),
+                options.username,
+                options.password,
+                NULL));
+
+        foreach (QOnvifDevice* device, devices) {
+            foreach (int operation, ishared->mixOperations) {
+                if (operations().at(operation).prepare)
+                    operations().at(operation).prepare(device);
+            }
+        }
+        ishared->prepared.fetch_add(1);
+        while (!ishared->go.load())
+            QThread::msleep(1);
+
+        std::mt19937 random(options.seed + iindex);
+        std::uniform_int_distribution<int> pick(
+            0, ishared->weights.last() - 1);
+        for (int n = 0; ; n++) {
+            qint64 scheduled = ishared->clock.nsecsElapsed() / 1000;
+            if (options.rate > 0) {
+                qint64 slot = ishared->nextSlot.fetch_add(1);
+                scheduled   = qint64(slot * 1e6 / options.rate);
+                qint64 wait = scheduled - ishared->clock.nsecsElapsed() / 1000;
+                if (scheduled >= ishared->endUsecs)
+                    break;
+                if (wait > 0)
+                    QThread::usleep(wait);
+            } else if (scheduled >= ishared->endUsecs) {
+                break;
+            }
+            if (options.maxOperations > 0 &&
+                ishared->started.fetch_add(1) >= options.maxOperations)
+                break;
+
+            int roll  = pick(random);
+            int entry = int(
+                std::upper_bound(
+                    ishared->weights.begin(), ishared->weights.end(), roll) -
+                ishared->weights.begin());
+            QOnvifDevice* device = devices.at(n % devices.size());
+            bool ok = operations().at(ishared->mixOperations.at(entry)).run(
+                device);
+            iusecs[entry].append(
+                ishared->clock.nsecsElapsed() / 1000 - scheduled);
+            if (!ok)
+                ierrors[entry]++;
+        }
+        qDeleteAll(devices);
+    }
+};
+}
+
+QStringList
+LoadGenerator::operationNames() {
+    QStringList names;
+    foreach (const Operation& operation, operations())
+        names.append(operation.name);
+    return names;
+}
+
+QList<QPair<QString, int>>
+LoadGenerator::parseMix(const QString& _mix) {
+    QList<QPair<QString, int>> mix;
+    foreach (const QString& entry, _mix.split(',', QString::SkipEmptyParts)) {
+        QString name   = entry.section('=', 0, 0).trimmed();
+        bool    ok     = true;
+        int     weight = entry.contains('=')
+                             ? entry.section('=', 1).trimmed().toInt(&ok)
+                             : 1;
+        if (!ok || weight <= 0 || operationIndex(name) < 0)
+            return QList<QPair<QString, int>>();
+        mix.append(qMakePair(name, weight));
+    }
+    return mix;
+}
+
+LoadGenerator::LoadGenerator(const LoadOptions& _options)
+    : ioptions(_options) {}
+
+bool
+LoadGenerator::run() {
+    if (ioptions.serviceAddresses.isEmpty()) {
+        ierror = "no devices";
+        return false;
+    }
+    if (ioptions.mix.isEmpty()) {
+        ierror = "empty operation mix";
+        return false;
+    }
+
+    Shared shared;
+    shared.options = &ioptions;
+    int total      = 0;
+    for (int i = 0; i < ioptions.mix.size(); i++) {
+        total += ioptions.mix.at(i).second;
+        shared.weights.append(total);
+        shared.mixOperations.append(operationIndex(ioptions.mix.at(i).first));
+    }
+    shared.endUsecs = qint64(ioptions.durationSecs) * 1000000;
+
+    QList<LoadWorker*> workers;
+    for (int i = 0; i < qMax(1, ioptions.concurrency); i++)
+        workers.append(new LoadWorker(&shared, i));
+    foreach (LoadWorker* worker, workers)
+        worker->start();
+    while (shared.prepared.load() < workers.size())
+        QThread::msleep(1);
+    double cpuStart = cpuSeconds();
+    shared.clock.start();
+    shared.go = true;
+    foreach (LoadWorker* worker, workers)
+        worker->wait();
+
+    ireport         = LoadReport();
+    ireport.devices = ioptions.serviceAddresses.size();
+    ireport.seconds = shared.clock.nsecsElapsed() / 1e9;
+    QVector<qint64> all;
+    quint64         allErrors = 0;
+    for (int i = 0; i < ioptions.mix.size(); i++) {
+        QVector<qint64> usecs;
+        quint64         errors = 0;
+        foreach (LoadWorker* worker, workers) {
+            usecs += worker->iusecs.at(i);
+            errors += worker->ierrors.at(i);
+        }
+        all += usecs;
+        allErrors += errors;
+        ireport.operations.append(
+            summarize(ioptions.mix.at(i).first, usecs, errors));
+    }
+    ireport.operations.append(summarize("all", all, allErrors));
+    ireport.throughput = ireport.seconds > 0 ? all.size() / ireport.seconds : 0;
+    ireport.cpuSeconds = cpuSeconds() - cpuStart;
+    ireport.cpuPercent =
+        ireport.seconds > 0 ? 100.0 * ireport.cpuSeconds / ireport.seconds : 0;
+    memoryUsage(&ireport.rssBytes, &ireport.peakRssBytes);
+    qDeleteAll(workers);
+    return true;
+}
+
+LoadReport
+LoadGenerator::report() const {
+    return ireport;
+}
+
+QString
+LoadGenerator::errorString() const {
+    return ierror;
+}
+
+QByteArray
+LoadGenerator::toJson(const LoadReport& _report) {
+    QJsonArray operations;
+    foreach (const OperationReport& operation, _report.operations) {
+        QJsonObject entry;
+        entry["operation"]  = operation.operation;
+        entry["count"]      = double(operation.count);
+        entry["errors"]     = double(operation.errors);
+        entry["mean_usecs"] = operation.meanUsecs;
+        entry["p50_usecs"]  = double(operation.p50Usecs);
+        entry["p99_usecs"]  = double(operation.p99Usecs);
+        entry["p999_usecs"] = double(operation.p999Usecs);
+        entry["max_usecs"]  = double(operation.maxUsecs);
+        operations.append(entry);
+    }
+    QJsonObject report;
+    report["devices"]        = _report.devices;
+    report["seconds"]        = _report.seconds;
+    report["throughput"]     = _report.throughput;
+    report["operations"]     = operations;
+    report["rss_bytes"]      = double(_report.rssBytes);
+    report["peak_rss_bytes"] = double(_report.peakRssBytes);
+    report["cpu_seconds"]    = _report.cpuSeconds;
+    report["cpu_percent"]    = _report.cpuPercent;
+    return QJsonDocument(report).toJson();
+}
@@ -0,0 +1,72 @@
+#ifndef LOADGENERATOR_HPP
+#define LOADGENERATOR_HPP
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+struct LoadOptions {
+    QStringList serviceAddresses;
+    QString     username;
+    QString     password;
+    // operation names of LoadGenerator::operationNames() and their weights
+    QList<QPair<QString, int>> mix;
+    // worker threads, each one with its own QOnvifDevice objects and a
+    // blocking request in flight at a time
+    int concurrency = 8;
+    // operations per second over all workers, 0 runs them back to back. a
+    // late operation is timed from its scheduled start, so a backlog shows
+    // up in the latencies instead of lowering the offered rate
+    double  rate          = 0;
+    int     durationSecs  = 30;
+    qint64  maxOperations = 0; // 0 = until the duration is over
+    quint32 seed          = 1;
+};
+
+struct OperationReport {
+    QString operation;
+    quint64 count  = 0;
+    quint64 errors = 0;
+    double  meanUsecs = 0;
+    qint64  p50Usecs  = 0;
+    qint64  p99Usecs  = 0;
+    qint64  p999Usecs = 0;
+    qint64  maxUsecs  = 0;
+};
+
+struct LoadReport {
+    int    devices    = 0;
+    double seconds    = 0;
+    double throughput = 0; // operations per second
+    // one entry per operation of the mix, then "all"
+    QList<OperationReport> operations;
+    qint64                 rssBytes     = 0; // 0 when the os gives none
+    qint64                 peakRssBytes = 0;
+    double                 cpuSeconds   = 0; // user + system
+    double                 cpuPercent   = 0; // of one core over the run
+};
+
+class LoadGenerator
+{
+public:
+    static QStringList operationNames();
+    // "info=4,profiles=2,ptzmove=1", empty on error
+    static QList<QPair<QString, int>> parseMix(const QString& _mix);
+
+    explicit LoadGenerator(const LoadOptions& _options);
+
+    // blocks until the run is over
+    bool       run();
+    LoadReport report() const;
+    QString    errorString() const;
+
+    static QByteArray toJson(const LoadReport& _report);
+
+private:
+    LoadOptions ioptions;
+    LoadReport  ireport;
+    QString     ierror;
+};
+
+#endif // LOADGENERATOR_HPP
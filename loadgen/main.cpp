@@ -0,0 +1,173 @@
+#include "loadgenerator.hpp"
+#include "qonvifmanager.hpp"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+namespace {
+// service addresses of the devices answering a probe
+QStringList
+discover(
+    const QCommandLineParser& _parser,
+    const QString&            _username,
+    const QString&            _password) {
+    QOnvifManager manager(_username, _password);
+    QString       target = _parser.value("discovery-target");
+    if (!target.isEmpty()) {
+        manager.setDiscoveryTarget(
+            QHostAddress(target.section(':', 0, 0)),
+            target.section(':', 1, 1).toUShort());
+        manager.refreshDevicesList();
+    }
+
+    int        expected = _parser.value("expect").toInt();
+    QEventLoop loop;
+    QTimer::singleShot(
+        _parser.value("discovery-wait").toInt(), &loop, SLOT(quit()));
+    QObject::connect(
+        &manager, &QOnvifManager::newDeviceFinded, [&](device::QOnvifDevice*) {
+            if (expected > 0 && manager.devicesMap().size() >= expected)
+                loop.quit();
+        });
+    loop.exec();
+
+    QStringList addresses;
+    foreach (device::QOnvifDevice* device, manager.devicesMap()) {
+        // XAddrs may list several addresses
+        addresses.append(
+            device->data().probeData.deviceServiceAddress.section(' ', 0, 0));
+    }
+    return addresses;
+}
+
+// one service address per line, # starts a comment
+QStringList
+readDeviceList(const QString& _fileName) {
+    QStringList addresses;
+    QFile       file(_fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return addresses;
+    while (!file.atEnd()) {
+        QString line = QString::fromUtf8(file.readLine()).section('#', 0, 0);
+        if (!line.trimmed().isEmpty())
+            addresses.append(line.trimmed());
+    }
+    return addresses;
+}
+
+QString
+milliseconds(qint64 _usecs) {
+    return QString::number(_usecs / 1000.0, 'f', 2);
+}
+}
+
+int
+main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("onvif-loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Drives a fleet of onvif devices through QOnvifManager and reports "
+        "throughput, latency percentiles, errors and process usage.\n"
+        "Operations: " +
+        LoadGenerator::operationNames().join(", "));
+    parser.addHelpOption();
+    QList<QCommandLineOption> options = {
+        {"devices", "Service addresses, one per line.", "file"},
+        {"discovery-target",
+         "Probe host:port instead of the multicast group.",
+         "address"},
+        {"discovery-wait", "How long to collect ProbeMatches.", "ms", "3000"},
+        {"expect", "Stop discovery once n devices are found.", "n", "0"},
+        {"username", "Device user.", "name", "admin"},
+        {"password", "Device password.", "password", "admin"},
+        {"mix",
+         "Weighted operations.",
+         "list",
+         "info=4,profiles=2,videoconfigs=2,streamuris=1,sethostname=1,"
+         "ptzmove=1,ptzstop=1"},
+        {"concurrency", "Worker threads.", "n", "8"},
+        {"rate", "Operations per second, 0 = as fast as possible.", "n", "0"},
+        {"duration", "Length of the run.", "s", "30"},
+        {"operations", "Stop after n operations, 0 = no limit.", "n", "0"},
+        {"seed", "Seed of the operation choice.", "n", "1"},
+        {"json", "Also write the report as json.", "file"}};
+    parser.addOptions(options);
+    parser.process(app);
+
+    LoadOptions load;
+    load.username = parser.value("username");
+    load.password = parser.value("password");
+    load.mix      = LoadGenerator::parseMix(parser.value("mix"));
+    if (load.mix.isEmpty()) {
+        QTextStream(stderr) << "bad --mix, operations are "
+                            << LoadGenerator::operationNames().join(", ")
+                            << endl;
+        return 1;
+    }
+    load.concurrency   = qMax(1, parser.value("concurrency").toInt());
+    load.rate          = parser.value("rate").toDouble();
+    load.durationSecs  = parser.value("duration").toInt();
+    load.maxOperations = parser.value("operations").toLongLong();
+    load.seed          = parser.value("seed").toUInt();
+    load.serviceAddresses =
+        parser.isSet("devices")
+            ? readDeviceList(parser.value("devices"))
+            : discover(parser, load.username, load.password);
+
+    QTextStream out(stdout);
+    out << load.serviceAddresses.size() << " devices, " << load.concurrency
+        << " workers" << endl;
+
+    LoadGenerator generator(load);
+    if (!generator.run()) {
+        QTextStream(stderr) << generator.errorString() << endl;
+        return 1;
+    }
+    LoadReport report = generator.report();
+
+    out << QString("%1 s, %2 ops/s, cpu %3 s (%4%), rss %5 MiB (peak %6 MiB)")
+               .arg(report.seconds, 0, 'f', 1)
+               .arg(report.throughput, 0, 'f', 1)
+               .arg(report.cpuSeconds, 0, 'f', 1)
+               .arg(report.cpuPercent, 0, 'f', 0)
+               .arg(report.rssBytes / 1048576.0, 0, 'f', 1)
+               .arg(report.peakRssBytes / 1048576.0, 0, 'f', 1)
+        << endl;
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8")
+               .arg("operation", -16)
+               .arg("count", 9)
+               .arg("errors", 7)
+               .arg("mean ms", 9)
+               .arg("p50 ms", 9)
+               .arg("p99 ms", 9)
+               .arg("p999 ms", 9)
+               .arg("max ms", 9)
+        << endl;
+    foreach (const OperationReport& operation, report.operations) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8")
+                   .arg(operation.operation, -16)
+                   .arg(operation.count, 9)
+                   .arg(operation.errors, 7)
+                   .arg(milliseconds(qint64(operation.meanUsecs)), 9)
+                   .arg(milliseconds(operation.p50Usecs), 9)
+                   .arg(milliseconds(operation.p99Usecs), 9)
+                   .arg(milliseconds(operation.p999Usecs), 9)
+                   .arg(milliseconds(operation.maxUsecs), 9)
+            << endl;
+    }
+
+    if (parser.isSet("json")) {
+        QFile file(parser.value("json"));
+        if (!file.open(QIODevice::WriteOnly) ||
+            file.write(LoadGenerator::toJson(report)) < 0) {
+            QTextStream(stderr) << "can not write " << file.fileName() << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# onvif-loadgen --discovery-target 127.0.0.1:3702 --expect 5000 \
+#               --concurrency 64 --rate 500 --duration 60
+#
+#-------------------------------------------------
+
+QT       += core network xml xmlpatterns
+QT       -= gui
+
+CONFIG   += c++11 console
+CONFIG   -= app_bundle
+
+QMAKE_RPATHDIR += .
+
+DESTDIR  = ../../../bin
+TARGET = onvif-loadgen
+TEMPLATE = app
+
+SOURCES += \
+    loadgenerator.cpp \
+    main.cpp
+
+HEADERS += \
+    loadgenerator.hpp
+
+LIBS += -L$$PWD/../../../bin/ -lQOnvifManager
+win32:LIBS += -lpsapi
+
+INCLUDEPATH += $$PWD/../include
+DEPENDPATH += $$PWD/../include
@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Virtual onvif cameras for scale and load tests
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+CONFIG += c++11
+CONFIG += staticlib
+
+DESTDIR  = ../../../bin/
+
+TARGET = QOnvifSimulator
+
+TEMPLATE = lib
+
+SOURCES += \
+    camerasimulator.cpp
+
+HEADERS += \
+    camerasimulator.hpp
@@ -0,0 +1,439 @@
+#include "camerasimulator.hpp"
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSharedPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QUuid>
+#include <QXmlStreamReader>
+#include <random>
+
+namespace {
+// camera address used throughout the fixture corpus (TEST-NET-1)
+const char* kFixtureAddress = "192.0.2.10";
+
+struct SoapRequest {
+    QString operation; // local name of the first Body element
+    QString namespaceUri;
+    QString messageId;
+};
+
+SoapRequest
+parseRequest(const QByteArray& _body) {
+    SoapRequest      request;
+    QXmlStreamReader xml(_body);
+    bool             inBody = false;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        if (inBody) {
+            request.operation    = xml.name().toString();
+            request.namespaceUri = xml.namespaceUri().toString();
+            break;
+        }
+        if (xml.name() == QLatin1String("Body"))
+            inBody = true;
+        else if (xml.name() == QLatin1String("MessageID"))
+            request.messageId = xml.readElementText().trimmed();
+    }
+    return request;
+}
+
+QByteArray
+envelope(const QByteArray& _body) {
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<env:Envelope "
+           "xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\" "
+           "xmlns:ter=\"http://www.onvif.org/ver10/error\">"
+           "<env:Body>" +
+           _body + "</env:Body></env:Envelope>\n";
+}
+
+QByteArray
+fault(const QByteArray& _subcode, const QByteArray& _reason) {
+    QByteArray subcode;
+    if (!_subcode.isEmpty())
+        subcode = "<env:Subcode><env:Value>" + _subcode +
+                  "</env:Value></env:Subcode>";
+    return envelope(
+        "<env:Fault><env:Code><env:Value>env:Receiver</env:Value>" + subcode +
+        "</env:Code><env:Reason><env:Text xml:lang=\"en\">" + _reason +
+        "</env:Text></env:Reason></env:Fault>");
+}
+
+QByteArray
+httpResponse(
+    int               _status,
+    const QByteArray& _body,
+    bool              _close,
+    const QByteArray& _headers = QByteArray()) {
+    QByteArray response = _status == 200
+                              ? "HTTP/1.1 200 OK\r\n"
+                              : _status == 401
+                                    ? "HTTP/1.1 401 Unauthorized\r\n"
+                                    : "HTTP/1.1 500 Internal Server Error\r\n";
+    response += _headers;
+    response += "Server: onvif-sim\r\n"
+                "Content-Type: application/soap+xml; charset=utf-8\r\n"
+                "Content-Length: " +
+                QByteArray::number(_body.size()) + "\r\n";
+    response += _close ? "Connection: close\r\n\r\n"
+                       : "Connection: keep-alive\r\n\r\n";
+    return response + _body;
+}
+}
+
+struct VirtualCamera {
+    int         index;
+    QString     vendor;
+    quint16     port;
+    QByteArray  address; // host:port
+    QByteArray  endpoint;
+    QTcpServer* server;
+};
+
+class CameraSimulatorPrivate
+{
+public:
+    CameraSimulatorPrivate(const SimulatorOptions& _options)
+        : ioptions(_options), iudpSocket(NULL), irandom(_options.seed) {}
+
+    SimulatorOptions     ioptions;
+    SimulatorStats       istats;
+    QString              ierror;
+    QList<VirtualCamera> icameras;
+    // "vendor/Operation", an empty document when there is no fixture
+    QHash<QString, QByteArray> ifixtures;
+    QUdpSocket*                iudpSocket;
+    std::mt19937               irandom;
+
+    QByteArray fixture(const QString& _vendor, const QString& _operation) {
+        QString key = _vendor + "/" + _operation;
+        auto    it  = ifixtures.constFind(key);
+        if (it != ifixtures.constEnd())
+            return it.value();
+        QByteArray document;
+        foreach (const QString& dir, QStringList() << _vendor << "common") {
+            QFile file(ioptions.fixturesDir + "/" + dir + "/" + _operation +
+                       ".xml");
+            if (file.open(QIODevice::ReadOnly)) {
+                document = file.readAll();
+                break;
+            }
+        }
+        ifixtures.insert(key, document);
+        return document;
+    }
+
+    // the fixture as camera _camera would send it
+    static QByteArray
+    render(const VirtualCamera& _camera, QByteArray _document) {
+        static const QRegularExpression ipv6XAddr(
+            " http://\\[[0-9a-fA-F:]+\\][^ <]*");
+        static const QRegularExpression endpoint(
+            "(<wsa:Address>)urn:uuid:[^<]*(</wsa:Address>)");
+        static const QRegularExpression serial(
+            "(<tds:SerialNumber>[^<]*)(</tds:SerialNumber>)");
+
+        QByteArray host = _camera.address.left(_camera.address.indexOf(':'));
+        // explicit ports (rtsp://192.0.2.10:554) keep their port
+        _document.replace(QByteArray(kFixtureAddress) + ":", host + ":");
+        _document.replace(kFixtureAddress, _camera.address);
+        if (!_document.contains("<wsa:Address>") &&
+            !_document.contains("<tds:SerialNumber>"))
+            return _document;
+
+        QString text = QString::fromUtf8(_document);
+        text.remove(ipv6XAddr);
+        text.replace(
+            endpoint, "\\1" + QString::fromUtf8(_camera.endpoint) + "\\2");
+        text.replace(serial, QString("\\1-%1\\2").arg(_camera.index));
+        return text.toUtf8();
+    }
+
+    double roll() {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(irandom);
+    }
+
+    int latency() {
+        int jitter = ioptions.jitterMs;
+        int delay  = ioptions.latencyMs;
+        if (jitter > 0)
+            delay += std::uniform_int_distribution<int>(-jitter, jitter)(
+                irandom);
+        return qMax(0, delay);
+    }
+
+    void serve(int _camera, QTcpSocket* _socket) {
+        QSharedPointer<QByteArray> buffer(new QByteArray);
+        QObject::connect(
+            _socket, &QTcpSocket::readyRead, _socket, [=]() {
+                buffer->append(_socket->readAll());
+                readRequests(_camera, _socket, buffer.data());
+            });
+        QObject::connect(
+            _socket,
+            &QTcpSocket::disconnected,
+            _socket,
+            &QTcpSocket::deleteLater);
+    }
+
+    void readRequests(int _camera, QTcpSocket* _socket, QByteArray* _buffer) {
+        forever {
+            int headerEnd = _buffer->indexOf("\r\n\r\n");
+            if (headerEnd < 0)
+                return;
+            qint64 length     = 0;
+            bool   close      = false;
+            bool   authorized = false;
+            foreach (const QByteArray& line,
+                     _buffer->left(headerEnd).split('\n').mid(1)) {
+                int        colon = line.indexOf(':');
+                QByteArray name  = line.left(colon).trimmed().toLower();
+                QByteArray value = line.mid(colon + 1).trimmed().toLower();
+                if (name == "content-length")
+                    length = value.toLongLong();
+                else if (name == "connection")
+                    close = value == "close";
+                else if (name == "authorization")
+                    authorized = !value.isEmpty();
+            }
+            if (_buffer->size() < headerEnd + 4 + length)
+                return;
+            QByteArray body = _buffer->mid(headerEnd + 4, length);
+            _buffer->remove(0, headerEnd + 4 + length);
+            answer(_camera, _socket, body, close, authorized);
+        }
+    }
+
+    void answer(
+        int               _camera,
+        QTcpSocket*       _socket,
+        const QByteArray& _body,
+        bool              _close,
+        bool              _authorized) {
+        const VirtualCamera& camera = icameras.at(_camera);
+        istats.requests++;
+
+        SoapRequest request = parseRequest(_body);
+        if (ioptions.digestChallenge && !_authorized &&
+            request.operation != QLatin1String("GetSystemDateAndTime")) {
+            istats.challenges++;
+            QByteArray nonce = QByteArray::number(quint32(irandom()), 16);
+            QByteArray reply = httpResponse(
+                401,
+                QByteArray(),
+                _close,
+                "WWW-Authenticate: Digest realm=\"onvif-sim\", qop=\"auth\", "
+                "nonce=\"" +
+                    nonce + "\", algorithm=MD5\r\n");
+            send(_socket, reply, _close);
+            return;
+        }
+
+        double chance = roll();
+        if (chance < ioptions.timeoutRate) {
+            // like a camera that hangs: the connection is dropped later on
+            istats.timeouts++;
+            QTimer::singleShot(
+                ioptions.timeoutMs, _socket, [_socket]() { _socket->abort(); });
+            return;
+        }
+
+        int        status = 200;
+        QByteArray response;
+        if (chance < ioptions.timeoutRate + ioptions.errorRate) {
+            status   = 500;
+            response = fault(QByteArray(), "Simulated failure");
+        } else {
+            QByteArray document;
+            if (!request.operation.isEmpty())
+                document = fixture(camera.vendor, request.operation);
+            if (!document.isEmpty()) {
+                response = render(camera, document);
+            } else if (
+                !request.operation.isEmpty() &&
+                !request.operation.startsWith("Get")) {
+                response = envelope(
+                    "<tns:" + request.operation.toUtf8() +
+                    "Response xmlns:tns=\"" + request.namespaceUri.toUtf8() +
+                    "\"/>");
+            } else {
+                status   = 500;
+                response = fault(
+                    "ter:ActionNotSupported",
+                    "Optional Action Not Implemented");
+            }
+        }
+        if (status != 200)
+            istats.faults++;
+
+        send(_socket, httpResponse(status, response, _close), _close);
+    }
+
+    // after the simulated latency
+    void send(QTcpSocket* _socket, const QByteArray& _reply, bool _close) {
+        QTimer::singleShot(
+            latency(), _socket, [this, _socket, _reply, _close]() {
+                _socket->write(_reply);
+                istats.responses++;
+                if (_close)
+                    _socket->disconnectFromHost();
+            });
+    }
+
+    void readProbes() {
+        while (iudpSocket->hasPendingDatagrams()) {
+            QByteArray datagram;
+            datagram.resize(iudpSocket->pendingDatagramSize());
+            QHostAddress sender;
+            quint16      senderPort;
+            iudpSocket->readDatagram(
+                datagram.data(), datagram.size(), &sender, &senderPort);
+            SoapRequest request = parseRequest(datagram);
+            if (request.operation != "Probe")
+                continue;
+            istats.probes++;
+
+            // every camera answers on its own, after a random delay, as
+            // ws-discovery asks them to
+            for (int i = 0; i < icameras.size(); i++) {
+                int delay = std::uniform_int_distribution<int>(
+                    0, qMax(0, ioptions.probeMaxDelayMs))(irandom);
+                QTimer::singleShot(delay, iudpSocket, [=]() {
+                    iudpSocket->writeDatagram(
+                        probeMatch(icameras.at(i), request.messageId),
+                        sender,
+                        senderPort);
+                });
+            }
+        }
+    }
+
+    QByteArray probeMatch(const VirtualCamera& _camera, const QString& _id) {
+        static const QRegularExpression relatesTo(
+            "(<wsa:RelatesTo>)[^<]*(</wsa:RelatesTo>)");
+        static const QRegularExpression messageId(
+            "(<wsa:MessageID>)[^<]*(</wsa:MessageID>)");
+        QString match = QString::fromUtf8(
+            render(_camera, fixture(_camera.vendor, "ProbeMatch")));
+        match.replace(relatesTo, "\\1" + _id + "\\2");
+        match.replace(
+            messageId,
+            "\\1urn:uuid:" + QUuid::createUuid().toString().mid(1, 36) +
+                "\\2");
+        return match.toUtf8();
+    }
+};
+
+CameraSimulator::CameraSimulator(
+    const SimulatorOptions& _options, QObject* _parent)
+    : QObject(_parent), d_ptr(new CameraSimulatorPrivate(_options)) {}
+
+CameraSimulator::~CameraSimulator() {
+    stop();
+}
+
+bool
+CameraSimulator::start() {
+    Q_D(CameraSimulator);
+    stop();
+    SimulatorOptions& options = d->ioptions;
+    if (options.vendors.isEmpty())
+        options.vendors << "common";
+    if (!QDir(options.fixturesDir).exists("common")) {
+        d->ierror = "no fixtures in " + options.fixturesDir;
+        return false;
+    }
+    if (options.discoveryPort != 0 &&
+        d->fixture(options.vendors.first(), "ProbeMatch").isEmpty()) {
+        d->ierror = "no ProbeMatch fixture for discovery";
+        return false;
+    }
+
+    for (int i = 0; i < options.devices; i++) {
+        VirtualCamera camera;
+        camera.index   = i;
+        camera.vendor  = options.vendors.at(i % options.vendors.size());
+        camera.port    = options.basePort + i;
+        camera.address = options.host.toString().toUtf8() + ":" +
+                         QByteArray::number(camera.port);
+        camera.endpoint =
+            QString("urn:uuid:5e1a0000-0000-4000-8000-%1")
+                .arg(i, 12, 10, QChar('0'))
+                .toUtf8();
+        camera.server = new QTcpServer(this);
+        if (!camera.server->listen(options.host, camera.port)) {
+            d->ierror = QString("port %1: %2")
+                            .arg(camera.port)
+                            .arg(camera.server->errorString());
+            delete camera.server;
+            stop();
+            return false;
+        }
+        connect(camera.server, &QTcpServer::newConnection, this, [d, i]() {
+            QTcpServer* server = d->icameras.at(i).server;
+            while (server->hasPendingConnections())
+                d->serve(i, server->nextPendingConnection());
+        });
+        d->icameras.append(camera);
+    }
+
+    if (options.discoveryPort != 0) {
+        d->iudpSocket = new QUdpSocket(this);
+        if (!d->iudpSocket->bind(options.host, options.discoveryPort)) {
+            d->ierror = "discovery port: " + d->iudpSocket->errorString();
+            stop();
+            return false;
+        }
+        connect(d->iudpSocket, &QUdpSocket::readyRead, this, [d]() {
+            d->readProbes();
+        });
+    }
+    return true;
+}
+
+void
+CameraSimulator::stop() {
+    Q_D(CameraSimulator);
+    foreach (const VirtualCamera& camera, d->icameras)
+        delete camera.server;
+    d->icameras.clear();
+    delete d->iudpSocket;
+    d->iudpSocket = NULL;
+}
+
+QString
+CameraSimulator::errorString() const {
+    return d_ptr->ierror;
+}
+
+int
+CameraSimulator::deviceCount() const {
+    return d_ptr->icameras.size();
+}
+
+QString
+CameraSimulator::serviceAddress(int _device) const {
+    return "http://" + d_ptr->icameras.value(_device).address +
+           "/onvif/device_service";
+}
+
+QString
+CameraSimulator::endpointAddress(int _device) const {
+    return d_ptr->icameras.value(_device).endpoint;
+}
+
+QString
+CameraSimulator::vendor(int _device) const {
+    return d_ptr->icameras.value(_device).vendor;
+}
+
+SimulatorStats
+CameraSimulator::stats() const {
+    return d_ptr->istats;
+}
@@ -0,0 +1,82 @@
+#ifndef CAMERASIMULATOR_HPP
+#define CAMERASIMULATOR_HPP
+
+#include <QHostAddress>
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+
+struct SimulatorOptions {
+    int          devices  = 1;
+    QHostAddress host     = QHostAddress::LocalHost;
+    quint16      basePort = 20000; // device i listens on basePort + i
+    // ws-discovery probes are answered on this port, 0 disables discovery
+    quint16 discoveryPort = 3702;
+    // a camera answers a probe after a random delay up to this
+    int probeMaxDelayMs = 500;
+
+    // fixtures/<vendor>/<Operation>.xml, then fixtures/common/<Operation>.xml
+    QString     fixturesDir;
+    QStringList vendors = QStringList() << "hikvision"
+                                        << "dahua"
+                                        << "axis"
+                                        << "hanwha";
+
+    int    latencyMs   = 0;
+    int    jitterMs    = 0;   // latency is uniform in latencyMs +- jitterMs
+    double errorRate   = 0.0; // answered with a soap fault (http 500)
+    double timeoutRate = 0.0; // not answered, closed after timeoutMs
+    int    timeoutMs   = 30000;
+    quint32 seed       = 1;
+    // requests without an http Authorization are refused with a Digest
+    // challenge (401), any Authorization is taken. GetSystemDateAndTime is
+    // always answered, as the onvif core spec asks
+    bool digestChallenge = false;
+};
+
+struct SimulatorStats {
+    quint64 probes     = 0;
+    quint64 requests   = 0;
+    quint64 responses  = 0;
+    quint64 faults     = 0; // unknown operations and injected errors
+    quint64 timeouts   = 0;
+    quint64 challenges = 0; // 401 answers of digestChallenge
+};
+
+class CameraSimulatorPrivate;
+
+// N virtual onvif cameras in one thread: each one is a QTcpServer answering
+// the soap requests of the device, media and ptz services from the fixture
+// corpus, and all of them share one udp socket for ws-discovery.
+//
+// The fixtures use 192.0.2.10 as the camera address, it is rewritten to the
+// host:port of each virtual camera along with its endpoint uuid and serial
+// number. Operations without a fixture are answered with an empty
+// <Operation>Response when they are commands (Set*, moves, presets, ...)
+// and with an ActionNotSupported fault otherwise.
+class CameraSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CameraSimulator(
+        const SimulatorOptions& _options, QObject* _parent = 0);
+    ~CameraSimulator();
+
+    // false when the fixtures are missing or a port can not be bound
+    bool    start();
+    void    stop();
+    QString errorString() const;
+
+    int            deviceCount() const;
+    QString        serviceAddress(int _device) const;
+    QString        endpointAddress(int _device) const;
+    QString        vendor(int _device) const;
+    SimulatorStats stats() const;
+
+protected:
+    Q_DECLARE_PRIVATE(CameraSimulator)
+    QScopedPointer<CameraSimulatorPrivate> d_ptr;
+};
+
+#endif // CAMERASIMULATOR_HPP
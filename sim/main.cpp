@@ -0,0 +1,80 @@
+#include "camerasimulator.hpp"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QTimer>
+
+int
+main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("onvif-sim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Virtual onvif cameras on loopback for scale and load tests.");
+    parser.addHelpOption();
+    QList<QCommandLineOption> options = {
+        {"devices", "Number of virtual cameras.", "n", "1"},
+        {"host", "Address to listen on.", "address", "127.0.0.1"},
+        {"base-port", "Port of the first camera.", "port", "20000"},
+        {"discovery-port", "WS-Discovery port, 0 disables it.", "port", "3702"},
+        {"probe-delay", "Max delay of a ProbeMatch.", "ms", "500"},
+        {"fixtures", "Fixture corpus.", "dir", FIXTURES_DIR},
+        {"vendors",
+         "Comma separated fixture vendors, assigned round robin.",
+         "list",
+         "hikvision,dahua,axis,hanwha"},
+        {"latency", "Response latency.", "ms", "0"},
+        {"jitter", "Latency jitter (+-).", "ms", "0"},
+        {"error-rate", "Share of requests answered with a fault.", "0..1", "0"},
+        {"timeout-rate", "Share of requests never answered.", "0..1", "0"},
+        {"timeout", "Time before an unanswered request is dropped.",
+         "ms",
+         "30000"},
+        {"seed", "Seed of the injected latencies and failures.", "n", "1"},
+        {"stats", "Print the counters every n seconds, 0 = never.", "s", "0"}};
+    parser.addOptions(options);
+    parser.process(app);
+
+    SimulatorOptions simulation;
+    simulation.devices         = parser.value("devices").toInt();
+    simulation.host            = QHostAddress(parser.value("host"));
+    simulation.basePort        = parser.value("base-port").toUShort();
+    simulation.discoveryPort   = parser.value("discovery-port").toUShort();
+    simulation.probeMaxDelayMs = parser.value("probe-delay").toInt();
+    simulation.fixturesDir     = parser.value("fixtures");
+    simulation.vendors =
+        parser.value("vendors").split(',', QString::SkipEmptyParts);
+    simulation.latencyMs   = parser.value("latency").toInt();
+    simulation.jitterMs    = parser.value("jitter").toInt();
+    simulation.errorRate   = parser.value("error-rate").toDouble();
+    simulation.timeoutRate = parser.value("timeout-rate").toDouble();
+    simulation.timeoutMs   = parser.value("timeout").toInt();
+    simulation.seed        = parser.value("seed").toUInt();
+
+    QTextStream     out(stdout);
+    CameraSimulator simulator(simulation);
+    if (!simulator.start()) {
+        QTextStream(stderr) << simulator.errorString() << endl;
+        return 1;
+    }
+    out << simulator.deviceCount() << " cameras on " << parser.value("host")
+        << ":" << simulation.basePort << "-"
+        << simulation.basePort + simulator.deviceCount() - 1;
+    if (simulation.discoveryPort != 0)
+        out << ", discovery on port " << simulation.discoveryPort;
+    out << endl;
+
+    QTimer stats;
+    QObject::connect(&stats, &QTimer::timeout, [&]() {
+        SimulatorStats counters = simulator.stats();
+        out << "probes " << counters.probes << " requests "
+            << counters.requests << " responses " << counters.responses
+            << " faults " << counters.faults << " timeouts "
+            << counters.timeouts << endl;
+    });
+    if (parser.value("stats").toInt() > 0)
+        stats.start(parser.value("stats").toInt() * 1000);
+
+    return app.exec();
+}
@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# onvif-sim --devices 5000 --latency 40 --jitter 30 --error-rate 0.01
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+CONFIG   += c++11 console
+CONFIG   -= app_bundle
+
+QMAKE_RPATHDIR += .
+
+DESTDIR  = ../../../bin
+TARGET = onvif-sim
+TEMPLATE = app
+
+# the corpus shared with the benchmarks
+DEFINES += FIXTURES_DIR=\\\"$$PWD/../bench/fixtures\\\"
+
+SOURCES += \
+    main.cpp
+
+LIBS += -L$$PWD/../../../bin/ -lQOnvifSimulator
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
@@ -77,6 +77,23 @@ SOURCES += \
     messageparser.cpp \
     ptzmanagement.cpp \
     service.cpp \
+    responsestatus.cpp \
+    elementstream.cpp \
+    wiretrace.cpp \
+    requesttrace.cpp \
+    metrics.cpp \
+    devicesnapshot.cpp \
+    requestscheduler.cpp \
+    retrypolicy.cpp \
+    timerwheel.cpp \
+    tlssessions.cpp \
+    healthmonitor.cpp \
+    clockoffset.cpp \
+    credentialvault.cpp \
+    httpdigest.cpp \
+    eventmanagement.cpp \
+    notificationdecoder.cpp \
+    eventmultiplexer.cpp \
     device_management/systemscopes.cpp \
     ptz_management/homeposition.cpp \
     device_management/networkdefaultgateway.cpp
@@ -130,6 +147,24 @@ HEADERS += \
     ../include/QOnvifManager/ptzmanagement.h \
     ../include/QOnvifManager/qringbuffer_p.h \
     ../include/QOnvifManager/service.h \
+    ../include/QOnvifManager/responsestatus.h \
+    ../include/QOnvifManager/elementstream.h \
+    ../include/QOnvifManager/wiretrace.h \
+    ../include/QOnvifManager/requesttrace.h \
+    ../include/QOnvifManager/metrics.h \
+    ../include/QOnvifManager/devicesnapshot.h \
+    ../include/QOnvifManager/requestscheduler.h \
+    ../include/QOnvifManager/retrypolicy.h \
+    ../include/QOnvifManager/timerwheel.h \
+    ../include/QOnvifManager/tlssessions.h \
+    ../include/QOnvifManager/healthmonitor.h \
+    ../include/QOnvifManager/clockoffset.h \
+    ../include/QOnvifManager/credentialvault.h \
+    ../include/QOnvifManager/httpdigest.h \
+    ../include/QOnvifManager/eventmanagement.h \
+    ../include/QOnvifManager/notificationdecoder.h \
+    ../include/QOnvifManager/eventmultiplexer.h \
+    ../include/metricssnapshot.hpp \
     ../include/QOnvifManager/device_management/systemscopes.h \
     ../include/QOnvifManager/ptz_management/homeposition.h \
     ../include/QOnvifManager/device_management/networkdefaultgateway.h
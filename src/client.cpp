@@ -1,4 +1,6 @@
 #include "client.h"
+#include "httpdigest.h"
+#include "wiretrace.h"
 #include <QEventLoop>
 #include <QUrl>
 #include <QDebug>
@@ -11,21 +13,132 @@ using namespace ONVIF;
 Client::Client(const QString &url)
 {
     mUrl = url;
+    mAuthentication = NULL;
+    // one manager per client so the connections to the device are kept alive
+    // and concurrent requests are queued by Qt (at most 6 per host)
+    mNetworkManager = new QNetworkAccessManager(this);
+    mOwnsNetworkManager = true;
 }
 
-QString Client::sendData(const QString &data)
+void Client::shareNetworkAccessManager(QNetworkAccessManager *manager)
 {
+    if (manager == NULL || manager == mNetworkManager)
+        return;
+    if (mOwnsNetworkManager)
+        delete mNetworkManager;
+    mNetworkManager = manager;
+    mOwnsNetworkManager = false;
+}
+
+void Client::setTlsTrust(const TlsTrust &trust)
+{
+    mTlsTrust = trust;
+}
+
+void Client::setCredentials(const QString &username, const QString &password)
+{
+    mUsername = username;
+    mPassword = password;
+}
+
+void Client::setAuthentication(Data::Authentication *authentication)
+{
+    mAuthentication = authentication;
+}
+
+QByteArray Client::sendData(const QByteArray &data)
+{
+    QNetworkReply *reply = postData(data);
+    waitForReplies(QList<QNetworkReply *>() << reply);
+    return readReply(reply);
+}
+
+QNetworkReply *Client::postData(const QByteArray &data,
+                                QNetworkRequest::Priority priority)
+{
+    return postData(data, mUrl, priority);
+}
 
-    QNetworkAccessManager* networkManager = new QNetworkAccessManager(this);
-    QUrl url(mUrl);
+QNetworkReply *Client::postData(const QByteArray &data, const QString &address,
+                                QNetworkRequest::Priority priority)
+{
+    QUrl url(address);
 
     QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader,"Content-Type: text/xml");
+    request.setHeader(QNetworkRequest::ContentTypeHeader,
+                      "application/soap+xml; charset=utf-8");
+    request.setPriority(priority);
+    // a resumed handshake when the host gave us a session ticket before
+    TlsSessions::prepare(request);
+    if (mAuthentication != NULL && mAuthentication->scheme == "Digest") {
+        // the cached nonce saves the 401 round trip, until it goes stale
+        QByteArray uri = url.toEncoded(QUrl::RemoveScheme |
+                                       QUrl::RemoveAuthority |
+                                       QUrl::RemoveFragment);
+        if (uri.isEmpty())
+            uri = "/";
+        QByteArray authorization = HttpDigest::authorization(
+                    *mAuthentication, "POST", uri, mUsername, mPassword);
+        if (!authorization.isEmpty())
+            request.setRawHeader("Authorization", authorization);
+    }
 
-    QNetworkReply *reply = networkManager->post(request, data.toLatin1());
-    QEventLoop loop;
-    connect(reply, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
+    QNetworkReply *reply = mNetworkManager->post(request, data);
+    TlsSessions::watch(reply, mTlsTrust);
+    if (mAuthentication != NULL)
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            learn(reply);
+        });
+    if (onvifWire().isDebugEnabled())
+        WireTrace::traceRequest(reply, data);
+    return reply;
+}
 
-    return reply->readAll();
+QByteArray Client::readReply(QNetworkReply *reply)
+{
+    if (reply == NULL)
+        return QByteArray();
+    QByteArray result = reply->readAll();
+    if (onvifWire().isDebugEnabled())
+        WireTrace::traceResponse(reply, result);
+    reply->deleteLater();
+    return result;
+}
+
+bool Client::isChallenge(QNetworkReply *reply)
+{
+    return reply != NULL && reply->property("onvifChallenge").toBool();
+}
+
+void Client::learn(QNetworkReply *reply)
+{
+    if (mAuthentication == NULL)
+        return;
+    if (HttpDigest::takeChallenge(*mAuthentication, reply)) {
+        reply->setProperty("onvifChallenge", true);
+        return;
+    }
+    // a device that answered without a challenge takes the UsernameToken
+    int httpStatus =
+            reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus >= 200 && httpStatus < 300 &&
+            mAuthentication->scheme.isEmpty())
+        mAuthentication->scheme = "UsernameToken";
+}
+
+void Client::waitForReplies(const QList<QNetworkReply *> &replies)
+{
+    QEventLoop loop;
+    int pending = 0;
+    foreach (QNetworkReply *reply, replies) {
+        if (reply == NULL || reply->isFinished())
+            continue;
+        pending++;
+        connect(reply, &QNetworkReply::finished, &loop, [&pending, &loop]() {
+            if (--pending == 0)
+                loop.quit();
+        });
+    }
+    if (pending > 0)
+        loop.exec();
 }
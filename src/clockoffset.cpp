@@ -0,0 +1,89 @@
+#include "clockoffset.h"
+
+using namespace ONVIF;
+
+ClockOffset::ClockOffset()
+    : mOffsetMs(0), mMeasured(false), mMeasuring(false), mLastAttempt(0) {}
+
+void
+ClockOffset::setMeasure(Measure _measure) {
+    mMeasure = _measure;
+}
+
+qint64
+ClockOffset::offsetMsecs() {
+    if (!mMeasured)
+        measure();
+    return mOffsetMs;
+}
+
+qint64
+ClockOffset::lastOffsetMsecs() const {
+    return mOffsetMs;
+}
+
+bool
+ClockOffset::isMeasured() const {
+    return mMeasured;
+}
+
+bool
+ClockOffset::remeasure() {
+    qint64 before = mOffsetMs;
+    if (!measure())
+        return false;
+    return qAbs(mOffsetMs - before) > kToleranceMs;
+}
+
+void
+ClockOffset::invalidate() {
+    mMeasured = false;
+}
+
+qint64
+ClockOffset::fromDeviceTime(
+    const QDateTime& _utc, qint64 _sentMsecs, qint64 _receivedMsecs) {
+    // the device read its clock about halfway through the round trip, and
+    // on average half a second after the second it reported
+    qint64 device = _utc.toMSecsSinceEpoch() + 500;
+    return device - (_sentMsecs + _receivedMsecs) / 2;
+}
+
+bool
+ClockOffset::needsMeasure() const {
+    return !mMeasured && mayMeasure(QDateTime::currentMSecsSinceEpoch());
+}
+
+void
+ClockOffset::startMeasure() {
+    mMeasuring   = true;
+    mLastAttempt = QDateTime::currentMSecsSinceEpoch();
+}
+
+void
+ClockOffset::finishMeasure(bool _measured, qint64 _offsetMsecs) {
+    mMeasuring = false;
+    if (_measured) {
+        mOffsetMs = _offsetMsecs;
+        mMeasured = true;
+    }
+}
+
+bool
+ClockOffset::measure() {
+    // the measuring request itself is sent from a nested event loop, the
+    // requests built meanwhile go with the offset at hand
+    if (!mMeasure || !mayMeasure(QDateTime::currentMSecsSinceEpoch()))
+        return false;
+    startMeasure();
+    qint64 offset   = 0;
+    bool   measured = mMeasure(offset);
+    finishMeasure(measured, offset);
+    return measured;
+}
+
+bool
+ClockOffset::mayMeasure(qint64 _now) const {
+    return !mMeasuring &&
+           (mLastAttempt == 0 || _now - mLastAttempt >= kMinIntervalMs);
+}
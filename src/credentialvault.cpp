@@ -0,0 +1,251 @@
+#include "credentialvault.h"
+#include "devicemanagement.h"
+#include <QUrl>
+#include <algorithm>
+
+using namespace ONVIF;
+
+CredentialVault::CredentialVault(QObject* _parent)
+    : QObject(_parent), mGeneration(0), mMaxInFlight(8) {}
+
+CredentialVault::~CredentialVault() {
+    cancelTrials();
+}
+
+void
+CredentialVault::setDefault(const Credential& _credential) {
+    if (_credential != mDefault)
+        forget(mDefault);
+    mDefault = _credential;
+}
+
+CredentialVault::Credential
+CredentialVault::defaultCredential() const {
+    return mDefault;
+}
+
+bool
+CredentialVault::addSite(const QString& _site, const Credential& _credential) {
+    QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(_site);
+    if (subnet.first.isNull())
+        return false;
+    for (Site& site : mSites) {
+        if (site.subnet != subnet)
+            continue;
+        if (!site.credentials.contains(_credential))
+            site.credentials.append(_credential);
+        return true;
+    }
+    Site site;
+    site.subnet = subnet;
+    site.credentials.append(_credential);
+    mSites.append(site);
+    return true;
+}
+
+void
+CredentialVault::removeSite(const QString& _site) {
+    QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(_site);
+    for (int i = mSites.size() - 1; i >= 0; i--) {
+        if (mSites.at(i).subnet != subnet)
+            continue;
+        for (const Credential& credential : mSites.at(i).credentials)
+            forget(credential);
+        mSites.removeAt(i);
+    }
+}
+
+void
+CredentialVault::setDevice(
+    const QString& _endPoint, const Credential& _credential) {
+    mDevices.insert(_endPoint, _credential);
+    mLearned.remove(_endPoint);
+    mTrials.remove(_endPoint);
+}
+
+void
+CredentialVault::removeDevice(const QString& _endPoint) {
+    mDevices.remove(_endPoint);
+    mLearned.remove(_endPoint);
+}
+
+QList<CredentialVault::Credential>
+CredentialVault::candidates(
+    const QString& _endPoint, const QString& _serviceAddress) const {
+    QList<Credential> result;
+    if (mDevices.contains(_endPoint))
+        result.append(mDevices.value(_endPoint));
+    if (mLearned.contains(_endPoint) &&
+        !result.contains(mLearned.value(_endPoint)))
+        result.append(mLearned.value(_endPoint));
+
+    QHostAddress       address(QUrl(_serviceAddress).host());
+    QList<const Site*> sites;
+    for (const Site& site : mSites) {
+        if (address.isInSubnet(site.subnet))
+            sites.append(&site);
+    }
+    std::stable_sort(
+        sites.begin(), sites.end(), [](const Site* _a, const Site* _b) {
+            return _a->subnet.second > _b->subnet.second;
+        });
+    for (const Site* site : sites) {
+        for (const Credential& credential : site->credentials) {
+            if (!result.contains(credential))
+                result.append(credential);
+        }
+    }
+
+    if (!result.contains(mDefault))
+        result.append(mDefault);
+    return result;
+}
+
+bool
+CredentialVault::isSettled(const QString& _endPoint) const {
+    return mDevices.contains(_endPoint) || mLearned.contains(_endPoint);
+}
+
+void
+CredentialVault::setMaxInFlight(int _checks) {
+    mMaxInFlight = qMax(1, _checks);
+    pump();
+}
+
+int
+CredentialVault::maxInFlight() const {
+    return mMaxInFlight;
+}
+
+void
+CredentialVault::setTlsTrust(const TlsTrust& _trust) {
+    mTlsTrust = _trust;
+}
+
+void
+CredentialVault::startTrial(
+    const QString& _endPoint, const QString& _serviceAddress) {
+    QList<Credential> tried = candidates(_endPoint, _serviceAddress);
+    Trial             trial;
+    trial.generation = ++mGeneration;
+    trial.pending    = tried.size();
+    trial.first      = tried.first();
+    mTrials.insert(_endPoint, trial);
+
+    DeviceClockPtr clock(new DeviceClock);
+    clock->service.reset(
+        new DeviceManagement(_serviceAddress, QString(), QString()));
+    clock->service->setTlsTrust(mTlsTrust);
+    DeviceManagement* service = clock->service.data();
+    clock->offset.setMeasure([service](qint64& _offsetMsecs) {
+        return service->getClockOffset(_offsetMsecs);
+    });
+    for (const Credential& credential : tried) {
+        AttemptPtr attempt(new Attempt);
+        attempt->endPoint       = _endPoint;
+        attempt->serviceAddress = _serviceAddress;
+        attempt->generation     = trial.generation;
+        attempt->credential     = credential;
+        attempt->clock          = clock;
+        mQueue.enqueue(attempt);
+    }
+    pump();
+}
+
+bool
+CredentialVault::isTrialRunning(const QString& _endPoint) const {
+    return mTrials.contains(_endPoint);
+}
+
+void
+CredentialVault::cancelTrials() {
+    // the running checks finish on their own and are ignored
+    mTrials.clear();
+    mQueue.clear();
+}
+
+void
+CredentialVault::post(AttemptPtr _attempt) {
+    if (_attempt->service == NULL) {
+        _attempt->service = new DeviceManagement(
+            _attempt->serviceAddress,
+            _attempt->credential.username,
+            _attempt->credential.password);
+        _attempt->service->setParent(this);
+        _attempt->service->setAuthentication(&_attempt->authentication);
+        _attempt->service->setTlsTrust(mTlsTrust);
+        _attempt->service->setClockOffset(&_attempt->clock->offset);
+    }
+    _attempt->reply = _attempt->service->postCredentialCheck();
+    if (_attempt->reply == NULL) {
+        finished(_attempt);
+        return;
+    }
+    connect(
+        _attempt->reply, &QNetworkReply::finished, this, [this, _attempt]() {
+            finished(_attempt);
+        });
+}
+
+void
+CredentialVault::finished(AttemptPtr _attempt) {
+    // a Digest device answers the first request with its challenge, which
+    // the client has taken by now
+    if (!_attempt->challenged && Client::isChallenge(_attempt->reply)) {
+        _attempt->challenged = true;
+        _attempt->reply->deleteLater();
+        post(_attempt);
+        return;
+    }
+    ResponseStatus status =
+        _attempt->service->readCredentialCheck(_attempt->reply);
+    _attempt->reply = NULL;
+    _attempt->service->deleteLater();
+    _attempt->service = NULL;
+    _attempt->clock.clear();
+    mRunning.removeOne(_attempt);
+
+    // a fault other than NotAuthorized (FailedAuthentication included)
+    // means the credential got through
+    bool accepted = status.isOk() ||
+                    status.error() == ResponseStatus::SoapFault ||
+                    status.error() == ResponseStatus::UnexpectedResponse;
+    auto trial = mTrials.find(_attempt->endPoint);
+    if (trial != mTrials.end() &&
+        trial->generation == _attempt->generation) {
+        if (accepted) {
+            mTrials.erase(trial);
+            mLearned.insert(_attempt->endPoint, _attempt->credential);
+            emit trialFinished(_attempt->endPoint, _attempt->credential, true);
+        } else if (--trial->pending == 0) {
+            Credential first = trial->first;
+            mTrials.erase(trial);
+            emit trialFinished(_attempt->endPoint, first, false);
+        }
+    }
+    pump();
+}
+
+void
+CredentialVault::pump() {
+    while (mRunning.size() < mMaxInFlight && !mQueue.isEmpty()) {
+        AttemptPtr attempt = mQueue.dequeue();
+        auto       trial   = mTrials.constFind(attempt->endPoint);
+        // its trial is over or was started again
+        if (trial == mTrials.constEnd() ||
+            trial->generation != attempt->generation)
+            continue;
+        mRunning.append(attempt);
+        post(attempt);
+    }
+}
+
+void
+CredentialVault::forget(const Credential& _credential) {
+    for (auto it = mLearned.begin(); it != mLearned.end();) {
+        if (it.value() == _credential)
+            it = mLearned.erase(it);
+        else
+            ++it;
+    }
+}
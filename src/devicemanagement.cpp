@@ -3,6 +3,133 @@
 
 using namespace ONVIF;
 
+namespace {
+void
+readPtzCapabilities(MessageParser* result, Capabilities* capabilities) {
+    capabilities->setProperty(
+        "ptzXAddr", result->getValue("//tt:PTZ/tt:XAddr"));
+}
+
+void
+readImagingCapabilities(MessageParser* result, Capabilities* capabilities) {
+    capabilities->setProperty(
+        "imagingXAddr", result->getValue("//tt:Imaging/tt:XAddr"));
+}
+
+void
+readEventsCapabilities(MessageParser* result, Capabilities* capabilities) {
+    capabilities->setProperty(
+        "eventsXAddr", result->getValue("//tt:Events/tt:XAddr"));
+}
+
+void
+readMediaCapabilities(MessageParser* result, Capabilities* capabilities) {
+    capabilities->setProperty(
+        "mediaXAddr", result->getValue("//tt:Media/tt:XAddr"));
+    capabilities->setProperty(
+        "rtpMulticast",
+        result->getValue("//tt:RTPMulticast") == "true" ? true : false);
+    capabilities->setProperty(
+        "rtpTcp",
+        result->getValue("//tt:RTP_TCP") == "true" ? true : false);
+    capabilities->setProperty(
+        "rtpRtspTcp",
+        result->getValue("//tt:RTP_RTSP_TCP") == "true" ? true : false);
+}
+
+void
+readDeviceCapabilities(MessageParser* result, Capabilities* capabilities) {
+    capabilities->setProperty(
+        "deviceXAddr", result->getValue("//tt:Device/tt:XAddr"));
+    capabilities->setProperty(
+        "iPFilter",
+        result->getValue("//tt:IPFilter") == "true" ? true : false);
+    capabilities->setProperty(
+        "zeroConfiguration",
+        result->getValue("//tt:ZeroConfiguration") == "true" ? true
+                                                             : false);
+    capabilities->setProperty(
+        "iPVersion6",
+        result->getValue("//tt:IPVersion6") == "true" ? true : false);
+    capabilities->setProperty(
+        "dynDNS", result->getValue("//tt:DynDNS") == "true" ? true : false);
+    capabilities->setProperty(
+        "discoveryResolve",
+        result->getValue("//tt:DiscoveryResolve") == "true" ? true : false);
+    capabilities->setProperty(
+        "discoveryBye",
+        result->getValue("//tt:DiscoveryBye") == "true" ? true : false);
+    capabilities->setProperty(
+        "remoteDiscovery",
+        result->getValue("//tt:RemoteDiscovery") == "true" ? true : false);
+    capabilities->setProperty(
+        "systemBackup",
+        result->getValue("//tt:SystemBackup") == "true" ? true : false);
+    capabilities->setProperty(
+        "systemLogging",
+        result->getValue("//tt:SystemLogging") == "true" ? true : false);
+    capabilities->setProperty(
+        "firmwareUpgrade",
+        result->getValue("//tt:FirmwareUpgrade") == "true" ? true : false);
+    capabilities->setProperty(
+        "major", result->getValue("//tt:Major").toInt());
+    capabilities->setProperty(
+        "minor", result->getValue("//tt:Minor").toInt());
+    capabilities->setProperty(
+        "httpFirmwareUpgrade",
+        result->getValue("//tt:HttpFirmwareUpgrade") == "true" ? true
+                                                               : false);
+    capabilities->setProperty(
+        "httpSystemBackup",
+        result->getValue("//tt:HttpSystemBackup") == "true" ? true : false);
+    capabilities->setProperty(
+        "httpSystemLogging",
+        result->getValue("//tt:HttpSystemLogging") == "true" ? true
+                                                             : false);
+    capabilities->setProperty(
+        "httpSupportInformation",
+        result->getValue("//tt:HttpSupportInformation") == "true" ? true
+                                                                  : false);
+    capabilities->setProperty(
+        "inputConnectors",
+        result->getValue("//tt:InputConnectors").toInt());
+    capabilities->setProperty(
+        "relayOutputs", result->getValue("//tt:RelayOutputs").toInt());
+    capabilities->setProperty(
+        "tls11", result->getValue("//tt:TLS1.1") == "true" ? true : false);
+    capabilities->setProperty(
+        "tls12", result->getValue("//tt:TLS1.2") == "true" ? true : false);
+    capabilities->setProperty(
+        "onboardKeyGeneration",
+        result->getValue("//tt:OnboardKeyGeneration") == "true" ? true
+                                                                : false);
+    capabilities->setProperty(
+        "accessPolicyConfig",
+        result->getValue("//tt:AccessPolicyConfig") == "true" ? true
+                                                              : false);
+    capabilities->setProperty(
+        "x509Token",
+        result->getValue("//tt:X.509Token") == "true" ? true : false);
+    capabilities->setProperty(
+        "samlToken",
+        result->getValue("//tt:SAMLToken") == "true" ? true : false);
+    capabilities->setProperty(
+        "kerberosToken",
+        result->getValue("//tt:KerberosToken") == "true" ? true : false);
+    capabilities->setProperty(
+        "relToken",
+        result->getValue("//tt:RELToken") == "true" ? true : false);
+    capabilities->setProperty(
+        "tls10", result->getValue("//tt:TLS1.0") == "true" ? true : false);
+    capabilities->setProperty(
+        "dot1x", result->getValue("//tt:Dot1x") == "true" ? true : false);
+    capabilities->setProperty(
+        "remoteUserHanding",
+        result->getValue("//tt:RemoteUserHanding") == "true" ? true
+                                                             : false);
+}
+} // namespace
+
 
 DeviceManagement::DeviceManagement(
     const QString& wsdlUrl, const QString& username, const QString& password)
@@ -113,6 +240,20 @@ DeviceManagement::getDeviceInformation() {
     return device_info;
 }
 
+QNetworkReply*
+DeviceManagement::postCredentialCheck() {
+    Message* msg = newMessage();
+    msg->appendToBody(newElement("wsdl:GetDeviceInformation"));
+    QNetworkReply* reply = postMessage(msg);
+    delete msg;
+    return reply;
+}
+
+ResponseStatus
+DeviceManagement::readCredentialCheck(QNetworkReply* reply) {
+    return readStatus(reply, "tds:GetDeviceInformationResponse");
+}
+
 QHash<QString, QString>
 DeviceManagement::getDeviceScopes() {
     QHash<QString, QString> device_scopes;
@@ -195,66 +336,108 @@ DeviceManagement::getSystemDateAndTime() {
     return systemDateAndTime;
 }
 
-void
+bool
+DeviceManagement::getClockOffset(qint64& offsetMsecs) {
+    Message*       msg      = newClockMessage();
+    qint64         sent     = QDateTime::currentMSecsSinceEpoch();
+    MessageParser* result   = sendMessage(msg);
+    qint64         received = QDateTime::currentMSecsSinceEpoch();
+    bool           measured = clockOffset(result, sent, received, offsetMsecs);
+    delete result;
+    delete msg;
+    return measured;
+}
+
+QNetworkReply*
+DeviceManagement::postClockOffset() {
+    Message*       msg   = newClockMessage();
+    QNetworkReply* reply = postMessage(msg);
+    delete msg;
+    return reply;
+}
+
+bool
+DeviceManagement::readClockOffset(
+    QNetworkReply* reply, qint64 sentMsecs, qint64& offsetMsecs) {
+    qint64         received = QDateTime::currentMSecsSinceEpoch();
+    MessageParser* result   = readMessage(reply);
+    bool measured = clockOffset(result, sentMsecs, received, offsetMsecs);
+    delete result;
+    return measured;
+}
+
+Message*
+DeviceManagement::newClockMessage() {
+    QHash<QString, QString> names;
+    names.insert("wsdl", "http://www.onvif.org/ver10/device/wsdl");
+    names.insert("sch", "http://www.onvif.org/ver10/schema");
+    // no WS-Security header, whatever the device thinks of our clock
+    Message* msg = new Message(names);
+    msg->appendToBody(newElement("wsdl:GetSystemDateAndTime"));
+    return msg;
+}
+
+bool
+DeviceManagement::clockOffset(
+    MessageParser* result, qint64 sent, qint64 received, qint64& offsetMsecs) {
+    if (result == NULL)
+        return false;
+    QDate date(
+        result->getValue("//tt:UTCDateTime/tt:Date/tt:Year").toInt(),
+        result->getValue("//tt:UTCDateTime/tt:Date/tt:Month").toInt(),
+        result->getValue("//tt:UTCDateTime/tt:Date/tt:Day").toInt());
+    QTime time(
+        result->getValue("//tt:UTCDateTime/tt:Time/tt:Hour").toInt(),
+        result->getValue("//tt:UTCDateTime/tt:Time/tt:Minute").toInt(),
+        result->getValue("//tt:UTCDateTime/tt:Time/tt:Second").toInt());
+    QDateTime utc(date, time, Qt::UTC);
+    if (!utc.isValid())
+        return false;
+    offsetMsecs = ClockOffset::fromDeviceTime(utc, sent, received);
+    return true;
+}
+
+ResponseStatus
 DeviceManagement::setSystemDateAndTime(SystemDateAndTime* systemDateAndTime) {
     Message* msg = newMessage();
     msg->appendToBody(systemDateAndTime->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetSystemDateAndTimeResponse"))
-            systemDateAndTime->setResult(true);
-        else
-            systemDateAndTime->setResult(false);
-
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status =
+        sendCommand(msg, "tds:SetSystemDateAndTimeResponse");
+    systemDateAndTime->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setDeviceScopes(SystemScopes* systemScopes) {
     Message* msg = newMessage();
     msg->appendToBody(systemScopes->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetScopesResponse"))
-            systemScopes->setResult(true);
-        else
-            systemScopes->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetScopesResponse");
+    systemScopes->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setSystemFactoryDefault(
     SystemFactoryDefault* systemFactoryDefault) {
     Message* msg = newMessage();
     msg->appendToBody(systemFactoryDefault->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetSystemFactoryDefaultResponse"))
-            systemFactoryDefault->setResult(true);
-        else
-            systemFactoryDefault->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status =
+        sendCommand(msg, "tds:SetSystemFactoryDefaultResponse");
+    systemFactoryDefault->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::systemReboot(SystemReboot* systemReboot) {
     Message* msg = newMessage();
     msg->appendToBody(systemReboot->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SystemRebootResponse"))
-            systemReboot->setResult(true);
-        else
-            systemReboot->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SystemRebootResponse");
+    systemReboot->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
 Users*
@@ -297,6 +480,27 @@ DeviceManagement::getUsers() {
     return user;
 }
 
+Capabilities*
+DeviceManagement::getCapabilities() {
+    Capabilities* capabilities = NULL;
+    Message*      msg          = newMessage();
+    QDomElement   cap          = newElement("wsdl:GetCapabilities");
+    cap.appendChild(newElement("wsdl:Category", "All"));
+    msg->appendToBody(cap);
+    MessageParser* result = sendMessage(msg);
+    if (result != NULL) {
+        capabilities = new Capabilities();
+        readDeviceCapabilities(result, capabilities);
+        readMediaCapabilities(result, capabilities);
+        readPtzCapabilities(result, capabilities);
+        readImagingCapabilities(result, capabilities);
+        readEventsCapabilities(result, capabilities);
+    }
+    delete result;
+    delete msg;
+    return capabilities;
+}
+
 Capabilities*
 DeviceManagement::getCapabilitiesPtz() {
     Capabilities* capabilities = NULL;
@@ -307,8 +511,7 @@ DeviceManagement::getCapabilitiesPtz() {
     MessageParser* result = sendMessage(msg);
     if (result != NULL) {
         capabilities = new Capabilities();
-        capabilities->setProperty(
-            "ptzXAddr", result->getValue("//tt:PTZ/tt:XAddr"));
+        readPtzCapabilities(result, capabilities);
     }
     delete result;
     delete msg;
@@ -325,8 +528,7 @@ DeviceManagement::getCapabilitiesImaging() {
     MessageParser* result = sendMessage(msg);
     if (result != NULL) {
         capabilities = new Capabilities();
-        capabilities->setProperty(
-            "imagingXAddr", result->getValue("//tt:Imaging/tt:XAddr"));
+        readImagingCapabilities(result, capabilities);
     }
     delete result;
     delete msg;
@@ -343,17 +545,7 @@ DeviceManagement::getCapabilitiesMedia() {
     MessageParser* result = sendMessage(msg);
     if (result != NULL) {
         capabilities = new Capabilities();
-        capabilities->setProperty(
-            "mediaXAddr", result->getValue("//tt:Media/tt:XAddr"));
-        capabilities->setProperty(
-            "rtpMulticast",
-            result->getValue("//tt:RTPMulticast") == "true" ? true : false);
-        capabilities->setProperty(
-            "rtpTcp",
-            result->getValue("//tt:RTP_TCP") == "true" ? true : false);
-        capabilities->setProperty(
-            "rtpRtspTcp",
-            result->getValue("//tt:RTP_RTSP_TCP") == "true" ? true : false);
+        readMediaCapabilities(result, capabilities);
     }
     delete result;
     delete msg;
@@ -370,94 +562,7 @@ DeviceManagement::getCapabilitiesDevice() {
     MessageParser* result = sendMessage(msg);
     if (result != NULL) {
         capabilities = new Capabilities();
-        capabilities->setProperty(
-            "deviceXAddr", result->getValue("//tt:Device/tt:XAddr"));
-        capabilities->setProperty(
-            "iPFilter",
-            result->getValue("//tt:IPFilter") == "true" ? true : false);
-        capabilities->setProperty(
-            "zeroConfiguration",
-            result->getValue("//tt:ZeroConfiguration") == "true" ? true
-                                                                 : false);
-        capabilities->setProperty(
-            "iPVersion6",
-            result->getValue("//tt:IPVersion6") == "true" ? true : false);
-        capabilities->setProperty(
-            "dynDNS", result->getValue("//tt:DynDNS") == "true" ? true : false);
-        capabilities->setProperty(
-            "discoveryResolve",
-            result->getValue("//tt:DiscoveryResolve") == "true" ? true : false);
-        capabilities->setProperty(
-            "discoveryBye",
-            result->getValue("//tt:DiscoveryBye") == "true" ? true : false);
-        capabilities->setProperty(
-            "remoteDiscovery",
-            result->getValue("//tt:RemoteDiscovery") == "true" ? true : false);
-        capabilities->setProperty(
-            "systemBackup",
-            result->getValue("//tt:SystemBackup") == "true" ? true : false);
-        capabilities->setProperty(
-            "systemLogging",
-            result->getValue("//tt:SystemLogging") == "true" ? true : false);
-        capabilities->setProperty(
-            "firmwareUpgrade",
-            result->getValue("//tt:FirmwareUpgrade") == "true" ? true : false);
-        capabilities->setProperty(
-            "major", result->getValue("//tt:Major").toInt());
-        capabilities->setProperty(
-            "minor", result->getValue("//tt:Minor").toInt());
-        capabilities->setProperty(
-            "httpFirmwareUpgrade",
-            result->getValue("//tt:HttpFirmwareUpgrade") == "true" ? true
-                                                                   : false);
-        capabilities->setProperty(
-            "httpSystemBackup",
-            result->getValue("//tt:HttpSystemBackup") == "true" ? true : false);
-        capabilities->setProperty(
-            "httpSystemLogging",
-            result->getValue("//tt:HttpSystemLogging") == "true" ? true
-                                                                 : false);
-        capabilities->setProperty(
-            "httpSupportInformation",
-            result->getValue("//tt:HttpSupportInformation") == "true" ? true
-                                                                      : false);
-        capabilities->setProperty(
-            "inputConnectors",
-            result->getValue("//tt:InputConnectors").toInt());
-        capabilities->setProperty(
-            "relayOutputs", result->getValue("//tt:RelayOutputs").toInt());
-        capabilities->setProperty(
-            "tls11", result->getValue("//tt:TLS1.1") == "true" ? true : false);
-        capabilities->setProperty(
-            "tls12", result->getValue("//tt:TLS1.2") == "true" ? true : false);
-        capabilities->setProperty(
-            "onboardKeyGeneration",
-            result->getValue("//tt:OnboardKeyGeneration") == "true" ? true
-                                                                    : false);
-        capabilities->setProperty(
-            "accessPolicyConfig",
-            result->getValue("//tt:AccessPolicyConfig") == "true" ? true
-                                                                  : false);
-        capabilities->setProperty(
-            "x509Token",
-            result->getValue("//tt:X.509Token") == "true" ? true : false);
-        capabilities->setProperty(
-            "samlToken",
-            result->getValue("//tt:SAMLToken") == "true" ? true : false);
-        capabilities->setProperty(
-            "kerberosToken",
-            result->getValue("//tt:KerberosToken") == "true" ? true : false);
-        capabilities->setProperty(
-            "relToken",
-            result->getValue("//tt:RELToken") == "true" ? true : false);
-        capabilities->setProperty(
-            "tls10", result->getValue("//tt:TLS1.0") == "true" ? true : false);
-        capabilities->setProperty(
-            "dot1x", result->getValue("//tt:Dot1x") == "true" ? true : false);
-        capabilities->setProperty(
-            "remoteUserHanding",
-            result->getValue("//tt:RemoteUserHanding") == "true" ? true
-                                                                 : false);
+        readDeviceCapabilities(result, capabilities);
     }
     delete result;
     delete msg;
@@ -510,110 +615,77 @@ DeviceManagement::getNetworkInterfaces() {
     return networkInterfaces;
 }
 
-void
+ResponseStatus
 DeviceManagement::setNetworkInterfaces(NetworkInterfaces* networkInterfaces) {
     Message* msg = newMessage();
     msg->appendToBody(networkInterfaces->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetNetworkInterfacesResponse"))
-            networkInterfaces->setResult(true);
-        else
-            networkInterfaces->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status =
+        sendCommand(msg, "tds:SetNetworkInterfacesResponse");
+    networkInterfaces->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setNetworkProtocols(NetworkProtocols* networkProtocols) {
     Message* msg = newMessage();
     msg->appendToBody(networkProtocols->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetNetworkProtocolsResponse"))
-            networkProtocols->setResult(true);
-        else
-            networkProtocols->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetNetworkProtocolsResponse");
+    networkProtocols->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setDefaultGateway(
     NetworkDefaultGateway* networkDefaultGateway) {
     Message* msg = newMessage();
     msg->appendToBody(networkDefaultGateway->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetNetworkDefaultGatewayResponse"))
-            networkDefaultGateway->setResult(true);
-        else
-            networkDefaultGateway->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status =
+        sendCommand(msg, "tds:SetNetworkDefaultGatewayResponse");
+    networkDefaultGateway->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setDiscoveryMode(NetworkDiscoveryMode* networkDiscoveryMode) {
     Message* msg = newMessage();
     msg->appendToBody(networkDiscoveryMode->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetDiscoveryModeResponse"))
-            networkDiscoveryMode->setResult(true);
-        else
-            networkDiscoveryMode->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetDiscoveryModeResponse");
+    networkDiscoveryMode->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setDNS(NetworkDNS* networkDns) {
     Message* msg = newMessage();
     msg->appendToBody(networkDns->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetDNSResponse"))
-            networkDns->setResult(true);
-        else
-            networkDns->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetDNSResponse");
+    networkDns->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setHostname(NetworkHostname* networkHostname) {
     Message* msg = newMessage();
     msg->appendToBody(networkHostname->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetHostnameResponse"))
-            networkHostname->setResult(true);
-        else
-            networkHostname->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetHostnameResponse");
+    networkHostname->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void
+ResponseStatus
 DeviceManagement::setNTP(NetworkNTP* networkNtp) {
     Message* msg = newMessage();
     msg->appendToBody(networkNtp->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetNTPResponse"))
-            networkNtp->setResult(true);
-        else
-            networkNtp->setResult(false);
-        delete result;
-        delete msg;
-    }
+    ResponseStatus status = sendCommand(msg, "tds:SetNTPResponse");
+    networkNtp->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
 NetworkProtocols*
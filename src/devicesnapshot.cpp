@@ -0,0 +1,422 @@
+#include "devicesnapshot.h"
+#include <QDataStream>
+#include <QFile>
+
+using namespace ONVIF;
+
+namespace {
+// the same field lists write and read a record
+struct Writer {
+    QDataStream& stream;
+    template <typename T>
+    Writer& operator&(const T& _value) {
+        stream << _value;
+        return *this;
+    }
+};
+
+struct Reader {
+    QDataStream& stream;
+    template <typename T>
+    Reader& operator&(T& _value) {
+        stream >> _value;
+        return *this;
+    }
+};
+
+template <typename A>
+void
+io(A& _a, Data::ProbeData& _p) {
+    _a & _p.endPointAddress & _p.types & _p.deviceIp &
+        _p.deviceServiceAddress & _p.scopes & _p.metadataVersion;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Information& _i) {
+    _a & _i.manufacturer & _i.model & _i.firmwareVersion & _i.serialNumber &
+        _i.hardwareId;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Scopes& _s) {
+    _a & _s.name & _s.location & _s.hardware;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Capabilities& _c) {
+    _a & _c.ptzAddress & _c.imagingXAddress & _c.mediaXAddress &
+        _c.rtpMulticast & _c.rtpTcp & _c.rtpRtspTcp & _c.deviceXAddr &
+        _c.iPFilter & _c.zeroConfiguration & _c.iPVersion6 & _c.dynDNS &
+        _c.discoveryResolve & _c.systemLogging & _c.firmwareUpgrade &
+        _c.major & _c.minor & _c.httpFirmwareUpgrade & _c.httpSystemBackup &
+        _c.httpSystemLogging & _c.httpSupportInformation &
+        _c.inputConnectors & _c.relayOutputs & _c.tls11 & _c.tls22 &
+        _c.onboardKeyGeneration & _c.accessPolicyConfig & _c.x509Token &
+        _c.samlToken & _c.kerberosToken & _c.relToken & _c.tls10 & _c.dot1x &
+        _c.remoteUserHanding & _c.systemBackup & _c.discoveryBye &
+        _c.remoteDiscovery & _c.eventsXAddress;
+}
+
+// passwords are not kept on disk, GetUsers does not return them anyway
+template <typename A>
+void
+io(A& _a, Data::User& _u) {
+    _a & _u.username & _u.userLevel;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Network& _n) {
+    _a & _n.protocols.networkProtocolsName &
+        _n.protocols.networkProtocolsEnabled &
+        _n.protocols.networkProtocolsPort;
+
+    Data::Network::Interfaces& i = _n.interfaces;
+    _a & i.networkInfacesEnabled & i.autoNegotiation & i.speed &
+        i.duplexFull & i.mtu & i.ipv4Enabled & i.ipv4ManualAddress &
+        i.ipv4ManualPrefixLength & i.ipv4DHCP & i.ipv4LinkLocalAddress &
+        i.ipvLinkLocalPrefixLength & i.ipv4FromDHCPAddress &
+        i.ipv4FromDHCPPrefixLength & i.networkInfacesName & i.hwAaddress &
+        i.result;
+
+    _a & _n.dns.dhcp & _n.dns.searchDomain & _n.dns.manualType &
+        _n.dns.ipv4Address;
+    _a & _n.defaultGateway.ipv4Address & _n.defaultGateway.ipv6Address;
+    _a & _n.discoveryMode.discoveryMode;
+    _a & _n.hostname.dhcp & _n.hostname.name;
+    _a & _n.ntp.dhcp & _n.ntp.manualType & _n.ntp.ipv4Address &
+        _n.ntp.ipv6Address;
+}
+
+template <typename A>
+void
+io(A& _a, Data::DateTime& _d) {
+    _a & _d.utcTime & _d.localTime & _d.timeZone & _d.daylightSaving;
+}
+
+template <typename A>
+void
+io(A& _a, Data::MediaConfig::Audio& _audio) {
+    auto& o = _audio.encodingOptions;
+    _a & o.bitratList & o.sampleRateList & o.encoding;
+
+    auto& e = _audio.encodingConfig;
+    _a & e.token & e.name & e.useCount & e.encoding & e.bitrate &
+        e.sampleRate & e.type & e.ipv4Address & e.ipv6Address & e.port &
+        e.ttl & e.autoStart & e.sessionTimeout;
+
+    auto& s = _audio.sourceConfig;
+    _a & s.token & s.name & s.useCount & s.sourceToken;
+}
+
+template <typename A>
+void
+io(A& _a, Data::MediaConfig::Video::StreamUri& _s) {
+    _a & _s.uri & _s.invalidAfterConnect & _s.invalidAfterReboot &
+        _s.timeout;
+}
+
+template <typename A>
+void
+io(A& _a, Data::MediaConfig::Video::EncoderConfigs::Option& _o) {
+    _a & _o.qualityRangeMin & _o.qualityRangeMax & _o.resAvailableWidthH264 &
+        _o.resAvailableHeightH264 & _o.resAvailableWidthJpeg &
+        _o.resAvailableHeightJpeg & _o.govLengthRangeMin &
+        _o.govLengthRangeMax & _o.frameRateRangeMinH264 &
+        _o.frameRateRangeMaxH264 & _o.frameRateRangeMinJpeg &
+        _o.frameRateRangeMaxJpeg & _o.bitRateRangeMin & _o.bitRateRangeMax &
+        _o.encodingIntervalRangeMinH264 & _o.encodingIntervalRangeMaxH264 &
+        _o.encodingIntervalRangeMinJpeg & _o.encodingIntervalRangeMaxJpeg &
+        _o.h264ProfilesSupported;
+}
+
+template <typename A>
+void
+io(A& _a, Data::MediaConfig::Video& _video) {
+    io(_a, _video.streamUri);
+
+    auto& c = _video.encodingConfigs;
+    _a & c.token & c.name & c.useCount & c.encoding & c.width & c.height &
+        c.quality & c.frameRateLimit & c.encodingInterval & c.bitrateLimit &
+        c.govLength & c.h264Profile & c.type & c.ipv4Address &
+        c.ipv6Address & c.port & c.ttl & c.autoStart & c.sessionTimeout &
+        c.options;
+
+    auto& e = _video.encodingConfig;
+    _a & e.token & e.name & e.useCount & e.encoding & e.width & e.height &
+        e.quality & e.frameRateLimit & e.encodingInterval & e.bitrateLimit &
+        e.govLength & e.h264Profile & e.type & e.ipv4Address &
+        e.ipv6Address & e.port & e.ttl & e.autoStart & e.sessionTimeout;
+
+    auto& s = _video.sourceConfig;
+    _a & s.name & s.useCount & s.sourceToken & s.bounds;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Ptz::Config& _c) {
+    _a & _c.profileToken & _c.name & _c.useCount & _c.nodeToken &
+        _c.defaultAbsolutePantTiltPositionSpace &
+        _c.defaultAbsoluteZoomPositionSpace &
+        _c.defaultRelativePanTiltTranslationSpace &
+        _c.defaultRelativeZoomTranslationSpace &
+        _c.defaultContinuousPanTiltVelocitySpace &
+        _c.defaultContinuousZoomVelocitySpace & _c.panTiltX & _c.panTiltY &
+        _c.zoomSpace & _c.defaultPTZTimeout & _c.panTiltUri &
+        _c.panTiltXRangeMin & _c.panTiltXRangeMax & _c.panTiltYRangeMin &
+        _c.panTiltYRangeMax & _c.zoomUri & _c.zoomXRangeMin &
+        _c.zoomXRangeMax & _c.ptzConfigurationToken & _c.panTiltSpace &
+        _c.zoomX;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Profiles& _p) {
+    _a & _p.toKenPro & _p.streamUris & _p.streamUrisMulticast &
+        _p.streamUrisHttp & _p.fixed & _p.namePro;
+    _a & _p.nameVsc & _p.useCountVsc & _p.sourceTokenVsc & _p.boundsVsc;
+    _a & _p.nameVec & _p.useCountVec & _p.encodingVec & _p.widthVec &
+        _p.heightVec & _p.qualityVec & _p.frameRateLimitVec &
+        _p.encodingIntervalVec & _p.bitrateLimitVec & _p.govLengthVec &
+        _p.h264ProfileVec & _p.typeVec & _p.ipv4AddressVec &
+        _p.ipv6AddressVec & _p.portVec & _p.ttlVec & _p.autoStartVec &
+        _p.sessionTimeoutVec;
+    _a & _p.namePtz & _p.useCountPtz & _p.nodeToken &
+        _p.defaultAbsolutePantTiltPositionSpace &
+        _p.defaultAbsoluteZoomPositionSpace &
+        _p.defaultRelativePantTiltTranslationSpace &
+        _p.defaultRelativeZoomTranslationSpace &
+        _p.defaultContinuousPantTiltVelocitySpace &
+        _p.defaultContinuousZoomVelocitySpace & _p.panTiltSpace &
+        _p.panTiltX & _p.panTiltY & _p.zoomSpace & _p.zoomX &
+        _p.defaultPTZTimeout & _p.panTiltUri & _p.xRangeMinPt &
+        _p.xRangeMaxPt & _p.yRangeMinPt & _p.yRangeMaxPt & _p.zoomUri &
+        _p.xRangeMinZm & _p.xRangeMaxZm;
+    _a & _p.nameMc & _p.useCountMc & _p.status & _p.position & _p.filter &
+        _p.subscriptionPolicy & _p.analytics & _p.typeMc & _p.ipv4AddressMc &
+        _p.ipv6AddressMc & _p.portMc & _p.ttlMc & _p.autoStartMc &
+        _p.sessionTimeoutMc;
+}
+
+template <typename A>
+void
+io(A& _a, Data::Authentication& _auth) {
+    _a & _auth.scheme & _auth.realm & _auth.nonce & _auth.opaque &
+        _auth.algorithm & _auth.qop & _auth.nonceCount;
+}
+
+template <typename A>
+void
+io(A& _a, Data& _data) {
+    io(_a, _data.probeData);
+    io(_a, _data.information);
+    io(_a, _data.scopes);
+    io(_a, _data.capabilities);
+    _a & _data.users;
+    io(_a, _data.network);
+    io(_a, _data.dateTime);
+    io(_a, _data.mediaConfig.audio);
+    io(_a, _data.mediaConfig.video);
+    io(_a, _data.ptz.config);
+    io(_a, _data.profiles);
+    io(_a, _data.authentication);
+}
+} // namespace
+
+// the types that are stored in lists go through QDataStream (and its QList
+// operators), enums as their underlying int
+QDataStream&
+operator<<(QDataStream& _stream, const Data::User& _user) {
+    Writer writer{_stream};
+    io(writer, const_cast<Data::User&>(_user));
+    return _stream;
+}
+
+QDataStream&
+operator>>(QDataStream& _stream, Data::User& _user) {
+    Reader reader{_stream};
+    io(reader, _user);
+    return _stream;
+}
+
+QDataStream&
+operator<<(
+    QDataStream& _stream, const Data::MediaConfig::Video::StreamUri& _uri) {
+    Writer writer{_stream};
+    io(writer, const_cast<Data::MediaConfig::Video::StreamUri&>(_uri));
+    return _stream;
+}
+
+QDataStream&
+operator>>(
+    QDataStream& _stream, Data::MediaConfig::Video::StreamUri& _uri) {
+    Reader reader{_stream};
+    io(reader, _uri);
+    return _stream;
+}
+
+QDataStream&
+operator<<(
+    QDataStream&                                            _stream,
+    const Data::MediaConfig::Video::EncoderConfigs::Option& _option) {
+    Writer writer{_stream};
+    io(writer,
+       const_cast<Data::MediaConfig::Video::EncoderConfigs::Option&>(_option));
+    return _stream;
+}
+
+QDataStream&
+operator>>(
+    QDataStream&                                      _stream,
+    Data::MediaConfig::Video::EncoderConfigs::Option& _option) {
+    Reader reader{_stream};
+    io(reader, _option);
+    return _stream;
+}
+
+QDataStream&
+operator<<(QDataStream& _stream, Data::User::UserLevelType _level) {
+    return _stream << qint32(_level);
+}
+
+QDataStream&
+operator>>(QDataStream& _stream, Data::User::UserLevelType& _level) {
+    qint32 value = 0;
+    _stream >> value;
+    _level = Data::User::UserLevelType(value);
+    return _stream;
+}
+
+QDataStream&
+operator<<(
+    QDataStream&                                         _stream,
+    Data::MediaConfig::Audio::EncodingOptions::Encoding _encoding) {
+    return _stream << qint32(_encoding);
+}
+
+QDataStream&
+operator>>(
+    QDataStream&                                          _stream,
+    Data::MediaConfig::Audio::EncodingOptions::Encoding& _encoding) {
+    qint32 value = 0;
+    _stream >> value;
+    _encoding = Data::MediaConfig::Audio::EncodingOptions::Encoding(value);
+    return _stream;
+}
+
+QDataStream&
+operator<<(
+    QDataStream& _stream,
+    Data::MediaConfig::Video::EncoderConfigs::Option::H264ProfilesSupported
+        _profile) {
+    return _stream << qint32(_profile);
+}
+
+QDataStream&
+operator>>(
+    QDataStream& _stream,
+    Data::MediaConfig::Video::EncoderConfigs::Option::H264ProfilesSupported&
+        _profile) {
+    qint32 value = 0;
+    _stream >> value;
+    _profile = Data::MediaConfig::Video::EncoderConfigs::Option::
+        H264ProfilesSupported(value);
+    return _stream;
+}
+
+namespace {
+// records are always written with the same stream version, whatever Qt the
+// process runs on
+const QDataStream::Version kStreamVersion = QDataStream::Qt_5_0;
+}
+
+bool
+DeviceSnapshot::save(const QString& _fileName, const QList<Data>& _devices) {
+    QString temporary = _fileName + ".tmp";
+    QFile   file(temporary);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QDataStream header(&file);
+    header.setVersion(kStreamVersion);
+    header << kMagic << kFormatVersion << quint32(_devices.size());
+
+    QByteArray record;
+    for (const Data& data : _devices) {
+        record.clear();
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setVersion(kStreamVersion);
+        Writer writer{stream};
+        io(writer, const_cast<Data&>(data));
+        header << quint32(record.size());
+        header.writeRawData(record.constData(), record.size());
+    }
+
+    bool written = header.status() == QDataStream::Ok && file.flush();
+    file.close();
+    if (!written) {
+        QFile::remove(temporary);
+        return false;
+    }
+    QFile::remove(_fileName);
+    return QFile::rename(temporary, _fileName);
+}
+
+bool
+DeviceSnapshot::load(const QString& _fileName, QList<Data>& _devices) {
+    QFile file(_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    // the records are read from the mapping without copying the file
+    // first, each one is still decoded into a Data of its own
+    QByteArray contents;
+    uchar*     mapped = file.map(0, file.size());
+    if (mapped)
+        contents = QByteArray::fromRawData(
+            reinterpret_cast<const char*>(mapped), int(file.size()));
+    else
+        contents = file.readAll();
+
+    QDataStream header(contents);
+    header.setVersion(kStreamVersion);
+    quint32 magic = 0, version = 0, count = 0;
+    header >> magic >> version >> count;
+    if (header.status() != QDataStream::Ok || magic != kMagic ||
+        version != kFormatVersion)
+        return false;
+    // a record is at least its size, a count the file can not hold is
+    // refused before anything is allocated for it
+    qint64 left = contents.size() - header.device()->pos();
+    if (qint64(count) > left / qint64(sizeof(quint32)))
+        return false;
+
+    QList<Data> devices;
+    devices.reserve(int(count));
+    for (quint32 i = 0; i < count; i++) {
+        quint32 size = 0;
+        header >> size;
+        int offset = int(header.device()->pos());
+        if (header.status() != QDataStream::Ok ||
+            qint64(offset) + size > contents.size())
+            return false;
+
+        QByteArray record =
+            QByteArray::fromRawData(contents.constData() + offset, int(size));
+        QDataStream stream(record);
+        stream.setVersion(kStreamVersion);
+        Data   data;
+        Reader reader{stream};
+        io(reader, data);
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        devices.append(data);
+        header.skipRawData(int(size));
+    }
+
+    _devices = devices;
+    return true;
+}
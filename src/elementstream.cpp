@@ -0,0 +1,125 @@
+#include "elementstream.h"
+#include <QHash>
+#include <QXmlStreamWriter>
+
+using namespace ONVIF;
+
+ElementStream::ElementStream(const QString& _namespaceUri, const QString& _name)
+    : mNamespaceUri(_namespaceUri), mName(_name), mWriter(NULL), mDepth(0),
+      mFinished(false), mError(false) {}
+
+ElementStream::~ElementStream() {
+    delete mWriter;
+}
+
+void
+ElementStream::addData(const QByteArray& _data) {
+    if (mFinished || mError)
+        return;
+    mReader.addData(_data);
+    while (!mReader.atEnd()) {
+        QXmlStreamReader::TokenType token = mReader.readNext();
+        if (mReader.hasError())
+            break;
+
+        switch (token) {
+        case QXmlStreamReader::StartElement:
+            startElement();
+            break;
+        case QXmlStreamReader::EndElement:
+            endElement();
+            break;
+        case QXmlStreamReader::Characters:
+            if (mDepth == 0)
+                break;
+            if (mReader.isCDATA())
+                mWriter->writeCDATA(mReader.text().toString());
+            else
+                mWriter->writeCharacters(mReader.text().toString());
+            break;
+        case QXmlStreamReader::EndDocument:
+            mFinished = true;
+            break;
+        default:
+            break;
+        }
+    }
+    // a premature end only means the rest has not arrived yet
+    if (mReader.hasError() &&
+        mReader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+        mError = true;
+}
+
+QList<QByteArray>
+ElementStream::takeElements() {
+    QList<QByteArray> elements = mElements;
+    mElements.clear();
+    return elements;
+}
+
+bool
+ElementStream::isFinished() const {
+    return mFinished;
+}
+
+bool
+ElementStream::hasError() const {
+    return mError;
+}
+
+void
+ElementStream::startElement() {
+    if (mDepth == 0) {
+        if (mReader.name() != mName ||
+            (!mNamespaceUri.isEmpty() &&
+             mReader.namespaceUri() != mNamespaceUri)) {
+            mScopes.append(mReader.namespaceDeclarations());
+            return;
+        }
+        mElement.clear();
+        mWriter = new QXmlStreamWriter(&mElement);
+    }
+
+    // names are written as qualified in the source so the prefixes used by
+    // the queries stay valid
+    mWriter->writeStartElement(mReader.qualifiedName().toString());
+    QHash<QString, QString> declarations;
+    if (mDepth == 0) {
+        foreach (const QXmlStreamNamespaceDeclarations& scope, mScopes) {
+            foreach (const QXmlStreamNamespaceDeclaration& ns, scope)
+                declarations.insert(
+                    ns.prefix().toString(), ns.namespaceUri().toString());
+        }
+    }
+    foreach (const QXmlStreamNamespaceDeclaration& ns,
+             mReader.namespaceDeclarations())
+        declarations.insert(
+            ns.prefix().toString(), ns.namespaceUri().toString());
+    QHashIterator<QString, QString> i(declarations);
+    while (i.hasNext()) {
+        i.next();
+        mWriter->writeAttribute(
+            i.key().isEmpty() ? QString("xmlns") : "xmlns:" + i.key(),
+            i.value());
+    }
+    foreach (const QXmlStreamAttribute& attribute, mReader.attributes())
+        mWriter->writeAttribute(
+            attribute.qualifiedName().toString(), attribute.value().toString());
+    mDepth++;
+}
+
+void
+ElementStream::endElement() {
+    if (mDepth == 0) {
+        if (!mScopes.isEmpty())
+            mScopes.removeLast();
+        return;
+    }
+    mWriter->writeEndElement();
+    if (--mDepth == 0) {
+        delete mWriter;
+        mWriter = NULL;
+        mElements.append(mElement);
+        mElement.clear();
+    }
+}
@@ -0,0 +1,274 @@
+#include "eventmanagement.h"
+#include "notificationdecoder.h"
+
+using namespace ONVIF;
+
+namespace {
+const char kActionPrefix[] = "http://www.onvif.org/ver10/events/wsdl/";
+const char kWsnActionPrefix[] =
+    "http://docs.oasis-open.org/wsn/bw-2/SubscriptionManager/";
+
+// xs:duration of whole seconds
+QString
+duration(int secs) {
+    return QString("PT%1S").arg(qMax(1, secs));
+}
+} // namespace
+
+EventManagement::EventManagement(
+    const QString& wsdlUrl, const QString& username, const QString& password)
+    : Service(wsdlUrl, username, password) {}
+
+QHash<QString, QString>
+EventManagement::namespaces(const QString& key) {
+    QHash<QString, QString> names;
+    Q_UNUSED(key);
+    names.insert("SOAP-ENV", "http://www.w3.org/2003/05/soap-envelope");
+    names.insert("SOAP-ENC", "http://www.w3.org/2003/05/soap-encoding");
+    names.insert("xsi", "http://www.w3.org/2001/XMLSchema-instance");
+    names.insert("xsd", "http://www.w3.org/2001/XMLSchema");
+    names.insert("c14n", "http://www.w3.org/2001/10/xml-exc-c14n#");
+    names.insert(
+        "wsu",
+        "http://docs.oasis-open.org/wss/2004/01/"
+        "oasis-200401-wss-wssecurity-utility-1.0.xsd");
+    names.insert("xenc", "http://www.w3.org/2001/04/xmlenc#");
+    names.insert("ds", "http://www.w3.org/2000/09/xmldsig#");
+    names.insert(
+        "wsse",
+        "http://docs.oasis-open.org/wss/2004/01/"
+        "oasis-200401-wss-wssecurity-secext-1.0.xsd");
+    names.insert("wsa5", "http://www.w3.org/2005/08/addressing");
+    names.insert("xmime", "http://tempuri.org/xmime.xsd");
+    names.insert("xop", "http://www.w3.org/2004/08/xop/include");
+    names.insert("wsa", "http://schemas.xmlsoap.org/ws/2004/08/addressing");
+    names.insert("tt", "http://www.onvif.org/ver10/schema");
+    names.insert("wsbf", "http://docs.oasis-open.org/wsrf/bf-2");
+    names.insert("wstop", "http://docs.oasis-open.org/wsn/t-1");
+    names.insert("d", "http://schemas.xmlsoap.org/ws/2005/04/discovery");
+    names.insert("wsr", "http://docs.oasis-open.org/wsrf/r-2");
+    names.insert(
+        "dndl",
+        "http://www.onvif.org/ver10/network/wsdl/DiscoveryLookupBinding");
+    names.insert(
+        "dnrd",
+        "http://www.onvif.org/ver10/network/wsdl/RemoteDiscoveryBinding");
+    names.insert("dn", "http://www.onvif.org/ver10/network/wsdl");
+    names.insert("tad", "http://www.onvif.org/ver10/analyticsdevice/wsdl");
+    names.insert(
+        "tanae",
+        "http://www.onvif.org/ver20/analytics/wsdl/AnalyticsEngineBinding");
+    names.insert(
+        "tanre", "http://www.onvif.org/ver20/analytics/wsdl/RuleEngineBinding");
+    names.insert("tan", "http://www.onvif.org/ver20/analytics/wsdl");
+    names.insert("tds", "http://www.onvif.org/ver10/device/wsdl");
+    names.insert(
+        "tetcp",
+        "http://www.onvif.org/ver10/events/wsdl/CreatePullPointBinding");
+    names.insert("tete", "http://www.onvif.org/ver10/events/wsdl/EventBinding");
+    names.insert(
+        "tetnc",
+        "http://www.onvif.org/ver10/events/wsdl/NotificationConsumerBinding");
+    names.insert(
+        "tetnp",
+        "http://www.onvif.org/ver10/events/wsdl/NotificationProducerBinding");
+    names.insert(
+        "tetpp", "http://www.onvif.org/ver10/events/wsdl/PullPointBinding");
+    names.insert(
+        "tetpps",
+        "http://www.onvif.org/ver10/events/wsdl/PullPointSubscriptionBinding");
+    names.insert("tev", "http://www.onvif.org/ver10/events/wsdl");
+    names.insert(
+        "tetps",
+        "http://www.onvif.org/ver10/events/wsdl/"
+        "PausableSubscriptionManagerBinding");
+    names.insert("wsnt", "http://docs.oasis-open.org/wsn/b-2");
+    names.insert(
+        "tetsm",
+        "http://www.onvif.org/ver10/events/wsdl/SubscriptionManagerBinding");
+    names.insert("timg", "http://www.onvif.org/ver20/imaging/wsdl");
+    names.insert("timg10", "http://www.onvif.org/ver10/imaging/wsdl");
+    names.insert("tls", "http://www.onvif.org/ver10/display/wsdl");
+    names.insert("tmd", "http://www.onvif.org/ver10/deviceIO/wsdl");
+    names.insert("tptz", "http://www.onvif.org/ver20/ptz/wsdl");
+    names.insert("trc", "http://www.onvif.org/ver10/recording/wsdl");
+    names.insert("trp", "http://www.onvif.org/ver10/replay/wsdl");
+    names.insert("trt", "http://www.onvif.org/ver10/media/wsdl");
+    names.insert("trv", "http://www.onvif.org/ver10/receiver/wsdl");
+    names.insert("tse", "http://www.onvif.org/ver10/search/wsdl");
+    names.insert("tns1", "http://www.onvif.org/ver10/schema");
+    names.insert("tnsn", "http://www.eventextension.com/2011/event/topics");
+    names.insert("tnsavg", "http://www.avigilon.com/onvif/ver10/topics");
+
+    return names;
+}
+
+Message*
+EventManagement::newMessage() {
+    QHash<QString, QString> names;
+    names.insert("wsdl", "http://www.onvif.org/ver10/events/wsdl");
+    names.insert("sch", "http://www.onvif.org/ver10/schema");
+    names.insert("wsnt", "http://docs.oasis-open.org/wsn/b-2");
+    names.insert("wsa5", "http://www.w3.org/2005/08/addressing");
+    return createMessage(names);
+}
+
+Message*
+EventManagement::newSubscriptionMessage(
+    const QString& address, const QString& action) {
+    Message* msg = newMessage();
+    msg->appendToHeader(newElement("wsa5:Action", action));
+    msg->appendToHeader(newElement("wsa5:To", address));
+    return msg;
+}
+
+QDateTime
+EventManagement::terminationTime(MessageParser* result) {
+    QDateTime current = QDateTime::fromString(
+        result->getValue("//wsnt:CurrentTime").trimmed(), Qt::ISODate);
+    QDateTime termination = QDateTime::fromString(
+        result->getValue("//wsnt:TerminationTime").trimmed(), Qt::ISODate);
+    if (!termination.isValid())
+        return QDateTime();
+    if (!current.isValid())
+        return termination.toUTC();
+    return QDateTime::currentDateTimeUtc().addMSecs(
+        current.msecsTo(termination));
+}
+
+bool
+EventManagement::createPullPointSubscription(
+    int            terminationSecs,
+    QString&       address,
+    QDateTime&     termination,
+    const QString& filter) {
+    QNetworkReply* reply =
+        postCreatePullPointSubscription(terminationSecs, filter);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readCreatePullPointSubscription(reply, address, termination);
+}
+
+bool
+EventManagement::pullMessages(
+    const QString&      address,
+    int                 timeoutSecs,
+    int                 messageLimit,
+    QList<Data::Event>& events) {
+    QNetworkReply* reply = postPullMessages(address, timeoutSecs, messageLimit);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    if (reply == NULL)
+        return false;
+    bool ok = reply->error() == QNetworkReply::NoError;
+    NotificationDecoder decoder;
+    decoder.addData(Client::readReply(reply));
+    events = decoder.takeEvents();
+    return ok && !decoder.hasError();
+}
+
+bool
+EventManagement::renew(
+    const QString& address, int terminationSecs, QDateTime& termination) {
+    QNetworkReply* reply = postRenew(address, terminationSecs);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readRenew(reply, termination);
+}
+
+bool
+EventManagement::unsubscribe(const QString& address) {
+    QNetworkReply* reply = postUnsubscribe(address);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readUnsubscribe(reply).isOk();
+}
+
+QNetworkReply*
+EventManagement::postCreatePullPointSubscription(
+    int terminationSecs, const QString& filter) {
+    Message*    msg    = newMessage();
+    QDomElement create = newElement("wsdl:CreatePullPointSubscription");
+    if (!filter.isEmpty()) {
+        QDomElement expression = newElement("wsnt:TopicExpression", filter);
+        expression.setAttribute(
+            "Dialect",
+            "http://www.onvif.org/ver10/tev/topicExpression/ConcreteSet");
+        QDomElement element = newElement("wsdl:Filter");
+        element.appendChild(expression);
+        create.appendChild(element);
+    }
+    create.appendChild(newElement(
+        "wsdl:InitialTerminationTime", duration(terminationSecs)));
+    msg->appendToBody(create);
+    msg->appendToHeader(newElement(
+        "wsa5:Action",
+        QString(kActionPrefix) +
+            "EventPortType/CreatePullPointSubscriptionRequest"));
+    QNetworkReply* reply = postMessage(msg);
+    delete msg;
+    return reply;
+}
+
+bool
+EventManagement::readCreatePullPointSubscription(
+    QNetworkReply* reply, QString& address, QDateTime& termination) {
+    MessageParser* result = readMessage(reply);
+    if (result == NULL)
+        return false;
+    address =
+        result->getValue("//tev:SubscriptionReference/wsa5:Address").trimmed();
+    termination = terminationTime(result);
+    delete result;
+    return !address.isEmpty();
+}
+
+QNetworkReply*
+EventManagement::postPullMessages(
+    const QString& address, int timeoutSecs, int messageLimit) {
+    Message* msg = newSubscriptionMessage(
+        address,
+        QString(kActionPrefix) + "PullPointSubscription/PullMessagesRequest");
+    QDomElement pull = newElement("wsdl:PullMessages");
+    pull.appendChild(newElement("wsdl:Timeout", duration(timeoutSecs)));
+    pull.appendChild(newElement(
+        "wsdl:MessageLimit", QString::number(qMax(1, messageLimit))));
+    msg->appendToBody(pull);
+    QNetworkReply* reply = postMessage(msg, address);
+    delete msg;
+    return reply;
+}
+
+QNetworkReply*
+EventManagement::postRenew(const QString& address, int terminationSecs) {
+    Message* msg = newSubscriptionMessage(
+        address, QString(kWsnActionPrefix) + "RenewRequest");
+    QDomElement renew = newElement("wsnt:Renew");
+    renew.appendChild(
+        newElement("wsnt:TerminationTime", duration(terminationSecs)));
+    msg->appendToBody(renew);
+    QNetworkReply* reply = postMessage(msg, address);
+    delete msg;
+    return reply;
+}
+
+bool
+EventManagement::readRenew(QNetworkReply* reply, QDateTime& termination) {
+    MessageParser* result = readMessage(reply);
+    if (result == NULL)
+        return false;
+    termination = terminationTime(result);
+    delete result;
+    return termination.isValid();
+}
+
+QNetworkReply*
+EventManagement::postUnsubscribe(const QString& address) {
+    Message* msg = newSubscriptionMessage(
+        address, QString(kWsnActionPrefix) + "UnsubscribeRequest");
+    msg->appendToBody(newElement("wsnt:Unsubscribe"));
+    QNetworkReply* reply = postMessage(msg, address);
+    delete msg;
+    return reply;
+}
+
+ResponseStatus
+EventManagement::readUnsubscribe(QNetworkReply* reply) {
+    return readStatus(reply, "wsnt:UnsubscribeResponse");
+}
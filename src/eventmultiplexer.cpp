@@ -0,0 +1,464 @@
+#include "eventmultiplexer.h"
+#include "client.h"
+#include "devicemanagement.h"
+#include "eventmanagement.h"
+#include "retrypolicy.h"
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrl>
+
+using namespace ONVIF;
+
+namespace {
+// CreatePullPointSubscription, Renew and the transfer of a pull response
+const qint64 kRequestTimeoutMs = 10000;
+// a device answering a pull at once with nothing is not pulled in a loop
+const qint64 kMinEmptyPullMs = 1000;
+}
+
+EventMultiplexer::EventMultiplexer(QObject* _parent)
+    : QObject(_parent), mPullTimeoutSecs(10), mMessageLimit(64),
+      mTerminationSecs(60), mMaxCreating(32), mCreating(0), mNextId(0),
+      mManager(new QNetworkAccessManager(this)), mWheel(100) {
+    mClock.start();
+    mTicker.setInterval(mWheel.tickMs());
+    connect(&mTicker, &QTimer::timeout, this, &EventMultiplexer::tick);
+}
+
+EventMultiplexer::~EventMultiplexer() {
+    // no Unsubscribe: the replies would not outlive us, the devices let
+    // the subscriptions expire
+    foreach (const SubscriptionPtr& subscription, mSubscriptions)
+        drop(*subscription);
+}
+
+void
+EventMultiplexer::setPull(int _timeoutSecs, int _messageLimit) {
+    mPullTimeoutSecs = qMax(1, _timeoutSecs);
+    mMessageLimit    = qMax(1, _messageLimit);
+    mTerminationSecs = qMax(mTerminationSecs, 3 * mPullTimeoutSecs);
+}
+
+void
+EventMultiplexer::setTerminationTime(int _secs) {
+    mTerminationSecs = qMax(_secs, 3 * mPullTimeoutSecs);
+}
+
+void
+EventMultiplexer::setMaxCreating(int _requests) {
+    mMaxCreating = qMax(1, _requests);
+}
+
+void
+EventMultiplexer::subscribe(
+    const QString&  _key,
+    const QString&  _eventsAddress,
+    const QString&  _deviceAddress,
+    const QString&  _username,
+    const QString&  _password,
+    const TlsTrust& _trust) {
+    unsubscribe(_key);
+
+    SubscriptionPtr subscription(new Subscription);
+    subscription->key = _key;
+    subscription->service =
+        new EventManagement(_eventsAddress, _username, _password);
+    subscription->service->setParent(this);
+    subscription->service->shareNetworkAccessManager(mManager);
+    subscription->service->setAuthentication(&subscription->authentication);
+    subscription->service->setTlsTrust(_trust);
+    // a camera with a drifted clock refuses the WS-Security timestamps
+    subscription->clockService.reset(
+        new DeviceManagement(_deviceAddress, QString(), QString()));
+    subscription->clockService->shareNetworkAccessManager(mManager);
+    subscription->clockService->setTlsTrust(_trust);
+    // measured by the Measuring step, never by the service
+    subscription->service->setClockOffset(&subscription->clock);
+
+    if (++mNextId == 0)
+        ++mNextId;
+    mSubscriptions.insert(mNextId, subscription);
+    mIds.insert(_key, mNextId);
+
+    if (!mTicker.isActive()) {
+        mWheel.advance(mClock.elapsed());
+        mTicker.start();
+    }
+    start(mNextId);
+}
+
+void
+EventMultiplexer::unsubscribe(const QString& _key) {
+    SubscriptionPtr subscription = mSubscriptions.take(mIds.take(_key));
+    if (!subscription)
+        return;
+    drop(*subscription);
+
+    EventManagement* service = subscription->service;
+    if (subscription->address.isEmpty()) {
+        service->deleteLater();
+    } else {
+        QNetworkReply* reply = service->postUnsubscribe(subscription->address);
+        if (reply == NULL) {
+            service->deleteLater();
+        } else {
+            // the subscription (and its clock) lives until the reply is in
+            connect(
+                reply,
+                &QNetworkReply::finished,
+                service,
+                [service, subscription]() { service->deleteLater(); });
+            connect(
+                reply,
+                &QNetworkReply::finished,
+                reply,
+                &QNetworkReply::deleteLater);
+        }
+    }
+    if (mSubscriptions.isEmpty())
+        mTicker.stop();
+}
+
+void
+EventMultiplexer::clear() {
+    foreach (const QString& key, mIds.keys())
+        unsubscribe(key);
+    mWaiting.clear();
+    mWheel = TimerWheel(mWheel.tickMs());
+}
+
+int
+EventMultiplexer::count() const {
+    return mSubscriptions.size();
+}
+
+bool
+EventMultiplexer::contains(const QString& _key) const {
+    return mIds.contains(_key);
+}
+
+bool
+EventMultiplexer::isActive(const QString& _key) const {
+    SubscriptionPtr subscription = mSubscriptions.value(mIds.value(_key));
+    return subscription && subscription->active;
+}
+
+void
+EventMultiplexer::start(quint32 _id) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (!subscription)
+        return;
+    if (subscription->address.isEmpty())
+        create(_id);
+    // renewed before the pull that would outlast the subscription
+    else if (
+        subscription->terminationMs - mClock.elapsed() <
+        2 * 1000 * qint64(mPullTimeoutSecs))
+        post(_id, Renewing);
+    else
+        post(_id, Pulling);
+}
+
+void
+EventMultiplexer::create(quint32 _id) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (subscription->queued)
+        return;
+    if (mCreating >= mMaxCreating) {
+        subscription->state  = Waiting;
+        subscription->queued = true;
+        mWaiting.enqueue(_id);
+        return;
+    }
+    mCreating++;
+    post(_id, subscription->clock.needsMeasure() ? Measuring : Creating);
+}
+
+void
+EventMultiplexer::post(quint32 _id, State _state) {
+    SubscriptionPtr  subscription = mSubscriptions.value(_id);
+    EventManagement* service      = subscription->service;
+    QNetworkReply*   reply        = NULL;
+    qint64           timeoutMs    = kRequestTimeoutMs;
+    switch (_state) {
+    case Measuring:
+        subscription->clock.startMeasure();
+        subscription->measureSentMs = QDateTime::currentMSecsSinceEpoch();
+        reply = subscription->clockService->postClockOffset();
+        break;
+    case Creating:
+        reply = service->postCreatePullPointSubscription(mTerminationSecs);
+        break;
+    case Pulling:
+        subscription->decoder.reset(new NotificationDecoder);
+        subscription->pulledAt = mClock.elapsed();
+        subscription->events   = 0;
+        reply                  = service->postPullMessages(
+            subscription->address, mPullTimeoutSecs, mMessageLimit);
+        timeoutMs += 1000 * qint64(mPullTimeoutSecs);
+        break;
+    case Renewing:
+        reply = service->postRenew(subscription->address, mTerminationSecs);
+        break;
+    case Waiting:
+        return;
+    }
+    // unsubscribed or subscribed anew by a slot of a signal emitted
+    // meanwhile, e.g. activeChanged
+    if (!mSubscriptions.contains(_id)) {
+        if (_state == Measuring || _state == Creating)
+            mCreating--;
+        if (reply != NULL) {
+            reply->abort();
+            reply->deleteLater();
+        }
+        return;
+    }
+    subscription->state = _state;
+    subscription->reply = reply;
+    schedule(_id, timeoutMs);
+    if (reply == NULL) {
+        finished(_id);
+        return;
+    }
+
+    connect(reply, &QNetworkReply::finished, this, [this, _id]() {
+        finished(_id);
+    });
+    if (_state == Pulling)
+        connect(reply, &QNetworkReply::readyRead, this, [this, _id]() {
+            received(_id);
+        });
+}
+
+void
+EventMultiplexer::received(quint32 _id) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (!subscription || subscription->reply == NULL)
+        return;
+    subscription->decoder->addData(subscription->reply->readAll());
+    QList<Data::Event> events = subscription->decoder->takeEvents();
+    subscription->events += events.size();
+    if (!events.isEmpty())
+        emit eventsReceived(subscription->key, events);
+}
+
+void
+EventMultiplexer::finished(quint32 _id) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (!subscription)
+        return;
+    QNetworkReply* reply = subscription->reply;
+    subscription->reply  = NULL;
+    if (reply != NULL)
+        disconnect(reply, NULL, this, NULL);
+
+    // the digest nonce is new or stale, the request is sent once more
+    if (reply != NULL && !subscription->challenged &&
+        Client::isChallenge(reply)) {
+        subscription->challenged = true;
+        reply->deleteLater();
+        post(_id, subscription->state);
+        return;
+    }
+
+    switch (subscription->state) {
+    case Measuring:
+        measured(_id, reply);
+        break;
+    case Creating:
+        created(_id, reply);
+        break;
+    case Pulling:
+        pulled(_id, reply);
+        break;
+    case Renewing:
+        renewed(_id, reply);
+        break;
+    case Waiting:
+        break;
+    }
+}
+
+void
+EventMultiplexer::measured(quint32 _id, QNetworkReply* _reply) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    qint64          offset       = 0;
+    bool            ok = subscription->clockService->readClockOffset(
+        _reply, subscription->measureSentMs, offset);
+    // a device that did not tell its time is signed in ours
+    subscription->clock.finishMeasure(ok, offset);
+    post(_id, Creating);
+}
+
+void
+EventMultiplexer::created(quint32 _id, QNetworkReply* _reply) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    mCreating--;
+    QString   address;
+    QDateTime termination;
+    bool      ok = subscription->service->readCreatePullPointSubscription(
+        _reply, address, termination);
+
+    while (mCreating < mMaxCreating && !mWaiting.isEmpty()) {
+        quint32         id      = mWaiting.dequeue();
+        SubscriptionPtr waiting = mSubscriptions.value(id);
+        if (waiting && waiting->queued) {
+            waiting->queued = false;
+            create(id);
+        }
+    }
+
+    if (!ok) {
+        failed(_id, true);
+        return;
+    }
+    // the device tells its own address, which is not ours behind a nat
+    QUrl url(address);
+    QUrl service(subscription->service->serviceAddress());
+    url.setScheme(service.scheme());
+    url.setHost(service.host());
+    url.setPort(service.port());
+    subscription->address = url.toString();
+
+    qint64 lifetimeMs = 1000 * qint64(mTerminationSecs);
+    if (termination.isValid())
+        lifetimeMs = QDateTime::currentDateTimeUtc().msecsTo(termination);
+    subscription->terminationMs = mClock.elapsed() + lifetimeMs;
+    subscription->failures      = 0;
+    subscription->challenged    = false;
+    setActive(_id, true);
+    start(_id);
+}
+
+void
+EventMultiplexer::pulled(quint32 _id, QNetworkReply* _reply) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    bool            ok           = false;
+    int             httpStatus   = 0;
+    if (_reply != NULL) {
+        httpStatus =
+            _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute)
+                .toInt();
+        ok = _reply->error() == QNetworkReply::NoError;
+        subscription->decoder->addData(_reply->readAll());
+        _reply->deleteLater();
+    }
+    QList<Data::Event> events = subscription->decoder->takeEvents();
+    subscription->events += events.size();
+    if (!events.isEmpty()) {
+        emit eventsReceived(subscription->key, events);
+        if (!mSubscriptions.contains(_id))
+            return;
+    }
+
+    // a fault is a subscription the device no longer knows
+    if (!ok || subscription->decoder->hasError()) {
+        failed(_id, httpStatus >= 400);
+        return;
+    }
+    subscription->failures   = 0;
+    subscription->challenged = false;
+    setActive(_id, true);
+    if (!mSubscriptions.contains(_id))
+        return;
+
+    qint64 elapsed = mClock.elapsed() - subscription->pulledAt;
+    if (subscription->events == 0 && elapsed < kMinEmptyPullMs) {
+        subscription->state = Waiting;
+        schedule(_id, kMinEmptyPullMs - elapsed);
+        return;
+    }
+    start(_id);
+}
+
+void
+EventMultiplexer::renewed(quint32 _id, QNetworkReply* _reply) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    QDateTime       termination;
+    if (!subscription->service->readRenew(_reply, termination)) {
+        failed(_id, true);
+        return;
+    }
+    qint64 lifetimeMs = 1000 * qint64(mTerminationSecs);
+    if (termination.isValid())
+        lifetimeMs = QDateTime::currentDateTimeUtc().msecsTo(termination);
+    subscription->terminationMs = mClock.elapsed() + lifetimeMs;
+    subscription->failures      = 0;
+    subscription->challenged    = false;
+    setActive(_id, true);
+    if (mSubscriptions.contains(_id))
+        post(_id, Pulling);
+}
+
+void
+EventMultiplexer::failed(quint32 _id, bool _lost) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    subscription->failures++;
+    subscription->challenged = false;
+    if (_lost)
+        subscription->address.clear();
+    subscription->state = Waiting;
+
+    RetryPolicy backoff;
+    backoff.baseDelayMs = 1000;
+    backoff.maxDelayMs  = 60000;
+    schedule(
+        _id,
+        qMax(mWheel.tickMs(), backoff.delayMs(subscription->failures - 1)));
+    setActive(_id, false);
+}
+
+void
+EventMultiplexer::setActive(quint32 _id, bool _active) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (subscription->active == _active)
+        return;
+    subscription->active = _active;
+    emit activeChanged(subscription->key, _active);
+}
+
+void
+EventMultiplexer::drop(Subscription& _subscription) {
+    if (_subscription.reply != NULL) {
+        QNetworkReply* reply = _subscription.reply;
+        _subscription.reply  = NULL;
+        disconnect(reply, NULL, this, NULL);
+        reply->abort();
+        reply->deleteLater();
+        if (_subscription.state == Measuring ||
+            _subscription.state == Creating)
+            mCreating--;
+    }
+    _subscription.state = Waiting;
+}
+
+void
+EventMultiplexer::schedule(quint32 _id, qint64 _delayMs) {
+    SubscriptionPtr subscription = mSubscriptions.value(_id);
+    if (!subscription)
+        return;
+    subscription->generation++;
+    mWheel.schedule(cookie(_id, subscription->generation), _delayMs);
+}
+
+quint64
+EventMultiplexer::cookie(quint32 _id, quint32 _generation) const {
+    return (quint64(_id) << 32) | _generation;
+}
+
+void
+EventMultiplexer::tick() {
+    foreach (quint64 expired, mWheel.advance(mClock.elapsed())) {
+        quint32         id           = quint32(expired >> 32);
+        SubscriptionPtr subscription = mSubscriptions.value(id);
+        if (!subscription || subscription->generation != quint32(expired))
+            continue;
+        // overdue: the abort finishes the reply as a failure
+        if (subscription->reply != NULL)
+            subscription->reply->abort();
+        else if (subscription->state == Waiting)
+            start(id);
+    }
+}
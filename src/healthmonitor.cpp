@@ -0,0 +1,321 @@
+#include "healthmonitor.h"
+#include "retrypolicy.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTcpSocket>
+
+using namespace ONVIF;
+
+namespace {
+// GetSystemDateAndTime needs no WS-Security header (ONVIF Core 5.9.4)
+const char kProbe[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<s:Envelope xmlns:s=\"http://www.w3.org/2003/05/soap-envelope\">"
+    "<s:Body><GetSystemDateAndTime "
+    "xmlns=\"http://www.onvif.org/ver10/device/wsdl\"/></s:Body>"
+    "</s:Envelope>";
+
+const quint32 kGenerationMask = 0x7fffffff;
+
+// +-10%, so devices added together do not stay in step
+qint64
+jittered(qint64 _msecs) {
+    return _msecs * (90 + qrand() % 21) / 100;
+}
+}
+
+HealthMonitor::HealthMonitor(QObject* _parent)
+    : QObject(_parent), mKind(SoapProbe), mIntervalMs(30000),
+      mMaxIntervalMs(300000), mTimeoutMs(5000), mMaxInFlight(256),
+      mInFlight(0), mManager(new QNetworkAccessManager(this)), mWheel(100) {
+    mClock.start();
+    mTicker.setInterval(mWheel.tickMs());
+    connect(&mTicker, &QTimer::timeout, this, &HealthMonitor::tick);
+}
+
+HealthMonitor::~HealthMonitor() {
+    clear();
+}
+
+void
+HealthMonitor::setProbeKind(ProbeKind _kind) {
+    mKind = _kind;
+}
+
+void
+HealthMonitor::setInterval(int _msecs) {
+    mIntervalMs    = qMax(mWheel.tickMs(), _msecs);
+    mMaxIntervalMs = qMax(mMaxIntervalMs, mIntervalMs);
+}
+
+int
+HealthMonitor::interval() const {
+    return mIntervalMs;
+}
+
+void
+HealthMonitor::setMaxInterval(int _msecs) {
+    mMaxIntervalMs = qMax(mIntervalMs, _msecs);
+}
+
+int
+HealthMonitor::maxInterval() const {
+    return mMaxIntervalMs;
+}
+
+void
+HealthMonitor::setTimeout(int _msecs) {
+    mTimeoutMs = qMax(mWheel.tickMs(), _msecs);
+}
+
+void
+HealthMonitor::setMaxInFlight(int _probes) {
+    mMaxInFlight = qMax(1, _probes);
+}
+
+void
+HealthMonitor::setNetworkAccessManager(QNetworkAccessManager* _manager) {
+    if (_manager == NULL || _manager == mManager)
+        return;
+    // the replies go with the old manager, their probes start over
+    for (int i = 0; i < mTargets.size(); i++) {
+        if (mTargets.at(i).reply != NULL) {
+            abort(mTargets[i]);
+            schedule(i, ProbeDue, 0);
+        }
+    }
+    delete mManager;
+    _manager->setParent(this);
+    mManager = _manager;
+}
+
+void
+HealthMonitor::addDevice(
+    const QString& _endPoint, const QString& _serviceAddress) {
+    QUrl url(_serviceAddress);
+    if (!url.isValid() || url.host().isEmpty())
+        return;
+
+    int index = mIndexes.value(_endPoint, -1);
+    if (index >= 0) {
+        Target& target = mTargets[index];
+        if (target.url != url) {
+            abort(target);
+            target.url = url;
+            schedule(index, ProbeDue, 0);
+        }
+        return;
+    }
+
+    if (!mFree.isEmpty()) {
+        index = mFree.takeLast();
+    } else {
+        index = mTargets.size();
+        mTargets.append(Target());
+    }
+    // the generation goes on, timers of a former device at index are stale
+    Target& target   = mTargets[index];
+    target.endPoint  = _endPoint;
+    target.url       = url;
+    target.state     = Unknown;
+    target.backoffMs = 0;
+    target.used      = true;
+    mIndexes.insert(_endPoint, index);
+
+    if (!mTicker.isActive()) {
+        mWheel.advance(mClock.elapsed());
+        mTicker.start();
+    }
+    schedule(index, ProbeDue, qrand() % mIntervalMs);
+}
+
+void
+HealthMonitor::removeDevice(const QString& _endPoint) {
+    int index = mIndexes.value(_endPoint, -1);
+    if (index < 0)
+        return;
+    mIndexes.remove(_endPoint);
+    Target& target = mTargets[index];
+    abort(target);
+    target.generation = (target.generation + 1) & kGenerationMask;
+    target.used       = false;
+    target.endPoint.clear();
+    mFree.append(index);
+    if (mIndexes.isEmpty())
+        mTicker.stop();
+}
+
+void
+HealthMonitor::clear() {
+    for (int i = 0; i < mTargets.size(); i++)
+        abort(mTargets[i]);
+    mTargets.clear();
+    mFree.clear();
+    mIndexes.clear();
+    mWaiting.clear();
+    mWheel = TimerWheel(mWheel.tickMs());
+    mTicker.stop();
+}
+
+int
+HealthMonitor::count() const {
+    return mIndexes.size();
+}
+
+bool
+HealthMonitor::isOnline(const QString& _endPoint) const {
+    int index = mIndexes.value(_endPoint, -1);
+    if (index < 0)
+        return false;
+    State state = mTargets.at(index).state;
+    return state == Online || state == Suspect;
+}
+
+void
+HealthMonitor::schedule(int _index, Event _event, qint64 _delayMs) {
+    Target& target    = mTargets[_index];
+    target.generation = (target.generation + 1) & kGenerationMask;
+    mWheel.schedule(cookie(_index, _event, target.generation), _delayMs);
+}
+
+quint64
+HealthMonitor::cookie(int _index, Event _event, quint32 _generation) const {
+    return (quint64(_index) << 32) | (quint64(_generation) << 1) | _event;
+}
+
+void
+HealthMonitor::tick() {
+    foreach (quint64 expired, mWheel.advance(mClock.elapsed())) {
+        int     index      = int(expired >> 32);
+        quint32 generation = quint32(expired >> 1) & kGenerationMask;
+        if (index >= mTargets.size())
+            continue;
+        const Target& target = mTargets.at(index);
+        if (!target.used || target.generation != generation)
+            continue;
+        if ((expired & 1) == ProbeTimeout)
+            finished(index, generation, false);
+        else if (mInFlight < mMaxInFlight)
+            probe(index);
+        else
+            mWaiting.enqueue(expired);
+    }
+}
+
+void
+HealthMonitor::probe(int _index) {
+    mInFlight++;
+    schedule(_index, ProbeTimeout, mTimeoutMs);
+    Target& target     = mTargets[_index];
+    quint32 generation = target.generation;
+
+    if (mKind == TcpProbe) {
+        QTcpSocket* socket = new QTcpSocket(this);
+        target.socket      = socket;
+        connect(
+            socket,
+            &QAbstractSocket::stateChanged,
+            this,
+            [this, _index, generation](QAbstractSocket::SocketState _state) {
+                if (_state == QAbstractSocket::ConnectedState)
+                    finished(_index, generation, true);
+                else if (_state == QAbstractSocket::UnconnectedState)
+                    finished(_index, generation, false);
+            });
+        int defaultPort = target.url.scheme() == "https" ? 443 : 80;
+        socket->connectToHost(
+            target.url.host(), target.url.port(defaultPort));
+        return;
+    }
+
+    QNetworkRequest request(target.url);
+    request.setHeader(
+        QNetworkRequest::ContentTypeHeader,
+        "application/soap+xml; charset=utf-8");
+    // no idle connection is kept open per device between the probes
+    request.setRawHeader("Connection", "close");
+    QNetworkReply* reply = mManager->post(request, QByteArray(kProbe));
+    target.reply         = reply;
+    connect(
+        reply,
+        &QNetworkReply::finished,
+        this,
+        [this, _index, generation, reply]() {
+            // any http answer, even a fault or a 401, is a live device
+            int httpStatus =
+                reply->attribute(QNetworkRequest::HttpStatusCodeAttribute)
+                    .toInt();
+            finished(
+                _index,
+                generation,
+                httpStatus != 0 && !RetryPolicy::isTransient(reply));
+        });
+}
+
+void
+HealthMonitor::finished(int _index, quint32 _generation, bool _alive) {
+    Target& target = mTargets[_index];
+    if (!target.used || target.generation != _generation)
+        return;
+    abort(target);
+
+    State before = target.state;
+    if (_alive) {
+        target.state     = Online;
+        target.backoffMs = 0;
+    } else if (before == Online) {
+        target.state = Suspect;
+    } else {
+        target.state     = Offline;
+        target.backoffMs = target.backoffMs == 0
+                               ? mIntervalMs
+                               : qMin(target.backoffMs * 2, mMaxIntervalMs);
+    }
+    schedule(_index, ProbeDue, nextDelay(target));
+
+    while (mInFlight < mMaxInFlight && !mWaiting.isEmpty()) {
+        quint64 waiting = mWaiting.dequeue();
+        int     index   = int(waiting >> 32);
+        if (index < mTargets.size() && mTargets.at(index).used &&
+            mTargets.at(index).generation ==
+                (quint32(waiting >> 1) & kGenerationMask))
+            probe(index);
+    }
+
+    bool wasOnline = before == Online || before == Suspect;
+    bool online    = target.state == Online || target.state == Suspect;
+    if (before == Unknown || wasOnline != online)
+        emit onlineChanged(target.endPoint, online);
+}
+
+void
+HealthMonitor::abort(Target& _target) {
+    if (_target.reply != NULL) {
+        QNetworkReply* reply = _target.reply;
+        _target.reply        = NULL;
+        disconnect(reply, NULL, this, NULL);
+        reply->abort();
+        reply->deleteLater();
+        mInFlight--;
+    }
+    if (_target.socket != NULL) {
+        QTcpSocket* socket = _target.socket;
+        _target.socket     = NULL;
+        disconnect(socket, NULL, this, NULL);
+        socket->abort();
+        socket->deleteLater();
+        mInFlight--;
+    }
+}
+
+qint64
+HealthMonitor::nextDelay(const Target& _target) const {
+    switch (_target.state) {
+    case Suspect:
+        return qMax<qint64>(mWheel.tickMs(), mIntervalMs / 8);
+    case Offline:
+        return jittered(_target.backoffMs);
+    default:
+        return jittered(mIntervalMs);
+    }
+}
@@ -0,0 +1,150 @@
+#include "httpdigest.h"
+#include <QCryptographicHash>
+#include <QNetworkReply>
+
+using namespace ONVIF;
+
+namespace {
+// key=value and key="quoted value" pairs, separated by commas
+QHash<QByteArray, QByteArray>
+parameters(const QByteArray& _text) {
+    QHash<QByteArray, QByteArray> result;
+    int                           i = 0;
+    while (i < _text.size()) {
+        while (i < _text.size() && (_text[i] == ' ' || _text[i] == ','))
+            i++;
+        int equals = _text.indexOf('=', i);
+        if (equals < 0)
+            break;
+        QByteArray key = _text.mid(i, equals - i).trimmed().toLower();
+        QByteArray value;
+        i = equals + 1;
+        if (i < _text.size() && _text[i] == '"') {
+            for (i++; i < _text.size() && _text[i] != '"'; i++) {
+                if (_text[i] == '\\' && i + 1 < _text.size())
+                    i++;
+                value += _text[i];
+            }
+            i++;
+        } else {
+            int comma = _text.indexOf(',', i);
+            if (comma < 0)
+                comma = _text.size();
+            value = _text.mid(i, comma - i).trimmed();
+            i     = comma;
+        }
+        result.insert(key, value);
+    }
+    return result;
+}
+
+QByteArray
+hash(const QByteArray& _algorithm, const QByteArray& _data) {
+    QCryptographicHash::Algorithm algorithm =
+        _algorithm.toUpper().startsWith("SHA-256") ? QCryptographicHash::Sha256
+                                                   : QCryptographicHash::Md5;
+    return QCryptographicHash::hash(_data, algorithm).toHex();
+}
+}
+
+bool
+HttpDigest::takeChallenge(Data::Authentication& _auth, QNetworkReply* _reply) {
+    if (_reply == NULL ||
+        _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() !=
+            401)
+        return false;
+    // a device may offer Basic and Digest, each in a header of its own
+    foreach (const QNetworkReply::RawHeaderPair& header,
+             _reply->rawHeaderPairs()) {
+        if (header.first.toLower() == "www-authenticate" &&
+            setChallenge(_auth, header.second))
+            return true;
+    }
+    return false;
+}
+
+bool
+HttpDigest::setChallenge(
+    Data::Authentication& _auth, const QByteArray& _header) {
+    // the headers of a Basic and a Digest challenge may come joined in one
+    // value, by a newline or a comma
+    QByteArray header = _header.trimmed();
+    QByteArray lower  = header.toLower();
+    int        start  = lower.indexOf("digest ");
+    while (start > 0) {
+        QByteArray before = lower.left(start).trimmed();
+        if (before.endsWith(',') || lower[start - 1] == '\n')
+            break;
+        start = lower.indexOf("digest ", start + 1);
+    }
+    if (start < 0)
+        return false;
+    header = header.mid(start + 7);
+    int newline = header.indexOf('\n');
+    if (newline >= 0)
+        header.truncate(newline);
+    QHash<QByteArray, QByteArray> challenge = parameters(header);
+    if (challenge.value("nonce").isEmpty())
+        return false;
+
+    // "auth" when offered, auth-int would need the body in the hash
+    QByteArray qop;
+    foreach (const QByteArray& offered, challenge.value("qop").split(',')) {
+        if (offered.trimmed() == "auth")
+            qop = "auth";
+    }
+    _auth.scheme     = "Digest";
+    _auth.realm      = QString::fromUtf8(challenge.value("realm"));
+    _auth.nonce      = QString::fromUtf8(challenge.value("nonce"));
+    _auth.opaque     = QString::fromUtf8(challenge.value("opaque"));
+    _auth.algorithm  = QString::fromUtf8(challenge.value("algorithm"));
+    _auth.qop        = QString::fromUtf8(qop);
+    _auth.nonceCount = 0;
+    return true;
+}
+
+QByteArray
+HttpDigest::authorization(
+    Data::Authentication& _auth,
+    const QByteArray&     _method,
+    const QByteArray&     _uri,
+    const QString&        _user,
+    const QString&        _password,
+    const QByteArray&     _cnonce) {
+    if (_auth.nonce.isEmpty())
+        return QByteArray();
+    QByteArray algorithm = _auth.algorithm.toUtf8();
+    QByteArray realm     = _auth.realm.toUtf8();
+    QByteArray nonce     = _auth.nonce.toUtf8();
+    QByteArray qop       = _auth.qop.toUtf8();
+    QByteArray user      = _user.toUtf8();
+    QByteArray nc =
+        QByteArray::number(++_auth.nonceCount, 16).rightJustified(8, '0');
+    QByteArray cnonce = _cnonce;
+    if (cnonce.isEmpty())
+        cnonce = QByteArray::number(qrand(), 16) +
+                 QByteArray::number(qrand(), 16);
+
+    QByteArray ha1 =
+        hash(algorithm, user + ':' + realm + ':' + _password.toUtf8());
+    if (algorithm.toLower().endsWith("-sess"))
+        ha1 = hash(algorithm, ha1 + ':' + nonce + ':' + cnonce);
+    QByteArray ha2 = hash(algorithm, _method + ':' + _uri);
+    QByteArray response =
+        qop.isEmpty()
+            ? hash(algorithm, ha1 + ':' + nonce + ':' + ha2)
+            : hash(algorithm,
+                   ha1 + ':' + nonce + ':' + nc + ':' + cnonce + ':' + qop +
+                       ':' + ha2);
+
+    QByteArray header = "Digest username=\"" + user + "\", realm=\"" + realm +
+                        "\", nonce=\"" + nonce + "\", uri=\"" + _uri +
+                        "\", response=\"" + response + "\"";
+    if (!algorithm.isEmpty())
+        header += ", algorithm=" + algorithm;
+    if (!_auth.opaque.isEmpty())
+        header += ", opaque=\"" + _auth.opaque.toUtf8() + "\"";
+    if (!qop.isEmpty())
+        header += ", qop=" + qop + ", nc=" + nc + ", cnonce=\"" + cnonce + "\"";
+    return header;
+}
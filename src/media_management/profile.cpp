@@ -1,7 +1,7 @@
 #include "profile.h"
 using namespace ONVIF;
 
-Profile::Profile(QObject *parent):QObject(parent)
+Profile::Profile(QObject *parent):Profiles(parent)
 {
 
 }
@@ -1,4 +1,5 @@
 #include "streamuri.h"
+#include <QRegularExpression>
 
 using namespace ONVIF;
 
@@ -12,3 +13,28 @@ StreamUri::~StreamUri()
 
 }
 
+qint64 StreamUri::timeoutMsecs() const
+{
+    return durationToMsecs(m_timeout);
+}
+
+qint64 StreamUri::durationToMsecs(const QString &duration)
+{
+    static const QRegularExpression re(
+        "^P(?:(\\d+)Y)?(?:(\\d+)M)?(?:(\\d+)D)?"
+        "(?:T(?:(\\d+)H)?(?:(\\d+)M)?(?:(\\d+(?:\\.\\d+)?)S)?)?$");
+    QString trimmed = duration.trimmed();
+    if (trimmed.length() < 3)
+        return -1;
+    QRegularExpressionMatch match = re.match(trimmed);
+    if (!match.hasMatch())
+        return -1;
+
+    qint64 days = match.captured(1).toLongLong() * 365 +
+                  match.captured(2).toLongLong() * 30 +
+                  match.captured(3).toLongLong();
+    qint64 msecs = ((days * 24 + match.captured(4).toLongLong()) * 60 +
+                    match.captured(5).toLongLong()) * 60000;
+    msecs += qRound64(match.captured(6).toDouble() * 1000);
+    return msecs;
+}
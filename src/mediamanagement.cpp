@@ -297,1363 +297,50 @@ MediaManagement::getVideoEncoderConfigurations() {
 
 Profiles*
 MediaManagement::getProfiles() {
-    Profiles* profiles = NULL;
+    Profiles* profiles = new Profiles();
     Message*  msg      = newMessage();
     msg->appendToBody(newElement("wsdl:GetProfiles"));
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        profiles         = new Profiles();
-        QXmlQuery* query = result->query();
-        query->setQuery(
-            result->nameSpace() + "doc($inputDocument)//trt:Profiles");
-        QXmlResultItems items;
-        query->evaluateTo(&items);
-        QXmlItem     item = items.next();
-        QDomDocument doc;
-        QString      value, bounds, panTilt, zoom, profileNode;
-        QRect        rect;
-        while (!item.isNull()) {
-            query->setFocus(item);
-
-            query->setQuery(result->nameSpace() + ".");
-            query->evaluateTo(&profileNode);
-            doc.setContent(profileNode);
-            QDomNodeList itemNodeList = doc.elementsByTagName("trt:Profiles");
-            QDomNode     node;
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                value = itemNodeList.at(i).toElement().attribute("token");
-                profiles->m_toKenPro.push_back(value.trimmed());
-
-                value = itemNodeList.at(i).toElement().attribute("fixed");
-                profiles->m_fixed.push_back(
-                    value.trimmed() == "true" ? true : false);
-            }
-
-            query->setQuery(result->nameSpace() + "./tt:Name/string()");
-            query->evaluateTo(&value);
-            profiles->m_namePro.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profiles->m_nameVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profiles->m_useCountVsc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:SourceToken/string()");
-            query->evaluateTo(&value);
-            profiles->m_sourceTokenVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Bounds");
-            query->evaluateTo(&bounds);
-            doc.setContent(bounds);
-            itemNodeList = doc.elementsByTagName("tt:Bounds");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node  = itemNodeList.at(i);
-                value = node.toElement().attribute("width");
-                rect.setWidth(value.toInt());
-                value = node.toElement().attribute("height");
-                rect.setHeight(value.toInt());
-                value = node.toElement().attribute("x");
-                rect.setLeft(value.toInt());
-                value = node.toElement().attribute("y");
-                rect.setTop(value.toInt());
-            }
-            profiles->m_boundsVsc.push_back(rect);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profiles->m_nameVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profiles->m_useCountVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Encoding/string()");
-            query->evaluateTo(&value);
-            profiles->m_encodingVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Width/string()");
-            query->evaluateTo(&value);
-            profiles->m_widthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Height/string()");
-            query->evaluateTo(&value);
-            profiles->m_heightVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Quality/string()");
-            query->evaluateTo(&value);
-            profiles->m_qualityVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:FrameRateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_frameRateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:EncodingInterval/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_encodingIntervalVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:BitrateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_bitrateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:H264/tt:GovLength/string()");
-            query->evaluateTo(&value);
-            profiles->m_govLengthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/tt:H264/"
-                                      "tt:H264Profile/string()");
-            query->evaluateTo(&value);
-            profiles->m_h264ProfileVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:Type/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_typeVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv4Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_ipv4AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv6Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_ipv6AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profiles->m_portVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profiles->m_ttlVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/string()");
-            query->evaluateTo(&value);
-            profiles->m_autoStartVec.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profiles->m_sessionTimeoutVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profiles->m_namePtz.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profiles->m_useCountPtz.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:NodeToken/string()");
-            query->evaluateTo(&value);
-            profiles->m_nodeToken.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsolutePantTiltPosit"
-                                      "ionSpace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultAbsolutePantTiltPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsoluteZoomPositionS"
-                                      "pace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultAbsoluteZoomPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativePanTiltTransl"
-                                      "ationSpace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultRelativePantTiltTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativeZoomTranslati"
-                                      "onSpace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultRelativeZoomTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousPanTiltVelo"
-                                      "citySpace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultContinuousPantTiltVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousZoomVelocit"
-                                      "ySpace/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultContinuousZoomVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:PanTilt");
-            query->evaluateTo(&panTilt);
-            doc.setContent(panTilt);
-            itemNodeList = doc.elementsByTagName("tt:PanTilt");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profiles->m_panTiltSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profiles->m_panTiltX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-                profiles->m_panTiltY.push_back(
-                    node.toElement().attribute("y").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:Zoom");
-            query->evaluateTo(&zoom);
-            doc.setContent(zoom);
-            itemNodeList = doc.elementsByTagName("tt:Zoom");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profiles->m_zoomSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profiles->m_zoomX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZTimeout/string()");
-            query->evaluateTo(&value);
-            profiles->m_defaultPTZTimeout.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:URI/string()");
-            query->evaluateTo(&value);
-            profiles->m_panTiltUri.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profiles->m_xRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profiles->m_xRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profiles->m_yRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profiles->m_yRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:ZoomLimits/tt:Range/tt:URI/string()");
-            query->evaluateTo(&value);
-            profiles->m_zoomUri.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profiles->m_xRangeMinZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profiles->m_xRangeMaxZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profiles->m_nameMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profiles->m_useCountMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Status/string()");
-            query->evaluateTo(&value);
-            profiles->m_status.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Position/string()");
-            query->evaluateTo(&value);
-            profiles->m_position.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Events/tt:Filter/string()");
-            query->evaluateTo(&value);
-            profiles->m_filter.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/tt:Events/"
-                                      "tt:SubscriptionPolicy/string()");
-            query->evaluateTo(&value);
-            profiles->m_subscriptionPolicy.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Analytics/string()");
-            query->evaluateTo(&value);
-            profiles->m_analytics.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:Type/string()");
-            query->evaluateTo(&value);
-            profiles->m_typeMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv4Address/string()");
-            query->evaluateTo(&value);
-            profiles->m_ipv4AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv6Address/string()");
-            query->evaluateTo(&value);
-            profiles->m_ipv6AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profiles->m_portMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profiles->m_ttlMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profiles->m_autoStartMc.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profiles->m_sessionTimeoutMc.push_back(value.trimmed());
-
-
-            item = items.next();
-        }
-    }
-    delete msg;
-    delete result;
-    return profiles;
-}
-
-Profile*
-MediaManagement::getProfile720P() {
-    Profile* profile = NULL;
-    Message* msg     = newMessage();
-    msg->appendToBody(
-        newElement("<wsdl:ProfileToken>profile_720P</wsdl:ProfileToken>"));
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        profile          = new Profile();
-        QXmlQuery* query = result->query();
-        query->setQuery(
-            result->nameSpace() + "doc($inputDocument)//trt:Profile");
-        QXmlResultItems items;
-        query->evaluateTo(&items);
-        QXmlItem     item = items.next();
-        QDomDocument doc;
-        QString      value, bounds, panTilt, zoom, profileNode;
-        QRect        rect;
-        while (!item.isNull()) {
-            query->setFocus(item);
-            query->setQuery(result->nameSpace() + ".");
-            query->evaluateTo(&profileNode);
-            doc.setContent(profileNode);
-            QDomNodeList itemNodeList = doc.elementsByTagName("trt:Profiles");
-            QDomNode     node;
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                value = itemNodeList.at(i).toElement().attribute("token");
-                profile->m_toKenPro.push_back(value.trimmed());
-                qDebug() << "===========" << value;
-                value = itemNodeList.at(i).toElement().attribute("fixed");
-                profile->m_fixed.push_back(
-                    value.trimmed() == "true" ? true : false);
-            }
-
-            query->setQuery(result->nameSpace() + "./tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_namePro.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountVsc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:SourceToken/string()");
-            query->evaluateTo(&value);
-            profile->m_sourceTokenVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Bounds");
-            query->evaluateTo(&bounds);
-            doc.setContent(bounds);
-            itemNodeList = doc.elementsByTagName("tt:Bounds");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node  = itemNodeList.at(i);
-                value = node.toElement().attribute("width");
-                rect.setWidth(value.toInt());
-                value = node.toElement().attribute("height");
-                rect.setHeight(value.toInt());
-                value = node.toElement().attribute("x");
-                rect.setLeft(value.toInt());
-                value = node.toElement().attribute("y");
-                rect.setTop(value.toInt());
-            }
-            profile->m_boundsVsc.push_back(rect);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Encoding/string()");
-            query->evaluateTo(&value);
-            profile->m_encodingVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Width/string()");
-            query->evaluateTo(&value);
-            profile->m_widthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Height/string()");
-            query->evaluateTo(&value);
-            profile->m_heightVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Quality/string()");
-            query->evaluateTo(&value);
-            profile->m_qualityVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:FrameRateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_frameRateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:EncodingInterval/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_encodingIntervalVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:BitrateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_bitrateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:H264/tt:GovLength/string()");
-            query->evaluateTo(&value);
-            profile->m_govLengthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/tt:H264/"
-                                      "tt:H264Profile/string()");
-            query->evaluateTo(&value);
-            profile->m_h264ProfileVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:Type/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_typeVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv4Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_ipv4AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv6Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_ipv6AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profile->m_portVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profile->m_ttlVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/string()");
-            query->evaluateTo(&value);
-            profile->m_autoStartVec.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_sessionTimeoutVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_namePtz.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountPtz.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:NodeToken/string()");
-            query->evaluateTo(&value);
-            profile->m_nodeToken.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsolutePantTiltPosit"
-                                      "ionSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultAbsolutePantTiltPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsoluteZoomPositionS"
-                                      "pace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultAbsoluteZoomPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativePanTiltTransl"
-                                      "ationSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultRelativePantTiltTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativeZoomTranslati"
-                                      "onSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultRelativeZoomTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousPanTiltVelo"
-                                      "citySpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultContinuousPantTiltVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousZoomVelocit"
-                                      "ySpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultContinuousZoomVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:PanTilt");
-            query->evaluateTo(&panTilt);
-            doc.setContent(panTilt);
-            itemNodeList = doc.elementsByTagName("tt:PanTilt");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profile->m_panTiltSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profile->m_panTiltX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-                profile->m_panTiltY.push_back(
-                    node.toElement().attribute("y").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:Zoom");
-            query->evaluateTo(&zoom);
-            doc.setContent(zoom);
-            itemNodeList = doc.elementsByTagName("tt:Zoom");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profile->m_zoomSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profile->m_zoomX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultPTZTimeout.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:URI/string()");
-            query->evaluateTo(&value);
-            profile->m_panTiltUri.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_yRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_yRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:ZoomLimits/tt:Range/tt:URI/string()");
-            query->evaluateTo(&value);
-            profile->m_zoomUri.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMinZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMaxZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Status/string()");
-            query->evaluateTo(&value);
-            profile->m_status.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Position/string()");
-            query->evaluateTo(&value);
-            profile->m_position.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Events/tt:Filter/string()");
-            query->evaluateTo(&value);
-            profile->m_filter.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/tt:Events/"
-                                      "tt:SubscriptionPolicy/string()");
-            query->evaluateTo(&value);
-            profile->m_subscriptionPolicy.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Analytics/string()");
-            query->evaluateTo(&value);
-            profile->m_analytics.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:Type/string()");
-            query->evaluateTo(&value);
-            profile->m_typeMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv4Address/string()");
-            query->evaluateTo(&value);
-            profile->m_ipv4AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv6Address/string()");
-            query->evaluateTo(&value);
-            profile->m_ipv6AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profile->m_portMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profile->m_ttlMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_autoStartMc.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_sessionTimeoutMc.push_back(value.trimmed());
-
-
-            item = items.next();
-        }
-    }
-    delete msg;
-    delete result;
-    return profile;
-}
-
-Profile*
-MediaManagement::getProfileD1() {
-    Profile* profile = NULL;
-    Message* msg     = newMessage();
-    msg->appendToBody(
-        newElement("<wsdl:ProfileToken>profile_D1</wsdl:ProfileToken>"));
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        profile          = new Profile();
-        QXmlQuery* query = result->query();
-        query->setQuery(
-            result->nameSpace() + "doc($inputDocument)//trt:Profiles");
-        QXmlResultItems items;
-        query->evaluateTo(&items);
-        QXmlItem     item = items.next();
-        QDomDocument doc;
-        QString      value, bounds, panTilt, zoom, profileNode;
-        QRect        rect;
-        while (!item.isNull()) {
-            query->setFocus(item);
-
-            query->setQuery(result->nameSpace() + ".");
-            query->evaluateTo(&profileNode);
-            doc.setContent(profileNode);
-            QDomNodeList itemNodeList = doc.elementsByTagName("trt:Profiles");
-            QDomNode     node;
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                value = itemNodeList.at(i).toElement().attribute("token");
-                profile->m_toKenPro.push_back(value.trimmed());
-
-                value = itemNodeList.at(i).toElement().attribute("fixed");
-                profile->m_fixed.push_back(
-                    value.trimmed() == "true" ? true : false);
-            }
-
-            query->setQuery(result->nameSpace() + "./tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_namePro.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountVsc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:SourceToken/string()");
-            query->evaluateTo(&value);
-            profile->m_sourceTokenVsc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoSourceConfiguration/tt:Bounds");
-            query->evaluateTo(&bounds);
-            doc.setContent(bounds);
-            itemNodeList = doc.elementsByTagName("tt:Bounds");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node  = itemNodeList.at(i);
-                value = node.toElement().attribute("width");
-                rect.setWidth(value.toInt());
-                value = node.toElement().attribute("height");
-                rect.setHeight(value.toInt());
-                value = node.toElement().attribute("x");
-                rect.setLeft(value.toInt());
-                value = node.toElement().attribute("y");
-                rect.setTop(value.toInt());
-            }
-            profile->m_boundsVsc.push_back(rect);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Encoding/string()");
-            query->evaluateTo(&value);
-            profile->m_encodingVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Width/string()");
-            query->evaluateTo(&value);
-            profile->m_widthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Resolution/tt:Height/string()");
-            query->evaluateTo(&value);
-            profile->m_heightVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Quality/string()");
-            query->evaluateTo(&value);
-            profile->m_qualityVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:FrameRateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_frameRateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:EncodingInterval/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_encodingIntervalVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:RateControl/tt:BitrateLimit/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_bitrateLimitVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:H264/tt:GovLength/string()");
-            query->evaluateTo(&value);
-            profile->m_govLengthVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/tt:H264/"
-                                      "tt:H264Profile/string()");
-            query->evaluateTo(&value);
-            profile->m_h264ProfileVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:Type/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_typeVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv4Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_ipv4AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:Address/tt:IPv6Address/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_ipv6AddressVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profile->m_portVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profile->m_ttlVec.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:VideoEncoderConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/string()");
-            query->evaluateTo(&value);
-            profile->m_autoStartVec.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:VideoEncoderConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_sessionTimeoutVec.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_namePtz.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountPtz.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:NodeToken/string()");
-            query->evaluateTo(&value);
-            profile->m_nodeToken.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsolutePantTiltPosit"
-                                      "ionSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultAbsolutePantTiltPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultAbsoluteZoomPositionS"
-                                      "pace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultAbsoluteZoomPositionSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativePanTiltTransl"
-                                      "ationSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultRelativePantTiltTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultRelativeZoomTranslati"
-                                      "onSpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultRelativeZoomTranslationSpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousPanTiltVelo"
-                                      "citySpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultContinuousPantTiltVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:"
-                                      "DefaultContinuousZoomVelocit"
-                                      "ySpace/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultContinuousZoomVelocitySpace.push_back(
-                value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:PanTilt");
-            query->evaluateTo(&panTilt);
-            doc.setContent(panTilt);
-            itemNodeList = doc.elementsByTagName("tt:PanTilt");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profile->m_panTiltSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profile->m_panTiltX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-                profile->m_panTiltY.push_back(
-                    node.toElement().attribute("y").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:Zoom");
-            query->evaluateTo(&zoom);
-            doc.setContent(zoom);
-            itemNodeList = doc.elementsByTagName("tt:Zoom");
-            for (int i = 0; i < itemNodeList.size(); i++) {
-                node = itemNodeList.at(i);
-                profile->m_zoomSpace.push_back(
-                    node.toElement().attribute("space").trimmed());
-                profile->m_zoomX.push_back(
-                    node.toElement().attribute("x").trimmed().toInt());
-            }
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:DefaultPTZTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_defaultPTZTimeout.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:URI/string()");
-            query->evaluateTo(&value);
-            profile->m_panTiltUri.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_yRangeMinPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:PanTiltLimits/tt:Range/"
-                                      "tt:YRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_yRangeMaxPt.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:PTZConfiguration/tt:ZoomLimits/tt:Range/tt:URI/string()");
-            query->evaluateTo(&value);
-            profile->m_zoomUri.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Min/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMinZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:PTZConfiguration/"
-                                      "tt:ZoomLimits/tt:Range/"
-                                      "tt:XRange/tt:Max/string()");
-            query->evaluateTo(&value);
-            profile->m_xRangeMaxZm.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Name/string()");
-            query->evaluateTo(&value);
-            profile->m_nameMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:UseCount/string()");
-            query->evaluateTo(&value);
-            profile->m_useCountMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Status/string()");
-            query->evaluateTo(&value);
-            profile->m_status.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:PTZStatus/tt:Position/string()");
-            query->evaluateTo(&value);
-            profile->m_position.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Events/tt:Filter/string()");
-            query->evaluateTo(&value);
-            profile->m_filter.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/tt:Events/"
-                                      "tt:SubscriptionPolicy/string()");
-            query->evaluateTo(&value);
-            profile->m_subscriptionPolicy.push_back(value.trimmed());
-
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Analytics/string()");
-            query->evaluateTo(&value);
-            profile->m_analytics.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:Type/string()");
-            query->evaluateTo(&value);
-            profile->m_typeMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv4Address/string()");
-            query->evaluateTo(&value);
-            profile->m_ipv4AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:Address/"
-                                      "tt:IPv6Address/string()");
-            query->evaluateTo(&value);
-            profile->m_ipv6AddressMc.push_back(value.trimmed());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:Port/string()");
-            query->evaluateTo(&value);
-            profile->m_portMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:Multicast/tt:TTL/string()");
-            query->evaluateTo(&value);
-            profile->m_ttlMc.push_back(value.trimmed().toInt());
-
-            query->setQuery(
-                result->nameSpace() + "./tt:MetadataConfiguration/"
-                                      "tt:Multicast/tt:AutoStart/"
-                                      "string()");
-            query->evaluateTo(&value);
-            profile->m_autoStartMc.push_back(
-                value.trimmed() == "true" ? true : false);
-
-            query->setQuery(
-                result->nameSpace() +
-                "./tt:MetadataConfiguration/tt:SessionTimeout/string()");
-            query->evaluateTo(&value);
-            profile->m_sessionTimeoutMc.push_back(value.trimmed());
-
+    // multi sensor cameras send hundreds of KB, each profile is parsed as
+    // soon as it has been received
+    auto parse = [this, profiles](MessageParser* result) {
+        QXmlQuery* query = result->query();
+        query->setQuery(
+            result->nameSpace() + "doc($inputDocument)/trt:Profiles");
+        QXmlResultItems items;
+        query->evaluateTo(&items);
+        QXmlItem item = items.next();
+        if (!item.isNull()) {
+            query->setFocus(item);
+            parseProfile(result, profiles);
+        }
+    };
+    if (!streamMessage(msg, "trt:Profiles", parse)) {
+        delete profiles;
+        profiles = NULL;
+    }
+    delete msg;
+    return profiles;
+}
 
-            item = items.next();
+Profile*
+MediaManagement::getProfile(const QString& token) {
+    Profile*    profile    = NULL;
+    Message*    msg        = newMessage();
+    QDomElement getProfile = newElement("wsdl:GetProfile");
+    getProfile.appendChild(newElement("wsdl:ProfileToken", token));
+    msg->appendToBody(getProfile);
+    MessageParser* result = sendMessage(msg);
+    if (result != NULL) {
+        QXmlQuery* query = result->query();
+        query->setQuery(
+            result->nameSpace() + "doc($inputDocument)//trt:Profile");
+        QXmlResultItems items;
+        query->evaluateTo(&items);
+        QXmlItem item = items.next();
+        if (!item.isNull()) {
+            profile = new Profile();
+            query->setFocus(item);
+            parseProfile(result, profile);
         }
     }
     delete msg;
@@ -1661,6 +348,438 @@ MediaManagement::getProfileD1() {
     return profile;
 }
 
+// appends the profile the query is focused on (trt:Profiles of GetProfiles
+// or trt:Profile of GetProfile, both are tt:Profile)
+void
+MediaManagement::parseProfile(MessageParser* result, Profiles* profiles) {
+    QXmlQuery*   query = result->query();
+    QDomDocument doc;
+    QDomNodeList itemNodeList;
+    QDomNode     node;
+    QString      value, bounds, panTilt, zoom;
+    QRect        rect;
+
+    query->setQuery(result->nameSpace() + "./@token/string()");
+    query->evaluateTo(&value);
+    profiles->m_toKenPro.push_back(value.trimmed());
+
+    query->setQuery(result->nameSpace() + "./@fixed/string()");
+    query->evaluateTo(&value);
+    profiles->m_fixed.push_back(value.trimmed() == "true" ? true : false);
+
+    query->setQuery(result->nameSpace() + "./tt:Name/string()");
+    query->evaluateTo(&value);
+    profiles->m_namePro.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoSourceConfiguration/tt:Name/string()");
+    query->evaluateTo(&value);
+    profiles->m_nameVsc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoSourceConfiguration/tt:UseCount/string()");
+    query->evaluateTo(&value);
+    profiles->m_useCountVsc.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoSourceConfiguration/tt:SourceToken/string()");
+    query->evaluateTo(&value);
+    profiles->m_sourceTokenVsc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoSourceConfiguration/tt:Bounds");
+    query->evaluateTo(&bounds);
+    doc.setContent(bounds);
+    itemNodeList = doc.elementsByTagName("tt:Bounds");
+    for (int i = 0; i < itemNodeList.size(); i++) {
+        node  = itemNodeList.at(i);
+        value = node.toElement().attribute("width");
+        rect.setWidth(value.toInt());
+        value = node.toElement().attribute("height");
+        rect.setHeight(value.toInt());
+        value = node.toElement().attribute("x");
+        rect.setLeft(value.toInt());
+        value = node.toElement().attribute("y");
+        rect.setTop(value.toInt());
+    }
+    profiles->m_boundsVsc.push_back(rect);
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:Name/string()");
+    query->evaluateTo(&value);
+    profiles->m_nameVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:UseCount/string()");
+    query->evaluateTo(&value);
+    profiles->m_useCountVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:Encoding/string()");
+    query->evaluateTo(&value);
+    profiles->m_encodingVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Resolution/tt:Width/string()");
+    query->evaluateTo(&value);
+    profiles->m_widthVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Resolution/tt:Height/string()");
+    query->evaluateTo(&value);
+    profiles->m_heightVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:Quality/string()");
+    query->evaluateTo(&value);
+    profiles->m_qualityVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:RateControl/tt:FrameRateLimit/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_frameRateLimitVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:RateControl/tt:EncodingInterval/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_encodingIntervalVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:RateControl/tt:BitrateLimit/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_bitrateLimitVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:H264/tt:GovLength/string()");
+    query->evaluateTo(&value);
+    profiles->m_govLengthVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/tt:H264/"
+                              "tt:H264Profile/string()");
+    query->evaluateTo(&value);
+    profiles->m_h264ProfileVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Multicast/tt:Address/tt:Type/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_typeVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Multicast/tt:Address/tt:IPv4Address/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_ipv4AddressVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Multicast/tt:Address/tt:IPv6Address/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_ipv6AddressVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:Multicast/tt:Port/string()");
+    query->evaluateTo(&value);
+    profiles->m_portVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:Multicast/tt:TTL/string()");
+    query->evaluateTo(&value);
+    profiles->m_ttlVec.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:VideoEncoderConfiguration/"
+                              "tt:Multicast/tt:AutoStart/string()");
+    query->evaluateTo(&value);
+    profiles->m_autoStartVec.push_back(
+        value.trimmed() == "true" ? true : false);
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:VideoEncoderConfiguration/tt:SessionTimeout/string()");
+    query->evaluateTo(&value);
+    profiles->m_sessionTimeoutVec.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/tt:Name/string()");
+    query->evaluateTo(&value);
+    profiles->m_namePtz.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:UseCount/string()");
+    query->evaluateTo(&value);
+    profiles->m_useCountPtz.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:NodeToken/string()");
+    query->evaluateTo(&value);
+    profiles->m_nodeToken.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultAbsolutePantTiltPosit"
+                              "ionSpace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultAbsolutePantTiltPositionSpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultAbsoluteZoomPositionS"
+                              "pace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultAbsoluteZoomPositionSpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultRelativePanTiltTransl"
+                              "ationSpace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultRelativePantTiltTranslationSpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultRelativeZoomTranslati"
+                              "onSpace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultRelativeZoomTranslationSpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultContinuousPanTiltVelo"
+                              "citySpace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultContinuousPantTiltVelocitySpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:"
+                              "DefaultContinuousZoomVelocit"
+                              "ySpace/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultContinuousZoomVelocitySpace.push_back(
+        value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:PanTilt");
+    query->evaluateTo(&panTilt);
+    doc.setContent(panTilt);
+    itemNodeList = doc.elementsByTagName("tt:PanTilt");
+    for (int i = 0; i < itemNodeList.size(); i++) {
+        node = itemNodeList.at(i);
+        profiles->m_panTiltSpace.push_back(
+            node.toElement().attribute("space").trimmed());
+        profiles->m_panTiltX.push_back(
+            node.toElement().attribute("x").trimmed().toInt());
+        profiles->m_panTiltY.push_back(
+            node.toElement().attribute("y").trimmed().toInt());
+    }
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:DefaultPTZSpeed/tt:Zoom");
+    query->evaluateTo(&zoom);
+    doc.setContent(zoom);
+    itemNodeList = doc.elementsByTagName("tt:Zoom");
+    for (int i = 0; i < itemNodeList.size(); i++) {
+        node = itemNodeList.at(i);
+        profiles->m_zoomSpace.push_back(
+            node.toElement().attribute("space").trimmed());
+        profiles->m_zoomX.push_back(
+            node.toElement().attribute("x").trimmed().toInt());
+    }
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:DefaultPTZTimeout/string()");
+    query->evaluateTo(&value);
+    profiles->m_defaultPTZTimeout.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:PanTiltLimits/tt:Range/"
+                              "tt:URI/string()");
+    query->evaluateTo(&value);
+    profiles->m_panTiltUri.push_back(value.trimmed());
+
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:PanTiltLimits/tt:Range/"
+                              "tt:XRange/tt:Min/string()");
+    query->evaluateTo(&value);
+    profiles->m_xRangeMinPt.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:PanTiltLimits/tt:Range/"
+                              "tt:XRange/tt:Max/string()");
+    query->evaluateTo(&value);
+    profiles->m_xRangeMaxPt.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:PanTiltLimits/tt:Range/"
+                              "tt:YRange/tt:Min/string()");
+    query->evaluateTo(&value);
+    profiles->m_yRangeMinPt.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:PanTiltLimits/tt:Range/"
+                              "tt:YRange/tt:Max/string()");
+    query->evaluateTo(&value);
+    profiles->m_yRangeMaxPt.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:PTZConfiguration/tt:ZoomLimits/tt:Range/tt:URI/string()");
+    query->evaluateTo(&value);
+    profiles->m_zoomUri.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:ZoomLimits/tt:Range/"
+                              "tt:XRange/tt:Min/string()");
+    query->evaluateTo(&value);
+    profiles->m_xRangeMinZm.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:PTZConfiguration/"
+                              "tt:ZoomLimits/tt:Range/"
+                              "tt:XRange/tt:Max/string()");
+    query->evaluateTo(&value);
+    profiles->m_xRangeMaxZm.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:Name/string()");
+    query->evaluateTo(&value);
+    profiles->m_nameMc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:UseCount/string()");
+    query->evaluateTo(&value);
+    profiles->m_useCountMc.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:PTZStatus/tt:Status/string()");
+    query->evaluateTo(&value);
+    profiles->m_status.push_back(
+        value.trimmed() == "true" ? true : false);
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:PTZStatus/tt:Position/string()");
+    query->evaluateTo(&value);
+    profiles->m_position.push_back(
+        value.trimmed() == "true" ? true : false);
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:Events/tt:Filter/string()");
+    query->evaluateTo(&value);
+    profiles->m_filter.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:MetadataConfiguration/tt:Events/"
+                              "tt:SubscriptionPolicy/string()");
+    query->evaluateTo(&value);
+    profiles->m_subscriptionPolicy.push_back(value.trimmed());
+
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:Analytics/string()");
+    query->evaluateTo(&value);
+    profiles->m_analytics.push_back(
+        value.trimmed() == "true" ? true : false);
+
+    query->setQuery(
+        result->nameSpace() + "./tt:MetadataConfiguration/"
+                              "tt:Multicast/tt:Address/"
+                              "tt:Type/string()");
+    query->evaluateTo(&value);
+    profiles->m_typeMc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:MetadataConfiguration/"
+                              "tt:Multicast/tt:Address/"
+                              "tt:IPv4Address/string()");
+    query->evaluateTo(&value);
+    profiles->m_ipv4AddressMc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:MetadataConfiguration/"
+                              "tt:Multicast/tt:Address/"
+                              "tt:IPv6Address/string()");
+    query->evaluateTo(&value);
+    profiles->m_ipv6AddressMc.push_back(value.trimmed());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:Multicast/tt:Port/string()");
+    query->evaluateTo(&value);
+    profiles->m_portMc.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:Multicast/tt:TTL/string()");
+    query->evaluateTo(&value);
+    profiles->m_ttlMc.push_back(value.trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() + "./tt:MetadataConfiguration/"
+                              "tt:Multicast/tt:AutoStart/"
+                              "string()");
+    query->evaluateTo(&value);
+    profiles->m_autoStartMc.push_back(
+        value.trimmed() == "true" ? true : false);
+
+    query->setQuery(
+        result->nameSpace() +
+        "./tt:MetadataConfiguration/tt:SessionTimeout/string()");
+    query->evaluateTo(&value);
+    profiles->m_sessionTimeoutMc.push_back(value.trimmed());
+}
+
 AudioSourceConfigurations*
 MediaManagement::getAudioSourceConfigurations() {
     AudioSourceConfigurations* audioSourceConfigurations = NULL;
@@ -2067,8 +1186,49 @@ MediaManagement::getAudioEncoderConfigurationOptions() {
 VideoEncoderConfigurationOptions*
 MediaManagement::getVideoEncoderConfigurationOptions(
     QString _configToken, QString _profileToken) {
+    Message* msg =
+        newVideoEncoderConfigurationOptionsMessage(_configToken, _profileToken);
+    // parsed from trt:Options as soon as it has been received, the
+    // envelope is not kept
     VideoEncoderConfigurationOptions* videoEncoderConfigurationOptions = NULL;
-    Message*                          msg = newMessage();
+    auto parse = [this, &videoEncoderConfigurationOptions](
+                     MessageParser* result) {
+        if (videoEncoderConfigurationOptions == NULL)
+            videoEncoderConfigurationOptions =
+                parseVideoEncoderConfigurationOptions(result);
+    };
+    if (!streamMessage(msg, "trt:Options", parse)) {
+        delete videoEncoderConfigurationOptions;
+        videoEncoderConfigurationOptions = NULL;
+    }
+    delete msg;
+    return videoEncoderConfigurationOptions;
+}
+
+QList<VideoEncoderConfigurationOptions*>
+MediaManagement::getVideoEncoderConfigurationOptions(
+    const QStringList& _configTokens) {
+    // not streamed: streamMessage() waits for one reply at a time, these
+    // requests are in flight together
+    QList<Message*> msgs;
+    foreach (QString configToken, _configTokens)
+        msgs.append(
+            newVideoEncoderConfigurationOptionsMessage(configToken, ""));
+
+    QList<VideoEncoderConfigurationOptions*> options;
+    QList<MessageParser*>                    results = sendMessages(msgs);
+    for (int i = 0; i < results.length(); i++) {
+        options.append(parseVideoEncoderConfigurationOptions(results.at(i)));
+        delete results.at(i);
+    }
+    qDeleteAll(msgs);
+    return options;
+}
+
+Message*
+MediaManagement::newVideoEncoderConfigurationOptionsMessage(
+    QString _configToken, QString _profileToken) {
+    Message* msg = newMessage();
     //    QDomElement configurationToken =
     //    newElement("wsdl:ConfigurationToken","profile_VideoSource_1");
     //    QDomElement profileTokekn =
@@ -2082,179 +1242,245 @@ MediaManagement::getVideoEncoderConfigurationOptions(
     body.appendChild(configurationToken);
     body.appendChild(profileTokekn);
     msg->appendToBody(body);
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        videoEncoderConfigurationOptions =
-            new VideoEncoderConfigurationOptions();
-        QXmlQuery*      query = result->query();
-        QXmlResultItems items;
-        QXmlItem        item;
-        QString         value;
-        videoEncoderConfigurationOptions->setQualityRangeMin(
-            result->getValue("//tt:QualityRange/tt:Min").trimmed().toInt());
-        videoEncoderConfigurationOptions->setQulityRangeMax(
-            result->getValue("//tt:QualityRange/tt:Max").trimmed().toInt());
+    return msg;
+}
 
-        query->setQuery(
-            result->nameSpace() +
-            "doc($inputDocument)//tt:H264/tt:ResolutionsAvailable");
-        query->evaluateTo(&items);
+VideoEncoderConfigurationOptions*
+MediaManagement::parseVideoEncoderConfigurationOptions(MessageParser* result) {
+    if (result == NULL)
+        return NULL;
+    VideoEncoderConfigurationOptions* videoEncoderConfigurationOptions =
+        new VideoEncoderConfigurationOptions();
+    QXmlQuery*      query = result->query();
+    QXmlResultItems items;
+    QXmlItem        item;
+    QString         value;
+    videoEncoderConfigurationOptions->setQualityRangeMin(
+        result->getValue("//tt:QualityRange/tt:Min").trimmed().toInt());
+    videoEncoderConfigurationOptions->setQulityRangeMax(
+        result->getValue("//tt:QualityRange/tt:Max").trimmed().toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "doc($inputDocument)//tt:H264/tt:ResolutionsAvailable");
+    query->evaluateTo(&items);
+    item = items.next();
+    while (!item.isNull()) {
+        query->setFocus(item);
+        query->setQuery(result->nameSpace() + "./tt:Width/string()");
+        query->evaluateTo(&value);
+        videoEncoderConfigurationOptions->setResAvailableWidthH264(
+            value.trimmed().toInt());
+        query->setQuery(result->nameSpace() + "./tt:Height/string()");
+        query->evaluateTo(&value);
+        videoEncoderConfigurationOptions->setResAvailableHeightH264(
+            value.trimmed().toInt());
         item = items.next();
-        while (!item.isNull()) {
-            query->setFocus(item);
-            query->setQuery(result->nameSpace() + "./tt:Width/string()");
-            query->evaluateTo(&value);
-            videoEncoderConfigurationOptions->setResAvailableWidthH264(
-                value.trimmed().toInt());
-            query->setQuery(result->nameSpace() + "./tt:Height/string()");
-            query->evaluateTo(&value);
-            videoEncoderConfigurationOptions->setResAvailableHeightH264(
-                value.trimmed().toInt());
-            item = items.next();
-        }
+    }
 
-        query->setQuery(
-            result->nameSpace() +
-            "doc($inputDocument)//tt:JPEG/tt:ResolutionsAvailable");
-        query->evaluateTo(&items);
+    query->setQuery(
+        result->nameSpace() +
+        "doc($inputDocument)//tt:JPEG/tt:ResolutionsAvailable");
+    query->evaluateTo(&items);
+    item = items.next();
+    while (!item.isNull()) {
+        query->setFocus(item);
+        query->setQuery(result->nameSpace() + "./tt:Width/string()");
+        query->evaluateTo(&value);
+        videoEncoderConfigurationOptions->setResAvailableWidthJpeg(
+            value.trimmed().toInt());
+        query->setQuery(result->nameSpace() + "./tt:Height/string()");
+        query->evaluateTo(&value);
+        videoEncoderConfigurationOptions->setResAvailableHeightJpeg(
+            value.trimmed().toInt());
         item = items.next();
-        while (!item.isNull()) {
-            query->setFocus(item);
-            query->setQuery(result->nameSpace() + "./tt:Width/string()");
-            query->evaluateTo(&value);
-            videoEncoderConfigurationOptions->setResAvailableWidthJpeg(
-                value.trimmed().toInt());
-            query->setQuery(result->nameSpace() + "./tt:Height/string()");
-            query->evaluateTo(&value);
-            videoEncoderConfigurationOptions->setResAvailableHeightJpeg(
-                value.trimmed().toInt());
-            item = items.next();
-        }
+    }
 
-        videoEncoderConfigurationOptions->setGovLengthRangeMin(
-            result->getValue("//trt:Options/tt:H264/tt:GovLengthRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setGovLengthRangeMax(
-            result->getValue("//trt:Options/tt:H264/tt:GovLengthRange/tt:Max")
-                .trimmed()
-                .toInt());
+    videoEncoderConfigurationOptions->setGovLengthRangeMin(
+        result->getValue("//trt:Options/tt:H264/tt:GovLengthRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setGovLengthRangeMax(
+        result->getValue("//trt:Options/tt:H264/tt:GovLengthRange/tt:Max")
+            .trimmed()
+            .toInt());
+
+    videoEncoderConfigurationOptions->setFrameRateRangeMinJpeg(
+        result->getValue("//trt:Options/tt:JPEG/tt:FrameRateRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setFrameRateRangeMaxJpeg(
+        result->getValue("//trt:Options/tt:JPEG/tt:FrameRateRange/tt:Max")
+            .trimmed()
+            .toInt());
+
+    videoEncoderConfigurationOptions->setFrameRateRangeMinH264(
+        result->getValue("//trt:Options/tt:H264/tt:FrameRateRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setFrameRateRangeMaxH264(
+        result->getValue("//trt:Options/tt:H264/tt:FrameRateRange/tt:Max")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setBitRateRangeMin(
+        result->getValue("//tt:H264/tt:BitrateRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setBitRateRangeMax(
+        result->getValue("//tt:H264/tt:BitrateRange/tt:Max")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setEncodingIntervalRangeMinJpeg(
+        result->getValue("//trt:Options/tt:JPEG/tt:EncodingIntervalRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setEncodingIntervalRangeMaxJpeg(
+        result->getValue("//trt:Options/tt:JPEG/tt:EncodingIntervalRange/tt:Max")
+            .trimmed()
+            .toInt());
+
+    videoEncoderConfigurationOptions->setEncodingIntervalRangeMinH264(
+        result->getValue("//trt:Options/tt:H264/tt:EncodingIntervalRange/tt:Min")
+            .trimmed()
+            .toInt());
+    videoEncoderConfigurationOptions->setEncodingIntervalRangeMaxH264(
+        result->getValue("//trt:Options/tt:H264/tt:EncodingIntervalRange/tt:Max")
+            .trimmed()
+            .toInt());
+
+    query->setQuery(
+        result->nameSpace() +
+        "doc($inputDocument)//tt:H264/tt:H264ProfilesSupported");
+    query->evaluateTo(&items);
+    item = items.next();
+    while (!item.isNull()) {
+        query->setFocus(item);
+        query->setQuery(result->nameSpace() + "./string()");
+        query->evaluateTo(&value);
+        videoEncoderConfigurationOptions->setH264ProfilesSupported(
+            videoEncoderConfigurationOptions->stringToEnum(
+                value.trimmed()));
+        item = items.next();
+    }
+    return videoEncoderConfigurationOptions;
+}
 
-        videoEncoderConfigurationOptions->setFrameRateRangeMinJpeg(
-            result->getValue("//trt:Options/tt:JPEG/tt:FrameRateRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setFrameRateRangeMaxJpeg(
-            result->getValue("//trt:Options/tt:JPEG/tt:FrameRateRange/tt:Max")
-                .trimmed()
-                .toInt());
+ResponseStatus
+MediaManagement::setVideoEncoderConfiguration(
+    VideoEncoderConfiguration* videoConfigurations) {
+    QNetworkReply* reply = postVideoEncoderConfiguration(videoConfigurations);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readVideoEncoderConfiguration(reply, videoConfigurations);
+}
 
-        videoEncoderConfigurationOptions->setFrameRateRangeMinH264(
-            result->getValue("//trt:Options/tt:H264/tt:FrameRateRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setFrameRateRangeMaxH264(
-            result->getValue("//trt:Options/tt:H264/tt:FrameRateRange/tt:Max")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setBitRateRangeMin(
-            result->getValue("//tt:H264/tt:BitrateRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setBitRateRangeMax(
-            result->getValue("//tt:H264/tt:BitrateRange/tt:Max")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setEncodingIntervalRangeMinJpeg(
-            result->getValue("//trt:Options/tt:JPEG/tt:EncodingIntervalRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setEncodingIntervalRangeMaxJpeg(
-            result->getValue("//trt:Options/tt:JPEG/tt:EncodingIntervalRange/tt:Max")
-                .trimmed()
-                .toInt());
+QNetworkReply*
+MediaManagement::postVideoEncoderConfiguration(
+    VideoEncoderConfiguration* videoConfigurations) {
+    Message* msg = newMessage();
+    msg->appendToBody(videoConfigurations->toxml());
+    QNetworkReply* reply = postMessage(msg);
+    delete msg;
+    return reply;
+}
 
-        videoEncoderConfigurationOptions->setEncodingIntervalRangeMinH264(
-            result->getValue("//trt:Options/tt:H264/tt:EncodingIntervalRange/tt:Min")
-                .trimmed()
-                .toInt());
-        videoEncoderConfigurationOptions->setEncodingIntervalRangeMaxH264(
-            result->getValue("//trt:Options/tt:H264/tt:EncodingIntervalRange/tt:Max")
-                .trimmed()
-                .toInt());
+ResponseStatus
+MediaManagement::readVideoEncoderConfiguration(
+    QNetworkReply* reply, VideoEncoderConfiguration* videoConfigurations) {
+    ResponseStatus status =
+        readStatus(reply, "trt:SetVideoEncoderConfigurationResponse");
+    videoConfigurations->setResult(status.isOk());
+    return status;
+}
 
-        query->setQuery(result->nameSpace() + "../tt:H264ProfilesSupported");
-        query->evaluateTo(&items);
-        item = items.next();
-        while (!item.isNull()) {
-            query->setFocus(item);
-            query->setQuery(result->nameSpace() + "./string()");
-            query->evaluateTo(&value);
-            videoEncoderConfigurationOptions->setH264ProfilesSupported(
-                videoEncoderConfigurationOptions->stringToEnum(
-                    value.trimmed()));
-            item = items.next();
-        }
-    }
+StreamUri*
+MediaManagement::getStreamUri(const QString& token) {
+    return getStreamUri(token, StreamUri::RtspUnicast);
+}
 
+StreamUri*
+MediaManagement::getStreamUri(
+    const QString& token, StreamUri::Transport transport) {
+    Message*       msg       = newStreamUriMessage(token, transport);
+    MessageParser* result    = sendMessage(msg);
+    StreamUri*     streamUri = parseStreamUri(result);
     delete msg;
     delete result;
-    return videoEncoderConfigurationOptions;
+    return streamUri;
 }
 
-void
-MediaManagement::setVideoEncoderConfiguration(VideoEncoderConfiguration *videoConfigurations) {
-    Message* msg = newMessage();
-    msg->appendToBody(videoConfigurations->toxml());
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        if (result->find("//tds:SetVideoEncoderConfigurationResponse"))
-            videoConfigurations->setResult(true);
-        else
-            videoConfigurations->setResult(false);
-        delete result;
-        delete msg;
+QList<StreamUri*>
+MediaManagement::getStreamUris(
+    const QStringList&                 tokens,
+    const QList<StreamUri::Transport>& transports,
+    QList<bool>*                       refused) {
+    QList<Message*> msgs;
+    for (int i = 0; i < tokens.length(); i++)
+        msgs.append(newStreamUriMessage(tokens.at(i), transports.value(i)));
+
+    QList<StreamUri*>     streamUris;
+    QList<MessageParser*> results = sendMessages(msgs);
+    for (int i = 0; i < results.length(); i++) {
+        streamUris.append(parseStreamUri(results.at(i)));
+        if (refused != NULL)
+            refused->append(
+                results.at(i) != NULL && streamUris.last() == NULL);
+        delete results.at(i);
     }
+    qDeleteAll(msgs);
+    return streamUris;
 }
 
-StreamUri*
-MediaManagement::getStreamUri(const QString& token) {
-    StreamUri*  streamUri    = NULL;
+Message*
+MediaManagement::newStreamUriMessage(
+    const QString& token, StreamUri::Transport transport) {
+    QString streamType = "RTP-Unicast";
+    QString protocolType = "RTSP";
+    if (transport == StreamUri::RtpMulticast) {
+        streamType   = "RTP-Multicast";
+        protocolType = "UDP";
+    } else if (transport == StreamUri::Http) {
+        protocolType = "HTTP";
+    }
+
     Message*    msg          = newMessage();
-    QDomElement stream       = newElement("sch:Stream", "RTP-Unicast");
-    QDomElement transport    = newElement("sch:Transport");
-    QDomElement protocol     = newElement("sch:Protocol", "RTSP");
-    QDomElement tunnel       = newElement("sch:Tunnel");
+    QDomElement stream       = newElement("sch:Stream", streamType);
+    QDomElement transportEl  = newElement("sch:Transport");
+    QDomElement protocol     = newElement("sch:Protocol", protocolType);
     QDomElement streamSetup  = newElement("wsdl:StreamSetup");
     QDomElement getStreamUri = newElement("wsdl:GetStreamUri");
     QDomElement profileToken = newElement("wsdl:ProfileToken", token);
     getStreamUri.setAttribute("xmlns","http://www.onvif.org/ver10/media/wsdl");
-    transport.setAttribute("xmlns","http://www.onvif.org/ver10/media/wsdl");
+    transportEl.setAttribute("xmlns","http://www.onvif.org/ver10/media/wsdl");
     stream.setAttribute("xmlns","http://www.onvif.org/ver10/media/wsdl");
 
-
     getStreamUri.appendChild(streamSetup);
     getStreamUri.appendChild(profileToken);
     streamSetup.appendChild(stream);
-    streamSetup.appendChild(transport);
-    transport.appendChild(protocol);
-    // transport.appendChild(tunnel);
+    streamSetup.appendChild(transportEl);
+    transportEl.appendChild(protocol);
     msg->appendToBody(getStreamUri);
-    MessageParser* result = sendMessage(msg);
-    if (result != NULL) {
-        streamUri = new StreamUri();
-        streamUri->setUri(result->getValue("//tt:Uri").trimmed());
-        streamUri->setInvalidAfterConnect(
-            result->getValue("//tt:InvalidAfterConnect").trimmed() == "true"
-                ? true
-                : false);
-        streamUri->setInvalidAfterReboot(
-            result->getValue("//tt:InvalidAfterReboot").trimmed() == "true"
-                ? true
-                : false);
-        streamUri->setTimeout(result->getValue("//tt:Timeout").trimmed());
-    }
-    delete msg;
-    delete result;
+    return msg;
+}
+
+StreamUri*
+MediaManagement::parseStreamUri(MessageParser* result) {
+    if (result == NULL)
+        return NULL;
+    QString uri = result->getValue("//tt:Uri").trimmed();
+    // a fault (unsupported transport, bad token, ...) carries no uri
+    if (uri.isEmpty())
+        return NULL;
+
+    StreamUri* streamUri = new StreamUri();
+    streamUri->setUri(uri);
+    streamUri->setInvalidAfterConnect(
+        result->getValue("//tt:InvalidAfterConnect").trimmed() == "true"
+            ? true
+            : false);
+    streamUri->setInvalidAfterReboot(
+        result->getValue("//tt:InvalidAfterReboot").trimmed() == "true"
+            ? true
+            : false);
+    streamUri->setTimeout(result->getValue("//tt:Timeout").trimmed());
     return streamUri;
 }
@@ -1,8 +1,10 @@
 #include "message.h"
+#include "requesttrace.h"
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QStringList>
+#include <QTextStream>
 #include <QTime>
 #include <QUuid>
 #include <time.h>
@@ -145,18 +147,30 @@ Message*
 Message::getMessageWithUserInfo(
     QHash<QString, QString>& namespaces,
     const QString& name,
-    const QString& passwd) {
+    const QString& passwd,
+    qint64 clockOffsetMsecs) {
       namespaces.insert("wsse", "http://docs.oasis-open.org/wss/2004/01/"
                               "oasis-200401-wss-wssecurity-secext-1.0.xsd");
     namespaces.insert("wsu", "http://docs.oasis-open.org/wss/2004/01/"
                              "oasis-200401-wss-wssecurity-utility-1.0.xsd");
-    Message*    msg      = new Message(namespaces);
-    QDomElement security = newElement("wsse:Security");
+    Message* msg = new Message(namespaces);
+    msg->setUserInfo(name, passwd, clockOffsetMsecs);
+    return msg;
+}
+
+void
+Message::setUserInfo(
+    const QString& name, const QString& passwd, qint64 clockOffsetMsecs) {
+    QDomElement security = mHeader.firstChildElement("wsse:Security");
+    if (!security.isNull())
+        mHeader.removeChild(security);
+    security = newElement("wsse:Security");
 
     QDomElement usernameToken = newElement("wsse:UsernameToken");
     // usernameToken.setAttribute("wsu:Id", "UsernameToken-1");
-    // QDateTime current = QDateTime::currentDateTime();
-    QDateTime current = QDateTime::currentDateTime();
+    // the clock of the device, a drifted one rejects a Created of ours
+    QDateTime current =
+        QDateTime::currentDateTime().addMSecs(clockOffsetMsecs);
 // current.setTime_t(0);
 #if 0 /* PasswordText */
     QDomElement username = newElement("wsse:Username", name);
@@ -171,7 +185,11 @@ Message::getMessageWithUserInfo(
     QString     passwdDigest;
     QString     nonceBase64;
     /* calc passwd Digest and nonce */
+    qint64 digestStart =
+        mCreatedUsecs < 0 ? -1 : RequestTrace::nowUsecs();
     CalcWssePassword(current, passwd, passwdDigest, nonceBase64);
+    if (digestStart >= 0)
+        mDigestUsecs = RequestTrace::nowUsecs() - digestStart;
 
     QDomElement password = newElement("wsse:Password", passwdDigest);
     QDomElement nonce    = newElement("wsse:Nonce", nonceBase64);
@@ -193,13 +211,14 @@ Message::getMessageWithUserInfo(
 #endif
     security.appendChild(usernameToken);
     // security.appendChild(timestamp);
-    msg->appendToHeader(security);
-    return msg;
+    appendToHeader(security);
 }
 
 
 Message::Message(const QHash<QString, QString>& namespaces, QObject* parent)
-    : QObject(parent) {
+    : QObject(parent), mDigestUsecs(-1), mBuildUsecs(-1) {
+    mCreatedUsecs =
+        RequestTrace::isEnabled() ? RequestTrace::nowUsecs() : qint64(-1);
     this->mNamespaces = namespaces;
     mDoc.appendChild(mDoc.createProcessingInstruction(
         "xml", "version=\"1.0\" encoding=\"UTF-8\""));
@@ -207,10 +226,6 @@ Message::Message(const QHash<QString, QString>& namespaces, QObject* parent)
         "http://www.w3.org/2003/05/soap-envelope", "Envelope");
     mHeader = mDoc.createElement("Header");
     mBody   = mDoc.createElement("Body");
-}
-
-QString
-Message::toXmlStr() {
     QHashIterator<QString, QString> i(mNamespaces);
     while (i.hasNext()) {
         i.next();
@@ -219,7 +234,37 @@ Message::toXmlStr() {
     mEnv.appendChild(mHeader);
     mEnv.appendChild(mBody);
     mDoc.appendChild(mEnv);
-    return mDoc.toString();
+}
+
+QString
+Message::toXmlStr() {
+    return QString::fromUtf8(toXml());
+}
+
+QByteArray
+Message::toXml() {
+    if (mXml.isEmpty()) {
+        mXml = mDoc.toByteArray();
+        if (mCreatedUsecs >= 0)
+            mBuildUsecs = RequestTrace::nowUsecs() - mCreatedUsecs -
+                          qMax<qint64>(0, mDigestUsecs);
+    }
+    return mXml;
+}
+
+QString
+Message::operation() const {
+    // some requests carry their xmlns in the tag name ("wsdl:GetScopes xmlns=")
+    QString tagName = mBody.firstChildElement().tagName();
+    return tagName.section(' ', 0, 0).section(':', -1);
+}
+
+QString
+Message::bodyXml() const {
+    QString     xml;
+    QTextStream stream(&xml);
+    mBody.save(stream, -1);
+    return xml;
 }
 
 QString
@@ -231,9 +276,11 @@ Message::uuid() {
 void
 Message::appendToBody(const QDomElement& body) {
     mBody.appendChild(body);
+    mXml.clear();
 }
 
 void
 Message::appendToHeader(const QDomElement& header) {
     mHeader.appendChild(header);
+    mXml.clear();
 }
@@ -7,9 +7,13 @@
 using namespace ONVIF;
 
 MessageParser::MessageParser(
-    const QString& data, QHash<QString, QString>& namespaces, QObject* parent)
+    const QByteArray&        data,
+    QHash<QString, QString>& namespaces,
+    QObject*                 parent)
     : QObject(parent) {
-    mBuffer.setData(data.toUtf8());
+    mCreatedUsecs =
+        RequestTrace::isEnabled() ? RequestTrace::nowUsecs() : qint64(-1);
+    mBuffer.setData(data);
     mBuffer.open(QIODevice::ReadOnly);
     mQuery.bindVariable("inputDocument", &mBuffer);
     QHashIterator<QString, QString> i(namespaces);
@@ -23,6 +27,15 @@ MessageParser::MessageParser(
 
 MessageParser::~MessageParser() {
     mBuffer.close();
+    if (mTrace && mCreatedUsecs >= 0) {
+        mTrace->parseUsecs = RequestTrace::nowUsecs() - mCreatedUsecs;
+        RequestTrace::record(*mTrace);
+    }
+}
+
+void
+MessageParser::setTrace(const TraceSpan& span) {
+    mTrace.reset(new TraceSpan(span));
 }
 
 QString
@@ -0,0 +1,376 @@
+#include "metrics.h"
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+#include <atomic>
+
+using namespace ONVIF;
+
+namespace {
+// log-linear buckets: exact below 16 usecs, then 8 per power of two up to
+// 2^36 usecs (about 19 hours)
+const int kLinearBuckets = 16;
+const int kSubBuckets    = 8;
+const int kBuckets       = kLinearBuckets + (36 - 4) * kSubBuckets;
+
+int
+bucketOf(qint64 _usecs) {
+    if (_usecs < kLinearBuckets)
+        return qMax<qint64>(0, _usecs);
+    int exponent = 4;
+    while ((_usecs >> (exponent + 1)) != 0)
+        exponent++;
+    int sub = int(_usecs >> (exponent - 3)) & (kSubBuckets - 1);
+    return qMin(
+        kBuckets - 1, kLinearBuckets + (exponent - 4) * kSubBuckets + sub);
+}
+
+// largest value that falls in the bucket
+qint64
+bucketUpper(int _bucket) {
+    if (_bucket < kLinearBuckets)
+        return _bucket;
+    int exponent = (_bucket - kLinearBuckets) / kSubBuckets + 4;
+    int sub      = (_bucket - kLinearBuckets) % kSubBuckets;
+    return ((qint64(kSubBuckets + sub + 1)) << (exponent - 3)) - 1;
+}
+
+struct Histogram {
+    std::atomic<quint64> buckets[kBuckets];
+    std::atomic<quint64> count;
+    std::atomic<quint64> sum;
+    std::atomic<qint64>  max;
+
+    Histogram() {
+        reset();
+    }
+
+    void reset() {
+        for (int i = 0; i < kBuckets; i++)
+            buckets[i] = 0;
+        count = 0;
+        sum   = 0;
+        max   = 0;
+    }
+
+    void record(qint64 _usecs) {
+        buckets[bucketOf(_usecs)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(
+            quint64(qMax<qint64>(0, _usecs)), std::memory_order_relaxed);
+        qint64 current = max.load(std::memory_order_relaxed);
+        while (current < _usecs &&
+               !max.compare_exchange_weak(current, _usecs))
+            ;
+    }
+
+    // number of values not above _usecs. the bucket that straddles it is
+    // counted in proportion, its values taken as spread evenly
+    quint64 countBelow(qint64 _usecs) const {
+        double total = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            qint64 upper = bucketUpper(i);
+            double count = buckets[i].load(std::memory_order_relaxed);
+            if (upper <= _usecs) {
+                total += count;
+                continue;
+            }
+            qint64 lower = i == 0 ? 0 : bucketUpper(i - 1) + 1;
+            if (lower <= _usecs)
+                total += count * (_usecs - lower + 1) / (upper - lower + 1);
+            break;
+        }
+        return quint64(qRound64(total));
+    }
+
+    qint64 percentile(double _fraction) const {
+        quint64 total = count.load(std::memory_order_relaxed);
+        if (total == 0)
+            return 0;
+        quint64 rank = quint64(_fraction * total + 0.5);
+        quint64 seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= qMax<quint64>(1, rank))
+                return qMin(bucketUpper(i), max.load());
+        }
+        return max.load();
+    }
+};
+
+struct DeviceCounters {
+    std::atomic<quint64> requests{0};
+    std::atomic<quint64> errors{0};
+    std::atomic<quint64> timeouts{0};
+    std::atomic<quint64> bytesIn{0};
+    std::atomic<quint64> bytesOut{0};
+    std::atomic<qint64>  inFlight{0};
+};
+
+// entries are never removed so the pointers stay valid without the lock
+QReadWriteLock                  gLock;
+QHash<QString, Histogram*>      gOperations;
+QHash<QString, DeviceCounters*> gDevices;
+std::atomic<qint64>             gInFlight{0};
+std::atomic<quint64>            gDatagrams{0};
+std::atomic<quint64>            gProbeMatches{0};
+std::atomic<quint64>            gDiscoveredDevices{0};
+std::atomic<quint64>            gCoalesced{0};
+std::atomic<quint64>            gRetried{0};
+std::atomic<quint64>            gRejected{0};
+
+template <typename T>
+T*
+entry(QHash<QString, T*>& _entries, const QString& _key) {
+    {
+        QReadLocker locker(&gLock);
+        T*          value = _entries.value(_key);
+        if (value != NULL)
+            return value;
+    }
+    QWriteLocker locker(&gLock);
+    T*&          value = _entries[_key];
+    if (value == NULL)
+        value = new T();
+    return value;
+}
+
+QString
+label(const QString& _value) {
+    QString value = _value;
+    value.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+    return "\"" + value + "\"";
+}
+}
+
+void
+Metrics::requestStarted(const QString& _device, qint64 _bytesOut) {
+    DeviceCounters* device = entry(gDevices, _device);
+    device->requests.fetch_add(1, std::memory_order_relaxed);
+    device->bytesOut.fetch_add(
+        quint64(qMax<qint64>(0, _bytesOut)), std::memory_order_relaxed);
+    device->inFlight.fetch_add(1, std::memory_order_relaxed);
+    gInFlight.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Metrics::requestFinished(
+    const QString& _device,
+    const QString& _operation,
+    qint64         _usecs,
+    qint64         _bytesIn,
+    bool           _error,
+    bool           _timeout) {
+    DeviceCounters* device = entry(gDevices, _device);
+    device->inFlight.fetch_sub(1, std::memory_order_relaxed);
+    gInFlight.fetch_sub(1, std::memory_order_relaxed);
+    device->bytesIn.fetch_add(
+        quint64(qMax<qint64>(0, _bytesIn)), std::memory_order_relaxed);
+    if (_error)
+        device->errors.fetch_add(1, std::memory_order_relaxed);
+    if (_timeout)
+        device->timeouts.fetch_add(1, std::memory_order_relaxed);
+    entry(gOperations, _operation)->record(_usecs);
+}
+
+void
+Metrics::requestCoalesced() {
+    gCoalesced.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Metrics::requestRetried() {
+    gRetried.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Metrics::requestRejected() {
+    gRejected.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Metrics::discoveryDatagram(bool _decoded) {
+    gDatagrams.fetch_add(1, std::memory_order_relaxed);
+    if (_decoded)
+        gProbeMatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Metrics::discoveredDevice() {
+    gDiscoveredDevices.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsSnapshot
+Metrics::snapshot() {
+    MetricsSnapshot snapshot;
+    QReadLocker     locker(&gLock);
+    QStringList     operations = gOperations.keys();
+    operations.sort();
+    foreach (const QString& name, operations) {
+        const Histogram*           histogram = gOperations.value(name);
+        MetricsSnapshot::Operation operation;
+        operation.operation = name;
+        operation.count     = histogram->count.load();
+        operation.sumUsecs  = histogram->sum.load();
+        operation.p50Usecs  = histogram->percentile(0.50);
+        operation.p90Usecs  = histogram->percentile(0.90);
+        operation.p99Usecs  = histogram->percentile(0.99);
+        operation.maxUsecs  = histogram->max.load();
+        snapshot.operations.append(operation);
+    }
+    QStringList devices = gDevices.keys();
+    devices.sort();
+    foreach (const QString& name, devices) {
+        const DeviceCounters*   counters = gDevices.value(name);
+        MetricsSnapshot::Device device;
+        device.device   = name;
+        device.requests = counters->requests.load();
+        device.errors   = counters->errors.load();
+        device.timeouts = counters->timeouts.load();
+        device.bytesIn  = counters->bytesIn.load();
+        device.bytesOut = counters->bytesOut.load();
+        device.inFlight = counters->inFlight.load();
+        snapshot.devices.append(device);
+    }
+    snapshot.inFlight               = gInFlight.load();
+    snapshot.coalesced              = gCoalesced.load();
+    snapshot.retried                = gRetried.load();
+    snapshot.rejected               = gRejected.load();
+    snapshot.discovery.datagrams    = gDatagrams.load();
+    snapshot.discovery.probeMatches = gProbeMatches.load();
+    snapshot.discovery.devices      = gDiscoveredDevices.load();
+    return snapshot;
+}
+
+QByteArray
+Metrics::toPrometheus() {
+    static const double kBounds[] = {
+        0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30};
+
+    QString     text;
+    QReadLocker locker(&gLock);
+    QStringList operations = gOperations.keys();
+    operations.sort();
+    text += "# HELP onvif_request_duration_seconds Latency of onvif requests.\n"
+            "# TYPE onvif_request_duration_seconds histogram\n";
+    foreach (const QString& name, operations) {
+        const Histogram* histogram = gOperations.value(name);
+        QString          operation = "operation=" + label(name);
+        for (double bound : kBounds)
+            text += QString("onvif_request_duration_seconds_bucket"
+                            "{%1,le=\"%2\"} %3\n")
+                        .arg(operation)
+                        .arg(bound)
+                        .arg(histogram->countBelow(qRound64(bound * 1e6)));
+        quint64 count = histogram->count.load();
+        text += QString("onvif_request_duration_seconds_bucket"
+                        "{%1,le=\"+Inf\"} %2\n")
+                    .arg(operation)
+                    .arg(count);
+        // the sum is kept in microseconds, %g would cut it to 6 digits
+        text += QString("onvif_request_duration_seconds_sum{%1} %2\n")
+                    .arg(operation)
+                    .arg(QString::number(histogram->sum.load() / 1e6, 'f', 6));
+        text += QString("onvif_request_duration_seconds_count{%1} %2\n")
+                    .arg(operation)
+                    .arg(count);
+    }
+
+    struct Counter {
+        const char* name;
+        const char* type;
+        const char* help;
+    };
+    static const Counter kCounters[] = {
+        {"onvif_requests_total", "counter", "Requests sent."},
+        {"onvif_request_errors_total",
+         "counter",
+         "Requests failed with a network, http or soap error."},
+        {"onvif_request_timeouts_total", "counter", "Requests timed out."},
+        {"onvif_received_bytes_total", "counter", "Response bytes."},
+        {"onvif_sent_bytes_total", "counter", "Request bytes."},
+        {"onvif_requests_in_flight", "gauge", "Requests waiting for a reply."}};
+
+    QStringList devices = gDevices.keys();
+    devices.sort();
+    int counters = sizeof(kCounters) / sizeof(kCounters[0]);
+    for (int i = 0; i < counters; i++) {
+        text += QString("# HELP %1 %2\n# TYPE %1 %3\n")
+                    .arg(kCounters[i].name)
+                    .arg(kCounters[i].help)
+                    .arg(kCounters[i].type);
+        foreach (const QString& name, devices) {
+            const DeviceCounters* counters = gDevices.value(name);
+            qint64                values[] = {
+                qint64(counters->requests.load()),
+                qint64(counters->errors.load()),
+                qint64(counters->timeouts.load()),
+                qint64(counters->bytesIn.load()),
+                qint64(counters->bytesOut.load()),
+                counters->inFlight.load()};
+            text += QString("%1{device=%2} %3\n")
+                        .arg(kCounters[i].name)
+                        .arg(label(name))
+                        .arg(values[i]);
+        }
+    }
+
+    static const Counter kOutcomes[] = {
+        {"onvif_requests_coalesced_total",
+         "counter",
+         "Requests answered by an identical one in flight."},
+        {"onvif_requests_retried_total",
+         "counter",
+         "Requests sent again after a transient failure."},
+        {"onvif_requests_rejected_total",
+         "counter",
+         "Requests refused while the circuit of the device was open."}};
+    quint64 outcomes[] = {
+        gCoalesced.load(), gRetried.load(), gRejected.load()};
+    for (int i = 0; i < 3; i++) {
+        text += QString("# HELP %1 %2\n# TYPE %1 %3\n%1 %4\n")
+                    .arg(kOutcomes[i].name)
+                    .arg(kOutcomes[i].help)
+                    .arg(kOutcomes[i].type)
+                    .arg(outcomes[i]);
+    }
+
+    static const Counter kDiscovery[] = {
+        {"onvif_discovery_datagrams_total",
+         "counter",
+         "Datagrams read by the device searcher."},
+        {"onvif_discovery_probe_matches_total",
+         "counter",
+         "ProbeMatches decoded."},
+        {"onvif_discovery_devices_total", "counter", "Devices created."}};
+    quint64 discovery[] = {
+        gDatagrams.load(), gProbeMatches.load(), gDiscoveredDevices.load()};
+    for (int i = 0; i < 3; i++) {
+        text += QString("# HELP %1 %2\n# TYPE %1 %3\n%1 %4\n")
+                    .arg(kDiscovery[i].name)
+                    .arg(kDiscovery[i].help)
+                    .arg(kDiscovery[i].type)
+                    .arg(discovery[i]);
+    }
+    return text.toUtf8();
+}
+
+void
+Metrics::reset() {
+    QReadLocker locker(&gLock);
+    foreach (Histogram* histogram, gOperations)
+        histogram->reset();
+    foreach (DeviceCounters* counters, gDevices) {
+        counters->requests = 0;
+        counters->errors   = 0;
+        counters->timeouts = 0;
+        counters->bytesIn  = 0;
+        counters->bytesOut = 0;
+    }
+    gDatagrams         = 0;
+    gProbeMatches      = 0;
+    gDiscoveredDevices = 0;
+    gCoalesced         = 0;
+    gRetried           = 0;
+    gRejected          = 0;
+}
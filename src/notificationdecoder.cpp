@@ -0,0 +1,84 @@
+#include "notificationdecoder.h"
+#include <QXmlStreamReader>
+
+using namespace ONVIF;
+
+namespace {
+const char kWsnt[]   = "http://docs.oasis-open.org/wsn/b-2";
+const char kSchema[] = "http://www.onvif.org/ver10/schema";
+}
+
+NotificationDecoder::NotificationDecoder()
+    : mStream(kWsnt, "NotificationMessage"), mError(false) {}
+
+void
+NotificationDecoder::addData(const QByteArray& _data) {
+    mStream.addData(_data);
+    foreach (const QByteArray& message, mStream.takeElements()) {
+        Data::Event event;
+        if (decode(message, event))
+            mEvents.append(event);
+        else
+            mError = true;
+    }
+}
+
+QList<Data::Event>
+NotificationDecoder::takeEvents() {
+    QList<Data::Event> events;
+    events.swap(mEvents);
+    return events;
+}
+
+bool
+NotificationDecoder::isFinished() const {
+    return mStream.isFinished();
+}
+
+bool
+NotificationDecoder::hasError() const {
+    return mError || mStream.hasError();
+}
+
+bool
+NotificationDecoder::decode(const QByteArray& _message, Data::Event& _event) {
+    QXmlStreamReader         reader(_message);
+    QHash<QString, QString>* items = NULL;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isEndElement()) {
+            if (reader.namespaceUri() == kSchema &&
+                (reader.name() == "Source" || reader.name() == "Key" ||
+                 reader.name() == "Data"))
+                items = NULL;
+            continue;
+        }
+        if (!reader.isStartElement())
+            continue;
+
+        QXmlStreamAttributes attributes = reader.attributes();
+        if (reader.namespaceUri() == kWsnt && reader.name() == "Topic") {
+            _event.topic =
+                reader
+                    .readElementText(QXmlStreamReader::IncludeChildElements)
+                    .trimmed();
+        } else if (reader.namespaceUri() != kSchema) {
+            continue;
+        } else if (reader.name() == "Message") {
+            _event.utcTime =
+                QDateTime::fromString(
+                    attributes.value("UtcTime").toString(), Qt::ISODate)
+                    .toUTC();
+            _event.operation = attributes.value("PropertyOperation").toString();
+        } else if (reader.name() == "Source" || reader.name() == "Key") {
+            items = &_event.source;
+        } else if (reader.name() == "Data") {
+            items = &_event.data;
+        } else if (reader.name() == "SimpleItem" && items != NULL) {
+            items->insert(
+                attributes.value("Name").toString(),
+                attributes.value("Value").toString());
+        }
+    }
+    return !reader.hasError();
+}
@@ -256,94 +256,64 @@ void PtzManagement::getPresets(Presets *presets)
     delete result;
 }
 
-void PtzManagement::removePreset(RemovePreset *removePreset)
+ResponseStatus PtzManagement::removePreset(RemovePreset *removePreset)
 {
     Message *msg = newMessage();
     msg->appendToBody(removePreset->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:RemovePresetResponse"))
-            removePreset->setResult(true);
-        else
-            removePreset->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:RemovePresetResponse");
+    removePreset->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::setPreset(Preset *preset)
+ResponseStatus PtzManagement::setPreset(Preset *preset)
 {
     Message *msg = newMessage();
     msg->appendToBody(preset->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:SetPresetResponse"))
-            preset->setResult(true);
-        else
-            preset->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:SetPresetResponse");
+    preset->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::continuousMove(ContinuousMove *continuousMove)
+ResponseStatus PtzManagement::continuousMove(ContinuousMove *continuousMove)
 {
     Message *msg = newMessage();
     msg->appendToBody(continuousMove->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:ContinuousMoveResponse"))
-            continuousMove->setResult(true);
-        else
-            continuousMove->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:ContinuousMoveResponse");
+    continuousMove->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::absoluteMove(AbsoluteMove *absoluteMove)
+ResponseStatus PtzManagement::absoluteMove(AbsoluteMove *absoluteMove)
 {
     Message *msg = newMessage();
     msg->appendToBody(absoluteMove->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:AbsoluteMoveResponse"))
-            absoluteMove->setResult(true);
-        else
-            absoluteMove->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:AbsoluteMoveResponse");
+    absoluteMove->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::relativeMove(RelativeMove *relativeMove)
+ResponseStatus PtzManagement::relativeMove(RelativeMove *relativeMove)
 {
     Message *msg = newMessage();
     msg->appendToBody(relativeMove->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:RelativeMoveResponse"))
-            relativeMove->setResult(true);
-        else
-            relativeMove->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:RelativeMoveResponse");
+    relativeMove->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::stop(Stop *stop)
+ResponseStatus PtzManagement::stop(Stop *stop)
 {
     Message *msg = newMessage();
     msg->appendToBody(stop->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:StopResponse"))
-            stop->setResult(true);
-        else
-            stop->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:StopResponse");
+    stop->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
 Nodes *PtzManagement::getNodes()
@@ -516,49 +486,34 @@ Nodes *PtzManagement::getNodes()
 }
 
 
-void PtzManagement::gotoPreset(GotoPreset *gotoPreset)
+ResponseStatus PtzManagement::gotoPreset(GotoPreset *gotoPreset)
 {
     Message *msg = newMessage();
     msg->appendToBody(gotoPreset->toxml());
-    MessageParser *result = sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:GotoPresetResponse"))
-            gotoPreset->setResult(true);
-        else
-            gotoPreset->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:GotoPresetResponse");
+    gotoPreset->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::gotoHomePosition(GotoHomePosition *gotoHomePosition)
+ResponseStatus PtzManagement::gotoHomePosition(GotoHomePosition *gotoHomePosition)
 {
     Message *msg = newMessage();
     msg->appendToBody(gotoHomePosition->toxml());
-    MessageParser *result =sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:GotoHomePositionResponse"))
-            gotoHomePosition->setResult(true);
-        else
-            gotoHomePosition->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:GotoHomePositionResponse");
+    gotoHomePosition->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
-void PtzManagement::setHomePosition(HomePosition *homePosition)
+ResponseStatus PtzManagement::setHomePosition(HomePosition *homePosition)
 {
     Message *msg = newMessage();
     msg->appendToBody(homePosition->toxml());
-    MessageParser *result =sendMessage(msg);
-    if(result != NULL) {
-        if(result->find("//tptz:SetHomePositionResponse"))
-            homePosition->setResult(true);
-        else
-            homePosition->setResult(false);
-        delete msg;
-        delete result;
-    }
+    ResponseStatus status = sendCommand(msg, "tptz:SetHomePositionResponse");
+    homePosition->setResult(status.isOk());
+    delete msg;
+    return status;
 }
 
 void PtzManagement::getConfiguration(Configuration *configuration)
@@ -2,7 +2,17 @@
 #include "devicemanagement.h"
 #include "mediamanagement.h"
 #include "ptzmanagement.h"
+#include "requestscheduler.h"
+#include "retrypolicy.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QMutex>
+#include <QNetworkAccessManager>
 #include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <functional>
 
 ///////////////////////////////////////////////////////////////////////////////
 namespace device {
@@ -10,6 +20,8 @@ namespace device {
 class QOnvifDevicePrivate
 {
 public:
+    typedef Data::MediaConfig::Video::EncoderConfigs::Option Option;
+
     QOnvifDevicePrivate(
         const QString _serviceAddress,
         const QString _username,
@@ -23,6 +35,28 @@ public:
 
         iptzManagement =
             new ONVIF::PtzManagement{_serviceAddress, iuserName, ipassword};
+
+        ideviceManagement->setScheduler(&ischeduler);
+        imediaManagement->setScheduler(&ischeduler);
+        iptzManagement->setScheduler(&ischeduler);
+        ideviceManagement->setCircuitBreaker(&ibreaker);
+        imediaManagement->setCircuitBreaker(&ibreaker);
+        iptzManagement->setCircuitBreaker(&ibreaker);
+        ideviceManagement->setClockOffset(&iclockOffset);
+        imediaManagement->setClockOffset(&iclockOffset);
+        iptzManagement->setClockOffset(&iclockOffset);
+        // learned once for the device and restored with its snapshot
+        ideviceManagement->setAuthentication(&idata.authentication);
+        imediaManagement->setAuthentication(&idata.authentication);
+        iptzManagement->setAuthentication(&idata.authentication);
+        // one connection pool, so a kept-alive (https) connection serves
+        // all three services
+        ideviceManagement->shareNetworkAccessManager(&inetworkManager);
+        imediaManagement->shareNetworkAccessManager(&inetworkManager);
+        iptzManagement->shareNetworkAccessManager(&inetworkManager);
+        iclockOffset.setMeasure([this](qint64& _offsetMsecs) {
+            return ideviceManagement->getClockOffset(_offsetMsecs);
+        });
     }
     ~QOnvifDevicePrivate() {
         delete ideviceManagement;
@@ -33,11 +67,57 @@ public:
     QString iuserName;
     QString ipassword;
     Data    idata;
+    // outlives the services, deleted in the destructor body
+    QNetworkAccessManager inetworkManager;
 
     // onvif managers
     ONVIF::DeviceManagement* ideviceManagement;
     ONVIF::MediaManagement*  imediaManagement;
     ONVIF::PtzManagement*    iptzManagement;
+    // orders the requests of all three services by priority class
+    ONVIF::RequestScheduler  ischeduler;
+    ONVIF::CircuitBreaker    ibreaker;
+    ONVIF::ClockOffset       iclockOffset;
+
+    // stream uris by "token|transport", expiresAt is msecs since epoch
+    // (0: never). a multicast/http transport the camera refused with a
+    // fault is kept as an empty uri for a while so cameras without it are
+    // not asked again on every refresh, a request that got no answer is
+    // never kept
+    struct CachedStreamUri {
+        Data::MediaConfig::Video::StreamUri streamUri;
+        qint64                              expiresAt;
+    };
+    QHash<QString, CachedStreamUri> istreamUriCache;
+    static const qint64             kFailedStreamUriTtl = 5 * 60 * 1000;
+
+    // a refresh younger than ifreshnessMsecs is answered from idata, the
+    // times are by operation ("refreshProfiles") and any setter drops them
+    int                    ifreshnessMsecs = 0;
+    QElapsedTimer          iclock;
+    QHash<QString, qint64> irefreshedAt;
+
+    bool
+    fresh(const char* _operation, bool (QOnvifDevicePrivate::*_refresh)()) {
+        if (!iclock.isValid())
+            iclock.start();
+        QHash<QString, qint64>::const_iterator refreshed =
+            irefreshedAt.constFind(_operation);
+        if (ifreshnessMsecs > 0 && refreshed != irefreshedAt.constEnd() &&
+            iclock.elapsed() - refreshed.value() < ifreshnessMsecs)
+            return true;
+        qint64 started = iclock.elapsed();
+        bool   result  = (this->*_refresh)();
+        if (result)
+            irefreshedAt.insert(_operation, started);
+        else
+            irefreshedAt.remove(_operation);
+        return result;
+    }
+
+    // video encoder options interned by manufacturer|model|firmware|token
+    static QHash<QString, Option> isharedOptions;
+    static QMutex                 isharedOptionsMutex;
 
     Data::ProbeData deviceProbeData() {
         return idata.probeData;
@@ -84,29 +164,54 @@ public:
         ideviceManagement->setDeviceScopes(&systemScopes);
         return systemScopes.result();
     }
+    static void toVideoEncoderConfiguration(
+        const Data::MediaConfig::Video::EncoderConfig& _videoConfig,
+        ONVIF::VideoEncoderConfiguration&              _des) {
+        _des.setToken(_videoConfig.token);
+        _des.setName(_videoConfig.name);
+        _des.setUseCount(_videoConfig.useCount);
+        _des.setEncoding(_videoConfig.encoding);
+        _des.setWidth(_videoConfig.width);
+        _des.setHeight(_videoConfig.height);
+        _des.setQuality(_videoConfig.quality);
+        _des.setFrameRateLimit(_videoConfig.frameRateLimit);
+        _des.setEncodingInterval(_videoConfig.encodingInterval);
+        _des.setBitrateLimit(_videoConfig.bitrateLimit);
+        _des.setGovLength(_videoConfig.govLength);
+        _des.setH264Profile(_videoConfig.h264Profile);
+        _des.setType(_videoConfig.type);
+        _des.setIpv4Address(_videoConfig.ipv4Address);
+        _des.setPort(_videoConfig.port);
+        _des.setTtl(_videoConfig.ttl);
+        _des.setAutoStart(_videoConfig.autoStart);
+        _des.setSessionTimeout(_videoConfig.sessionTimeout);
+    }
+
     bool setVideoConfig(Data::MediaConfig::Video::EncoderConfig _videoConfig) {
         ONVIF::VideoEncoderConfiguration videoConfiguration;
-        videoConfiguration.setToken(_videoConfig.token);
-        videoConfiguration.setName(_videoConfig.name);
-        videoConfiguration.setUseCount(_videoConfig.useCount);
-        videoConfiguration.setEncoding(_videoConfig.encoding);
-        videoConfiguration.setWidth(_videoConfig.width);
-        videoConfiguration.setHeight(_videoConfig.height);
-        videoConfiguration.setQuality(_videoConfig.quality);
-        videoConfiguration.setFrameRateLimit(_videoConfig.frameRateLimit);
-        videoConfiguration.setEncodingInterval(_videoConfig.encodingInterval);
-        videoConfiguration.setBitrateLimit(_videoConfig.bitrateLimit);
-        videoConfiguration.setGovLength(_videoConfig.govLength);
-        videoConfiguration.setH264Profile(_videoConfig.h264Profile);
-        videoConfiguration.setType(_videoConfig.type);
-        videoConfiguration.setIpv4Address(_videoConfig.ipv4Address);
-        videoConfiguration.setPort(_videoConfig.port);
-        videoConfiguration.setTtl(_videoConfig.ttl);
-        videoConfiguration.setAutoStart(_videoConfig.autoStart);
-        videoConfiguration.setSessionTimeout(_videoConfig.sessionTimeout);
+        toVideoEncoderConfiguration(_videoConfig, videoConfiguration);
         imediaManagement->setVideoEncoderConfiguration(&videoConfiguration);
         return videoConfiguration.result();
     }
+
+    QNetworkReply*
+    postVideoConfig(Data::MediaConfig::Video::EncoderConfig _videoConfig) {
+        ONVIF::VideoEncoderConfiguration videoConfiguration;
+        toVideoEncoderConfiguration(_videoConfig, videoConfiguration);
+        return imediaManagement->postVideoEncoderConfiguration(
+            &videoConfiguration);
+    }
+
+    bool videoConfigResult(QNetworkReply* _reply, QString* _error) {
+        ONVIF::VideoEncoderConfiguration videoConfiguration;
+        ONVIF::ResponseStatus status =
+            imediaManagement->readVideoEncoderConfiguration(
+                _reply, &videoConfiguration);
+        if (_error != NULL)
+            *_error = status.errorString();
+        return status.isOk();
+    }
+
     bool setInterfaces(Data::Network::Interfaces _interface) {
         ONVIF::NetworkInterfaces networkInterface;
         auto&                    des = networkInterface;
@@ -188,12 +293,13 @@ public:
     }
 
     bool refreshDeviceCapabilities() {
-        QScopedPointer<ONVIF::Capabilities> capabilitiesDevice(
-            ideviceManagement->getCapabilitiesDevice());
-        if (!capabilitiesDevice)
+        // every category in one round trip
+        QScopedPointer<ONVIF::Capabilities> capabilities(
+            ideviceManagement->getCapabilities());
+        if (!capabilities)
             return false;
 
-        auto& src = capabilitiesDevice;
+        auto& src = capabilities;
         auto& des = idata.capabilities;
 
         des.accessPolicyConfig     = src->accessPolicyConfig();
@@ -228,39 +334,44 @@ public:
         des.discoveryBye           = src->discoveryBye();
         des.remoteDiscovery        = src->remoteDiscovery();
 
-        // ptz capabilities
-        QScopedPointer<ONVIF::Capabilities> capabilitiesPtz(
-            ideviceManagement->getCapabilitiesDevice());
-        if (!capabilitiesPtz)
-            return false;
-
-        des.ptzAddress = capabilitiesPtz->ptzXAddr();
+        des.ptzAddress      = src->ptzXAddr();
+        des.imagingXAddress = src->imagingXAddr();
+        des.eventsXAddress  = src->eventsXAddr();
+        des.mediaXAddress   = src->mediaXAddr();
+        des.rtpMulticast    = src->rtpMulticast();
+        des.rtpTcp          = src->rtpTcp();
+        des.rtpRtspTcp      = src->rtpRtspTcp();
 
-        // image capabilities
-        QScopedPointer<ONVIF::Capabilities> capabilitiesImage(
-            ideviceManagement->getCapabilitiesDevice());
-        if (!capabilitiesImage)
-            return false;
-
-        des.imagingXAddress = capabilitiesImage->imagingXAddr();
-
-        // media capabilities
-        QScopedPointer<ONVIF::Capabilities> capabilitiesMedia(
-            ideviceManagement->getCapabilitiesDevice());
-        if (!capabilitiesMedia)
-            return false;
+        routeService(imediaManagement, des.mediaXAddress);
+        routeService(iptzManagement, des.ptzAddress);
+        return true;
+    }
 
-        des.mediaXAddress = capabilitiesMedia->mediaXAddr();
-        des.rtpMulticast  = capabilitiesMedia->rtpMulticast();
-        des.rtpTcp        = capabilitiesMedia->rtpTcp();
-        des.rtpRtspTcp    = capabilitiesMedia->rtpRtspTcp();
+    // the media and ptz requests go to the XAddrs of the capabilities, at
+    // the host and port the device service answers on: behind a nat the
+    // camera only knows its inner address
+    void routeService(ONVIF::Service* _service, const QString& _xaddr) {
+        QString address = routedAddress(_xaddr);
+        if (!address.isEmpty())
+            _service->setServiceAddress(address);
+    }
 
-        return true;
+    // empty when _xaddr is
+    QString routedAddress(const QString& _xaddr) const {
+        QUrl url(_xaddr);
+        if (_xaddr.isEmpty() || !url.isValid())
+            return QString();
+        QUrl device(ideviceManagement->serviceAddress());
+        url.setScheme(device.scheme());
+        url.setHost(device.host());
+        url.setPort(device.port());
+        return url.toString();
     }
 
     bool refreshDeviceInformation() { // todo
         QHash<QString, QString> deviceInformationHash =
             ideviceManagement->getDeviceInformation();
+        ONVIF::ApplyTrace apply;
         idata.information.manufacturer = deviceInformationHash.value("mf");
         idata.information.model        = deviceInformationHash.value("model");
         idata.information.firmwareVersion =
@@ -290,6 +401,8 @@ public:
             isHard ? ONVIF::SystemFactoryDefault::Hard
                    : ONVIF::SystemFactoryDefault::Soft);
         ideviceManagement->setSystemFactoryDefault(systemFactoryDefault.data());
+        if (systemFactoryDefault->result())
+            invalidateStreamUris(false);
         return systemFactoryDefault->result();
     }
 
@@ -300,6 +413,8 @@ public:
         if (!systemReboot)
             return false;
         ideviceManagement->systemReboot(systemReboot.data());
+        if (systemReboot->result())
+            invalidateStreamUris(true);
         return systemReboot->result();
     }
 
@@ -312,8 +427,9 @@ public:
             return false;
 
         {
-            auto& des = idata.mediaConfig.video.encodingConfigs;
-            auto& src = videoEncoderConfigurations;
+            ONVIF::ApplyTrace apply;
+            auto&             des = idata.mediaConfig.video.encodingConfigs;
+            auto&             src = videoEncoderConfigurations;
 
             des.autoStart        = src->getAutoStart();
             des.bitrateLimit     = src->getBitrateLimit();
@@ -345,6 +461,8 @@ public:
             return false;
 
         {
+            ONVIF::ApplyTrace apply;
+
             auto& des       = idata.mediaConfig.video.sourceConfig;
             auto& src       = videoSourceConfigurations;
             des.name        = src->getName();
@@ -356,92 +474,231 @@ public:
         return true;
     }
 
+    static QString streamUriKey(
+        const QString& _token, ONVIF::StreamUri::Transport _transport) {
+        return _token + "|" + QString::number(_transport);
+    }
+
+    bool cachedStreamUri(
+        const QString& _key, Data::MediaConfig::Video::StreamUri& _streamUri) {
+        if (!istreamUriCache.contains(_key))
+            return false;
+        const CachedStreamUri& entry = istreamUriCache[_key];
+        if (entry.expiresAt != 0 &&
+            entry.expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+            istreamUriCache.remove(_key);
+            return false;
+        }
+        _streamUri = entry.streamUri;
+        return true;
+    }
+
+    void cacheStreamUri(const QString& _key, ONVIF::StreamUri* _streamUri) {
+        CachedStreamUri entry;
+        qint64          now = QDateTime::currentMSecsSinceEpoch();
+        if (_streamUri == NULL) { // refused
+            entry.streamUri = Data::MediaConfig::Video::StreamUri();
+            entry.expiresAt = now + kFailedStreamUriTtl;
+            istreamUriCache.insert(_key, entry);
+            return;
+        }
+        // one shot uris must be asked again for every connection
+        qint64 timeout = _streamUri->timeoutMsecs();
+        if (_streamUri->invalidAfterConnect() || timeout < 0)
+            return;
+        entry.streamUri.uri                 = _streamUri->uri();
+        entry.streamUri.invalidAfterConnect = false;
+        entry.streamUri.invalidAfterReboot  = _streamUri->invalidAfterReboot();
+        entry.streamUri.timeout             = _streamUri->timeout();
+        entry.expiresAt = timeout == 0 ? 0 : now + timeout;
+        istreamUriCache.insert(_key, entry);
+    }
+
+    void invalidateStreamUris(bool _rebootedOnly) {
+        QMutableHashIterator<QString, CachedStreamUri> i(istreamUriCache);
+        while (i.hasNext()) {
+            i.next();
+            if (!_rebootedOnly || i.value().streamUri.invalidAfterReboot)
+                i.remove();
+        }
+    }
+
     bool refreshStreamUris() {
-        // get video stream uri
-        idata.profiles.streamUris.clear();
-        for (int i = 0; i < idata.profiles.toKenPro.length(); i++) {
-            QScopedPointer<ONVIF::StreamUri> streamUri(
-                imediaManagement->getStreamUri(
-                    idata.profiles.toKenPro.value(i)));
-            if (!streamUri)
-                return false;
-            Data::MediaConfig::Video::StreamUri streamUriTemp;
-            streamUriTemp.uri = streamUri->uri();
-            streamUriTemp.invalidAfterConnect =
-                streamUri->invalidAfterConnect();
-            streamUriTemp.invalidAfterReboot = streamUri->invalidAfterReboot();
-            streamUriTemp.timeout            = streamUri->timeout();
-
-            if (i == 0) {
-                idata.mediaConfig.video.streamUri = streamUriTemp;
+        const QList<ONVIF::StreamUri::Transport> transports =
+            QList<ONVIF::StreamUri::Transport>()
+            << ONVIF::StreamUri::RtspUnicast << ONVIF::StreamUri::RtpMulticast
+            << ONVIF::StreamUri::Http;
+        const QList<QString>& profileTokens = idata.profiles.toKenPro;
+
+        // resolve from cache, ask the camera only for the rest (all at once)
+        QHash<QString, Data::MediaConfig::Video::StreamUri> resolved;
+        QStringList                                        missingTokens;
+        QList<ONVIF::StreamUri::Transport>                 missingTransports;
+        foreach (QString token, profileTokens) {
+            foreach (ONVIF::StreamUri::Transport transport, transports) {
+                QString key = streamUriKey(token, transport);
+                Data::MediaConfig::Video::StreamUri streamUri;
+                if (cachedStreamUri(key, streamUri)) {
+                    resolved.insert(key, streamUri);
+                } else {
+                    missingTokens.append(token);
+                    missingTransports.append(transport);
+                }
             }
-            idata.profiles.streamUris.append(streamUriTemp);
         }
-        return true;
+
+        if (!missingTokens.isEmpty()) {
+            QList<bool>              refused;
+            QList<ONVIF::StreamUri*> streamUris =
+                imediaManagement->getStreamUris(
+                    missingTokens, missingTransports, &refused);
+            for (int i = 0; i < streamUris.length(); i++) {
+                QString key =
+                    streamUriKey(missingTokens.at(i), missingTransports.at(i));
+                ONVIF::StreamUri* src = streamUris.at(i);
+                if (src != NULL ||
+                    (refused.value(i) &&
+                     missingTransports.at(i) != ONVIF::StreamUri::RtspUnicast))
+                    cacheStreamUri(key, src);
+                if (src == NULL)
+                    continue;
+                Data::MediaConfig::Video::StreamUri des;
+                des.uri                 = src->uri();
+                des.invalidAfterConnect = src->invalidAfterConnect();
+                des.invalidAfterReboot  = src->invalidAfterReboot();
+                des.timeout             = src->timeout();
+                resolved.insert(key, des);
+            }
+            qDeleteAll(streamUris);
+        }
+
+        // a profile without multicast or http is normal, only rtsp counts
+        bool result = true;
+        idata.profiles.streamUris.clear();
+        idata.profiles.streamUrisMulticast.clear();
+        idata.profiles.streamUrisHttp.clear();
+        foreach (QString token, profileTokens) {
+            Data::MediaConfig::Video::StreamUri rtsp = resolved.value(
+                streamUriKey(token, ONVIF::StreamUri::RtspUnicast));
+            if (rtsp.uri.isEmpty())
+                result = false;
+            idata.profiles.streamUris.append(rtsp);
+            idata.profiles.streamUrisMulticast.append(resolved.value(
+                streamUriKey(token, ONVIF::StreamUri::RtpMulticast)));
+            idata.profiles.streamUrisHttp.append(
+                resolved.value(streamUriKey(token, ONVIF::StreamUri::Http)));
+        }
+        if (!idata.profiles.streamUris.isEmpty())
+            idata.mediaConfig.video.streamUri =
+                idata.profiles.streamUris.first();
+        return result;
     }
 
-    bool refreshVideoConfigsOptions() {
-        idata.mediaConfig.video.encodingConfigs.options.clear();
+    static Option toOption(ONVIF::VideoEncoderConfigurationOptions* src) {
+        Option des;
+        des.encodingIntervalRangeMaxH264 =
+            src->encodingIntervalRangeMaxH264();
+        des.encodingIntervalRangeMinH264 =
+            src->encodingIntervalRangeMinH264();
+        des.frameRateRangeMaxH264  = src->frameRateRangeMaxH264();
+        des.frameRateRangeMinH264  = src->frameRateRangeMinH264();
+        des.bitRateRangeMax        = src->bitRateRangeMax();
+        des.bitRateRangeMin        = src->bitRateRangeMin();
+        des.govLengthRangeMax      = src->govLengthRangeMax();
+        des.govLengthRangeMin      = src->govLengthRangeMin();
+        des.qualityRangeMin        = src->qualityRangeMin();
+        des.qualityRangeMax        = src->qulityRangeMax();
+        des.resAvailableHeightH264 = src->resAvailableHeightH264();
+        des.resAvailableWidthH264  = src->resAvailableWidthH264();
+        des.encodingIntervalRangeMaxJpeg =
+            src->encodingIntervalRangeMaxJpeg();
+        des.encodingIntervalRangeMinJpeg =
+            src->encodingIntervalRangeMinJpeg();
+        des.frameRateRangeMaxJpeg  = src->frameRateRangeMaxJpeg();
+        des.frameRateRangeMinJpeg  = src->frameRateRangeMinJpeg();
+        des.resAvailableHeightJpeg = src->resAvailableHeightJpeg();
+        des.resAvailableWidthJpeg  = src->resAvailableWidthJpeg();
 
-        // get video encoder options
         foreach (
-            QString _configToken,
-            idata.mediaConfig.video.encodingConfigs.token) {
-
-            QScopedPointer<ONVIF::VideoEncoderConfigurationOptions>
-                videoEncoderConfigurationOptions(
-                    imediaManagement->getVideoEncoderConfigurationOptions(
-                        _configToken, ""));
-
-            if (!videoEncoderConfigurationOptions)
-                return false;
-
-            Data::MediaConfig::Video::EncoderConfigs::Option encodingOptions;
-
-            auto& des = encodingOptions;
-            auto& src = videoEncoderConfigurationOptions;
-
-            des.encodingIntervalRangeMaxH264 =
-                src->encodingIntervalRangeMaxH264();
-            des.encodingIntervalRangeMinH264 =
-                src->encodingIntervalRangeMinH264();
-            des.frameRateRangeMaxH264  = src->frameRateRangeMaxH264();
-            des.frameRateRangeMinH264  = src->frameRateRangeMinH264();
-            des.bitRateRangeMax        = src->bitRateRangeMax();
-            des.bitRateRangeMin        = src->bitRateRangeMin();
-            des.govLengthRangeMax      = src->govLengthRangeMax();
-            des.govLengthRangeMin      = src->govLengthRangeMin();
-            des.qualityRangeMin        = src->qualityRangeMin();
-            des.qualityRangeMax        = src->qulityRangeMax();
-            des.resAvailableHeightH264 = src->resAvailableHeightH264();
-            des.resAvailableWidthH264  = src->resAvailableWidthH264();
-            des.encodingIntervalRangeMaxJpeg =
-                src->encodingIntervalRangeMaxJpeg();
-            des.encodingIntervalRangeMinJpeg =
-                src->encodingIntervalRangeMinJpeg();
-            des.frameRateRangeMaxJpeg  = src->frameRateRangeMaxJpeg();
-            des.frameRateRangeMinJpeg  = src->frameRateRangeMinJpeg();
-            des.resAvailableHeightJpeg = src->resAvailableHeightJpeg();
-            des.resAvailableWidthJpeg  = src->resAvailableWidthJpeg();
-
-            foreach (
-                ONVIF::VideoEncoderConfigurationOptions::H264ProfilesSupported
-                    h264ProfilesSupporte,
-                src->getH264ProfilesSupported()) {
-                int intCastTemp = static_cast<int>(h264ProfilesSupporte);
-
-                Data::MediaConfig::Video::EncoderConfigs::Option::
-                    H264ProfilesSupported enumCastTemp =
-                        static_cast<Data::MediaConfig::Video::EncoderConfigs::
-                                        Option::H264ProfilesSupported>(
-                            intCastTemp);
-
-                des.h264ProfilesSupported.append(enumCastTemp);
+            ONVIF::VideoEncoderConfigurationOptions::H264ProfilesSupported
+                h264ProfilesSupporte,
+            src->getH264ProfilesSupported()) {
+            int intCastTemp = static_cast<int>(h264ProfilesSupporte);
+
+            Data::MediaConfig::Video::EncoderConfigs::Option::
+                H264ProfilesSupported enumCastTemp =
+                    static_cast<Data::MediaConfig::Video::EncoderConfigs::
+                                    Option::H264ProfilesSupported>(
+                        intCastTemp);
+
+            des.h264ProfilesSupported.append(enumCastTemp);
+        }
+        return des;
+    }
+
+    // options of every device of the same model and firmware are identical,
+    // they are kept once per process. Option only holds ints and implicitly
+    // shared QLists, so the copy each device keeps references the same lists
+    static QString sharedOptionKey(const Data::Information& _information) {
+        if (_information.model.isEmpty())
+            return QString();
+        return _information.manufacturer + "|" + _information.model + "|" +
+               _information.firmwareVersion + "|";
+    }
+
+    bool refreshVideoConfigsOptions() {
+        const QList<QString>& configTokens =
+            idata.mediaConfig.video.encodingConfigs.token;
+        QString keyPrefix = sharedOptionKey(idata.information);
+
+        QHash<QString, Option> options;
+        QStringList            missingTokens;
+        {
+            QMutexLocker locker(&isharedOptionsMutex);
+            foreach (QString token, configTokens) {
+                if (options.contains(token) || missingTokens.contains(token))
+                    continue;
+                if (!keyPrefix.isEmpty() &&
+                    isharedOptions.contains(keyPrefix + token))
+                    options.insert(
+                        token, isharedOptions.value(keyPrefix + token));
+                else
+                    missingTokens.append(token);
             }
-            idata.mediaConfig.video.encodingConfigs.options.append(des);
         }
 
-        return true;
+        // get video encoder options, all tokens at once
+        bool result = true;
+        if (!missingTokens.isEmpty()) {
+            QList<ONVIF::VideoEncoderConfigurationOptions*> fetched =
+                imediaManagement->getVideoEncoderConfigurationOptions(
+                    missingTokens);
+            QMutexLocker locker(&isharedOptionsMutex);
+            for (int i = 0; i < fetched.length(); i++) {
+                if (!fetched.at(i)) {
+                    result = false;
+                    continue;
+                }
+                QString token = missingTokens.at(i);
+                if (!keyPrefix.isEmpty()) {
+                    if (!isharedOptions.contains(keyPrefix + token))
+                        isharedOptions.insert(
+                            keyPrefix + token, toOption(fetched.at(i)));
+                    options.insert(
+                        token, isharedOptions.value(keyPrefix + token));
+                } else {
+                    options.insert(token, toOption(fetched.at(i)));
+                }
+            }
+            qDeleteAll(fetched);
+        }
+
+        // same order as the encoder tokens
+        auto& des = idata.mediaConfig.video.encodingConfigs.options;
+        des.clear();
+        foreach (QString token, configTokens)
+            des.append(options.value(token));
+        return result;
     }
 
     bool refreshAudioConfigs() {
@@ -458,7 +715,8 @@ public:
         if (!profiles)
             return false;
         {
-            auto& des = idata.profiles;
+            ONVIF::ApplyTrace apply;
+            auto&             des = idata.profiles;
 
             des.analytics           = profiles->m_analytics;
             des.toKenPro            = profiles->m_toKenPro;
@@ -531,157 +789,118 @@ public:
                 profiles->m_defaultContinuousZoomVelocitySpace;
         }
         return true;
-        // todo whats this other profiles (cameras never filled them in tests
-        // yet)
-        QScopedPointer<ONVIF::Profile> profile720p(
-            imediaManagement->getProfile720P());
-        if (!profile720p)
-            return false;
-        auto& des = idata.profile720p;
-
-        des.analytics           = profile720p->m_analytics;
-        des.toKenPro            = profile720p->m_toKenPro;
-        des.fixed               = profile720p->m_fixed;
-        des.namePro             = profile720p->m_namePro;
-        des.nameVsc             = profile720p->m_nameVsc;
-        des.useCountVsc         = profile720p->m_useCountVsc;
-        des.sourceTokenVsc      = profile720p->m_sourceTokenVsc;
-        des.boundsVsc           = profile720p->m_boundsVsc;
-        des.nameVec             = profile720p->m_nameVec;
-        des.useCountVec         = profile720p->m_useCountVec;
-        des.encodingVec         = profile720p->m_encodingVec;
-        des.widthVec            = profile720p->m_widthVec;
-        des.heightVec           = profile720p->m_heightVec;
-        des.qualityVec          = profile720p->m_qualityVec;
-        des.frameRateLimitVec   = profile720p->m_frameRateLimitVec;
-        des.encodingIntervalVec = profile720p->m_encodingIntervalVec;
-        des.bitrateLimitVec     = profile720p->m_bitrateLimitVec;
-        des.govLengthVec        = profile720p->m_govLengthVec;
-        des.h264ProfileVec      = profile720p->m_h264ProfileVec;
-        des.typeVec             = profile720p->m_typeVec;
-        des.ipv4AddressVec      = profile720p->m_ipv4AddressVec;
-        des.ipv6AddressVec      = profile720p->m_ipv6AddressVec;
-        des.portVec             = profile720p->m_portVec;
-        des.ttlVec              = profile720p->m_ttlVec;
-        des.autoStartVec        = profile720p->m_autoStartVec;
-        des.sessionTimeoutVec   = profile720p->m_sessionTimeoutVec;
-        des.namePtz             = profile720p->m_namePtz;
-        des.useCountPtz         = profile720p->m_useCountPtz;
-        des.nodeToken           = profile720p->m_nodeToken;
-        des.panTiltSpace        = profile720p->m_panTiltSpace;
-        des.panTiltX            = profile720p->m_panTiltX;
-        des.panTiltY            = profile720p->m_panTiltY;
-        des.zoomSpace           = profile720p->m_zoomSpace;
-        des.zoomX               = profile720p->m_zoomX;
-        des.defaultPTZTimeout   = profile720p->m_defaultPTZTimeout;
-        des.panTiltUri          = profile720p->m_panTiltUri;
-        des.xRangeMinPt         = profile720p->m_xRangeMinPt;
-        des.xRangeMaxPt         = profile720p->m_xRangeMaxPt;
-        des.yRangeMinPt         = profile720p->m_yRangeMinPt;
-        des.yRangeMaxPt         = profile720p->m_yRangeMaxPt;
-        des.zoomUri             = profile720p->m_zoomUri;
-        des.xRangeMinZm         = profile720p->m_xRangeMinZm;
-        des.xRangeMaxZm         = profile720p->m_xRangeMaxZm;
-        des.nameMc              = profile720p->m_nameMc;
-        des.useCountMc          = profile720p->m_useCountMc;
-        des.status              = profile720p->m_status;
-        des.position            = profile720p->m_position;
-        des.filter              = profile720p->m_filter;
-        des.subscriptionPolicy  = profile720p->m_subscriptionPolicy;
-        des.analytics           = profile720p->m_analytics;
-        des.typeMc              = profile720p->m_typeMc;
-        des.ipv4AddressMc       = profile720p->m_ipv4AddressMc;
-        des.ipv6AddressMc       = profile720p->m_ipv6AddressMc;
-        des.portMc              = profile720p->m_portMc;
-        des.ttlMc               = profile720p->m_ttlMc;
-        des.autoStartMc         = profile720p->m_autoStartMc;
-        des.sessionTimeoutMc    = profile720p->m_sessionTimeoutMc;
-        des.defaultAbsolutePantTiltPositionSpace =
-            profile720p->m_defaultAbsolutePantTiltPositionSpace;
-        des.defaultAbsoluteZoomPositionSpace =
-            profile720p->m_defaultAbsoluteZoomPositionSpace;
-        des.defaultRelativePantTiltTranslationSpace =
-            profile720p->m_defaultRelativePantTiltTranslationSpace;
-        des.defaultRelativeZoomTranslationSpace =
-            profile720p->m_defaultRelativeZoomTranslationSpace;
-        des.defaultContinuousPantTiltVelocitySpace =
-            profile720p->m_defaultContinuousPantTiltVelocitySpace;
-        des.defaultContinuousZoomVelocitySpace =
-            profile720p->m_defaultContinuousZoomVelocitySpace;
-
-        QScopedPointer<ONVIF::Profile> profileD1(
-            imediaManagement->getProfileD1());
-        if (!profileD1)
+    }
+
+    // replaces (or appends) the entry of one profile in the parallel lists.
+    // a list the profile has no entry in is left as it is
+    template <typename T>
+    static void
+    setProfileEntry(QList<T>& _des, int _index, const QList<T>& _src) {
+        if (_src.isEmpty())
+            return;
+        while (_des.length() < _index)
+            _des.append(T());
+        if (_index < _des.length())
+            _des[_index] = _src.value(0);
+        else
+            _des.append(_src.value(0));
+    }
+
+    bool refreshProfile(const QString& _token) {
+        QScopedPointer<ONVIF::Profile> profile(
+            imediaManagement->getProfile(_token));
+        if (!profile || profile->m_toKenPro.isEmpty())
             return false;
-        idata.profileD1.analytics           = profileD1->m_analytics;
-        idata.profileD1.toKenPro            = profileD1->m_toKenPro;
-        idata.profileD1.fixed               = profileD1->m_fixed;
-        idata.profileD1.namePro             = profileD1->m_namePro;
-        idata.profileD1.nameVsc             = profileD1->m_nameVsc;
-        idata.profileD1.useCountVsc         = profileD1->m_useCountVsc;
-        idata.profileD1.sourceTokenVsc      = profileD1->m_sourceTokenVsc;
-        idata.profileD1.boundsVsc           = profileD1->m_boundsVsc;
-        idata.profileD1.nameVec             = profileD1->m_nameVec;
-        idata.profileD1.useCountVec         = profileD1->m_useCountVec;
-        idata.profileD1.encodingVec         = profileD1->m_encodingVec;
-        idata.profileD1.widthVec            = profileD1->m_widthVec;
-        idata.profileD1.heightVec           = profileD1->m_heightVec;
-        idata.profileD1.qualityVec          = profileD1->m_qualityVec;
-        idata.profileD1.frameRateLimitVec   = profileD1->m_frameRateLimitVec;
-        idata.profileD1.encodingIntervalVec = profileD1->m_encodingIntervalVec;
-        idata.profileD1.bitrateLimitVec     = profileD1->m_bitrateLimitVec;
-        idata.profileD1.govLengthVec        = profileD1->m_govLengthVec;
-        idata.profileD1.h264ProfileVec      = profileD1->m_h264ProfileVec;
-        idata.profileD1.typeVec             = profileD1->m_typeVec;
-        idata.profileD1.ipv4AddressVec      = profileD1->m_ipv4AddressVec;
-        idata.profileD1.ipv6AddressVec      = profileD1->m_ipv6AddressVec;
-        idata.profileD1.portVec             = profileD1->m_portVec;
-        idata.profileD1.ttlVec              = profileD1->m_ttlVec;
-        idata.profileD1.autoStartVec        = profileD1->m_autoStartVec;
-        idata.profileD1.sessionTimeoutVec   = profileD1->m_sessionTimeoutVec;
-        idata.profileD1.namePtz             = profileD1->m_namePtz;
-        idata.profileD1.useCountPtz         = profileD1->m_useCountPtz;
-        idata.profileD1.nodeToken           = profileD1->m_nodeToken;
-        idata.profileD1.panTiltSpace        = profileD1->m_panTiltSpace;
-        idata.profileD1.panTiltX            = profileD1->m_panTiltX;
-        idata.profileD1.panTiltY            = profileD1->m_panTiltY;
-        idata.profileD1.zoomSpace           = profileD1->m_zoomSpace;
-        idata.profileD1.zoomX               = profileD1->m_zoomX;
-        idata.profileD1.defaultPTZTimeout   = profileD1->m_defaultPTZTimeout;
-        idata.profileD1.panTiltUri          = profileD1->m_panTiltUri;
-        idata.profileD1.xRangeMinPt         = profileD1->m_xRangeMinPt;
-        idata.profileD1.xRangeMaxPt         = profileD1->m_xRangeMaxPt;
-        idata.profileD1.yRangeMinPt         = profileD1->m_yRangeMinPt;
-        idata.profileD1.yRangeMaxPt         = profileD1->m_yRangeMaxPt;
-        idata.profileD1.zoomUri             = profileD1->m_zoomUri;
-        idata.profileD1.xRangeMinZm         = profileD1->m_xRangeMinZm;
-        idata.profileD1.xRangeMaxZm         = profileD1->m_xRangeMaxZm;
-        idata.profileD1.nameMc              = profileD1->m_nameMc;
-        idata.profileD1.useCountMc          = profileD1->m_useCountMc;
-        idata.profileD1.status              = profileD1->m_status;
-        idata.profileD1.position            = profileD1->m_position;
-        idata.profileD1.filter              = profileD1->m_filter;
-        idata.profileD1.subscriptionPolicy  = profileD1->m_subscriptionPolicy;
-        idata.profileD1.analytics           = profileD1->m_analytics;
-        idata.profileD1.typeMc              = profileD1->m_typeMc;
-        idata.profileD1.ipv4AddressMc       = profileD1->m_ipv4AddressMc;
-        idata.profileD1.ipv6AddressMc       = profileD1->m_ipv6AddressMc;
-        idata.profileD1.portMc              = profileD1->m_portMc;
-        idata.profileD1.ttlMc               = profileD1->m_ttlMc;
-        idata.profileD1.autoStartMc         = profileD1->m_autoStartMc;
-        idata.profileD1.sessionTimeoutMc    = profileD1->m_sessionTimeoutMc;
-        idata.profileD1.defaultAbsolutePantTiltPositionSpace =
-            profileD1->m_defaultAbsolutePantTiltPositionSpace;
-        idata.profileD1.defaultAbsoluteZoomPositionSpace =
-            profileD1->m_defaultAbsoluteZoomPositionSpace;
-        idata.profileD1.defaultRelativePantTiltTranslationSpace =
-            profileD1->m_defaultRelativePantTiltTranslationSpace;
-        idata.profileD1.defaultRelativeZoomTranslationSpace =
-            profileD1->m_defaultRelativeZoomTranslationSpace;
-        idata.profileD1.defaultContinuousPantTiltVelocitySpace =
-            profileD1->m_defaultContinuousPantTiltVelocitySpace;
-        idata.profileD1.defaultContinuousZoomVelocitySpace =
-            profileD1->m_defaultContinuousZoomVelocitySpace;
+
+        ONVIF::ApplyTrace apply;
+        auto&             des   = idata.profiles;
+        int   index = des.toKenPro.indexOf(_token);
+        if (index < 0)
+            index = des.toKenPro.length();
+
+        setProfileEntry(des.analytics, index, profile->m_analytics);
+        setProfileEntry(des.toKenPro, index, profile->m_toKenPro);
+        setProfileEntry(des.fixed, index, profile->m_fixed);
+        setProfileEntry(des.namePro, index, profile->m_namePro);
+        setProfileEntry(des.nameVsc, index, profile->m_nameVsc);
+        setProfileEntry(des.useCountVsc, index, profile->m_useCountVsc);
+        setProfileEntry(des.sourceTokenVsc, index, profile->m_sourceTokenVsc);
+        setProfileEntry(des.boundsVsc, index, profile->m_boundsVsc);
+        setProfileEntry(des.nameVec, index, profile->m_nameVec);
+        setProfileEntry(des.useCountVec, index, profile->m_useCountVec);
+        setProfileEntry(des.encodingVec, index, profile->m_encodingVec);
+        setProfileEntry(des.widthVec, index, profile->m_widthVec);
+        setProfileEntry(des.heightVec, index, profile->m_heightVec);
+        setProfileEntry(des.qualityVec, index, profile->m_qualityVec);
+        setProfileEntry(
+            des.frameRateLimitVec, index, profile->m_frameRateLimitVec);
+        setProfileEntry(
+            des.encodingIntervalVec, index, profile->m_encodingIntervalVec);
+        setProfileEntry(des.bitrateLimitVec, index, profile->m_bitrateLimitVec);
+        setProfileEntry(des.govLengthVec, index, profile->m_govLengthVec);
+        setProfileEntry(des.h264ProfileVec, index, profile->m_h264ProfileVec);
+        setProfileEntry(des.typeVec, index, profile->m_typeVec);
+        setProfileEntry(des.ipv4AddressVec, index, profile->m_ipv4AddressVec);
+        setProfileEntry(des.ipv6AddressVec, index, profile->m_ipv6AddressVec);
+        setProfileEntry(des.portVec, index, profile->m_portVec);
+        setProfileEntry(des.ttlVec, index, profile->m_ttlVec);
+        setProfileEntry(des.autoStartVec, index, profile->m_autoStartVec);
+        setProfileEntry(
+            des.sessionTimeoutVec, index, profile->m_sessionTimeoutVec);
+        setProfileEntry(des.namePtz, index, profile->m_namePtz);
+        setProfileEntry(des.useCountPtz, index, profile->m_useCountPtz);
+        setProfileEntry(des.nodeToken, index, profile->m_nodeToken);
+        // the default ptz speeds (panTilt*, zoom*) are only listed for the
+        // profiles that have one, by GetProfiles too: no index to replace
+        setProfileEntry(
+            des.defaultPTZTimeout, index, profile->m_defaultPTZTimeout);
+        setProfileEntry(des.panTiltUri, index, profile->m_panTiltUri);
+        setProfileEntry(des.xRangeMinPt, index, profile->m_xRangeMinPt);
+        setProfileEntry(des.xRangeMaxPt, index, profile->m_xRangeMaxPt);
+        setProfileEntry(des.yRangeMinPt, index, profile->m_yRangeMinPt);
+        setProfileEntry(des.yRangeMaxPt, index, profile->m_yRangeMaxPt);
+        setProfileEntry(des.zoomUri, index, profile->m_zoomUri);
+        setProfileEntry(des.xRangeMinZm, index, profile->m_xRangeMinZm);
+        setProfileEntry(des.xRangeMaxZm, index, profile->m_xRangeMaxZm);
+        setProfileEntry(des.nameMc, index, profile->m_nameMc);
+        setProfileEntry(des.useCountMc, index, profile->m_useCountMc);
+        setProfileEntry(des.status, index, profile->m_status);
+        setProfileEntry(des.position, index, profile->m_position);
+        setProfileEntry(des.filter, index, profile->m_filter);
+        setProfileEntry(
+            des.subscriptionPolicy, index, profile->m_subscriptionPolicy);
+        setProfileEntry(des.typeMc, index, profile->m_typeMc);
+        setProfileEntry(des.ipv4AddressMc, index, profile->m_ipv4AddressMc);
+        setProfileEntry(des.ipv6AddressMc, index, profile->m_ipv6AddressMc);
+        setProfileEntry(des.portMc, index, profile->m_portMc);
+        setProfileEntry(des.ttlMc, index, profile->m_ttlMc);
+        setProfileEntry(des.autoStartMc, index, profile->m_autoStartMc);
+        setProfileEntry(
+            des.sessionTimeoutMc, index, profile->m_sessionTimeoutMc);
+        setProfileEntry(
+            des.defaultAbsolutePantTiltPositionSpace,
+            index,
+            profile->m_defaultAbsolutePantTiltPositionSpace);
+        setProfileEntry(
+            des.defaultAbsoluteZoomPositionSpace,
+            index,
+            profile->m_defaultAbsoluteZoomPositionSpace);
+        setProfileEntry(
+            des.defaultRelativePantTiltTranslationSpace,
+            index,
+            profile->m_defaultRelativePantTiltTranslationSpace);
+        setProfileEntry(
+            des.defaultRelativeZoomTranslationSpace,
+            index,
+            profile->m_defaultRelativeZoomTranslationSpace);
+        setProfileEntry(
+            des.defaultContinuousPantTiltVelocitySpace,
+            index,
+            profile->m_defaultContinuousPantTiltVelocitySpace);
+        setProfileEntry(
+            des.defaultContinuousZoomVelocitySpace,
+            index,
+            profile->m_defaultContinuousZoomVelocitySpace);
         return true;
     }
 
@@ -691,7 +910,8 @@ public:
         if (!networkInterfaces)
             return false;
 
-        auto& des = idata.network.interfaces;
+        ONVIF::ApplyTrace apply;
+        auto&             des = idata.network.interfaces;
         auto& src = networkInterfaces;
 
         des.networkInfacesEnabled    = src->networkInfacesEnabled();
@@ -896,8 +1116,119 @@ public:
         delete stop;
         return true;
     }
+
+    // a step of interrogate() and the steps it needs done before it runs
+    struct InterrogationNode {
+        QOnvifDevice::InterrogationStep  step;
+        QOnvifDevice::InterrogationSteps dependsOn;
+        const char*                      operation;
+        bool (QOnvifDevicePrivate::*refresh)();
+    };
+    static const QList<InterrogationNode> iinterrogationGraph;
+
+    bool interrogate(
+        QOnvifDevice::InterrogationSteps _steps, int _maxParallel) {
+        QOnvifDevice::InterrogationSteps wanted = _steps;
+        for (bool grown = true; grown;) {
+            grown = false;
+            foreach (const InterrogationNode& node, iinterrogationGraph) {
+                if ((wanted & node.step) && (wanted & node.dependsOn) !=
+                                                node.dependsOn) {
+                    wanted |= node.dependsOn;
+                    grown = true;
+                }
+            }
+        }
+
+        // every step blocks in its own event loop until its replies are in.
+        // the steps are started from the event loop, so a step waiting for
+        // its replies lets the next ones send theirs: each level of the
+        // graph costs about one round trip
+        QEventLoop                       loop;
+        QOnvifDevice::InterrogationSteps started;
+        QOnvifDevice::InterrogationSteps finished;
+        int                              running = 0;
+        bool                             result  = true;
+        std::function<void()>            startReady;
+        startReady = [&]() {
+            foreach (const InterrogationNode& node, iinterrogationGraph) {
+                if (running >= qMax(1, _maxParallel))
+                    return;
+                if (!(wanted & node.step) || (started & node.step) ||
+                    (finished & node.dependsOn) != node.dependsOn)
+                    continue;
+                started |= node.step;
+                running++;
+                QTimer::singleShot(0, &loop, [&, node]() {
+                    // a failed step still lets the ones after it try
+                    if (!fresh(node.operation, node.refresh))
+                        result = false;
+                    running--;
+                    finished |= node.step;
+                    if (finished == wanted)
+                        loop.quit();
+                    else
+                        startReady();
+                });
+            }
+        };
+        startReady();
+        if (started)
+            loop.exec();
+        return result;
+    }
+};
+
+const QList<QOnvifDevicePrivate::InterrogationNode>
+    QOnvifDevicePrivate::iinterrogationGraph = {
+        {QOnvifDevice::Capabilities,
+         {},
+         "refreshDeviceCapabilities",
+         &QOnvifDevicePrivate::refreshDeviceCapabilities},
+        {QOnvifDevice::Information,
+         {},
+         "refreshDeviceInformation",
+         &QOnvifDevicePrivate::refreshDeviceInformation},
+        {QOnvifDevice::Scopes,
+         {},
+         "refreshDeviceScopes",
+         &QOnvifDevicePrivate::refreshDeviceScopes},
+        {QOnvifDevice::Users,
+         {},
+         "refreshUsers",
+         &QOnvifDevicePrivate::refreshUsers},
+        // media and ptz go to the XAddrs of the capabilities
+        {QOnvifDevice::Profiles,
+         QOnvifDevice::Capabilities,
+         "refreshProfiles",
+         &QOnvifDevicePrivate::refreshProfiles},
+        {QOnvifDevice::VideoConfigs,
+         QOnvifDevice::Capabilities,
+         "refreshVideoConfigs",
+         &QOnvifDevicePrivate::refreshVideoConfigs},
+        {QOnvifDevice::AudioConfigs,
+         QOnvifDevice::Capabilities,
+         "refreshAudioConfigs",
+         &QOnvifDevicePrivate::refreshAudioConfigs},
+        {QOnvifDevice::PtzConfiguration,
+         QOnvifDevice::Capabilities,
+         "refreshPtzConfiguration",
+         &QOnvifDevicePrivate::refreshPtzConfiguration},
+        {QOnvifDevice::StreamUris,
+         QOnvifDevice::Profiles,
+         "refreshStreamUris",
+         &QOnvifDevicePrivate::refreshStreamUris},
+        // the encoder tokens, and the model for the shared options cache
+        {QOnvifDevice::VideoConfigsOptions,
+         QOnvifDevice::VideoConfigs | QOnvifDevice::Information,
+         "refreshVideoConfigsOptions",
+         &QOnvifDevicePrivate::refreshVideoConfigsOptions},
 };
 
+QHash<QString, QOnvifDevicePrivate::Option>
+       QOnvifDevicePrivate::isharedOptions;
+QMutex QOnvifDevicePrivate::isharedOptionsMutex;
+
 // QOnvifDevice::QOnvifDevice() {}
 
 QOnvifDevice::QOnvifDevice(
@@ -915,6 +1246,41 @@ QOnvifDevice::data() {
     return d_ptr->idata;
 }
 
+void
+QOnvifDevice::setCredentials(QString _userName, QString _password) {
+    d_ptr->iuserName = _userName;
+    d_ptr->ipassword = _password;
+    d_ptr->ideviceManagement->setCredentials(_userName, _password);
+    d_ptr->imediaManagement->setCredentials(_userName, _password);
+    d_ptr->iptzManagement->setCredentials(_userName, _password);
+}
+
+QString
+QOnvifDevice::userName() const {
+    return d_ptr->iuserName;
+}
+
+QString
+QOnvifDevice::password() const {
+    return d_ptr->ipassword;
+}
+
+void
+QOnvifDevice::setTlsTrust(QStringList _pins, bool _trustAny) {
+    ONVIF::TlsTrust trust;
+    for (const QString& pin : _pins)
+        trust.pins.append(pin.toLatin1());
+    trust.trustAny = _trustAny;
+    d_ptr->ideviceManagement->setTlsTrust(trust);
+    d_ptr->imediaManagement->setTlsTrust(trust);
+    d_ptr->iptzManagement->setTlsTrust(trust);
+}
+
+QString
+QOnvifDevice::eventsAddress() const {
+    return d_ptr->routedAddress(d_ptr->idata.capabilities.eventsXAddress);
+}
+
 bool
 QOnvifDevice::deviceDateAndTime(Data::DateTime& _datetime) {
     return d_ptr->deviceDateAndTime(_datetime);
@@ -927,47 +1293,68 @@ QOnvifDevice::setDeviceProbeData(Data::ProbeData _probeData) {
 
 bool
 QOnvifDevice::setScopes(QString _name, QString _location) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setScopes(_name, _location);
 }
 
 bool
 QOnvifDevice::setVideoConfig(
     Data::MediaConfig::Video::EncoderConfig _videoConfig) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setVideoConfig(_videoConfig);
 }
 
+QNetworkReply*
+QOnvifDevice::postVideoConfig(
+    Data::MediaConfig::Video::EncoderConfig _videoConfig) {
+    d_ptr->irefreshedAt.clear();
+    return d_ptr->postVideoConfig(_videoConfig);
+}
+
+bool
+QOnvifDevice::videoConfigResult(QNetworkReply* _reply, QString* _error) {
+    return d_ptr->videoConfigResult(_reply, _error);
+}
+
 bool
 QOnvifDevice::setInterfaces(Data::Network::Interfaces _interfaces) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setInterfaces(_interfaces);
 }
 
 bool
 QOnvifDevice::setProtocols(Data::Network::Protocols _protocols) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setProtocols(_protocols);
 }
 
 bool
 QOnvifDevice::setDefaultGateway(Data::Network::DefaultGateway _defaultGateway) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setDefaultGateway(_defaultGateway);
 }
 
 bool
 QOnvifDevice::setDiscoveryMode(Data::Network::DiscoveryMode _discoveryMode) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setDiscoveryMode(_discoveryMode);
 }
 
 bool
 QOnvifDevice::setDNS(Data::Network::DNS _dns) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setDNS(_dns);
 }
 
 bool
 QOnvifDevice::setHostname(Data::Network::Hostname _hostname) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setHostname(_hostname);
 }
 
 bool
 QOnvifDevice::setNTP(Data::Network::NTP _ntp) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setNTP(_ntp);
 }
 bool
@@ -976,110 +1363,195 @@ QOnvifDevice::setDateAndTime(
     QString   _zone,
     bool      _daylightSaving,
     bool      _isLocal) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->setDeviceDateAndTime(
         _dateAndTime, _zone, _daylightSaving, _isLocal);
 }
 
+void
+QOnvifDevice::setFreshness(int _msecs) {
+    d_ptr->ifreshnessMsecs = _msecs;
+}
+
+void
+QOnvifDevice::setMaxRequestsInFlight(int _requests) {
+    d_ptr->ischeduler.setMaxInFlight(_requests);
+}
+
+void
+QOnvifDevice::setRetryPolicy(
+    int _maxAttempts, int _baseDelayMsecs, int _maxDelayMsecs) {
+    ONVIF::RetryPolicy policy;
+    policy.maxAttempts = qMax(1, _maxAttempts);
+    policy.baseDelayMs = _baseDelayMsecs;
+    policy.maxDelayMs  = _maxDelayMsecs;
+    d_ptr->ideviceManagement->setRetryPolicy(policy);
+    d_ptr->imediaManagement->setRetryPolicy(policy);
+    d_ptr->iptzManagement->setRetryPolicy(policy);
+}
+
+void
+QOnvifDevice::setCircuitBreaker(
+    int _failureThreshold, int _cooldownMsecs, int _maxCooldownMsecs) {
+    d_ptr->ibreaker.setFailureThreshold(_failureThreshold);
+    d_ptr->ibreaker.setCooldown(_cooldownMsecs, _maxCooldownMsecs);
+}
+
+QOnvifDevice::CircuitState
+QOnvifDevice::circuitState() const {
+    switch (d_ptr->ibreaker.state()) {
+    case ONVIF::CircuitBreaker::Open:
+        return CircuitOpen;
+    case ONVIF::CircuitBreaker::HalfOpen:
+        return CircuitHalfOpen;
+    default:
+        return CircuitClosed;
+    }
+}
+
+int
+QOnvifDevice::consecutiveFailures() const {
+    return d_ptr->ibreaker.consecutiveFailures();
+}
+
+qint64
+QOnvifDevice::circuitRetryInMsecs() const {
+    return d_ptr->ibreaker.retryInMsecs();
+}
+
+qint64
+QOnvifDevice::clockOffsetMsecs() const {
+    return d_ptr->iclockOffset.lastOffsetMsecs();
+}
+
+bool
+QOnvifDevice::interrogate(InterrogationSteps _steps, int _maxParallel) {
+    return d_ptr->interrogate(_steps, _maxParallel);
+}
+
 bool
 QOnvifDevice::refreshDeviceCapabilities() {
-    return d_ptr->refreshDeviceCapabilities();
+    return d_ptr->fresh(
+        "refreshDeviceCapabilities",
+        &QOnvifDevicePrivate::refreshDeviceCapabilities);
 }
 
 bool
 QOnvifDevice::refreshDeviceInformation() {
-    return d_ptr->refreshDeviceInformation();
+    return d_ptr->fresh(
+        "refreshDeviceInformation",
+        &QOnvifDevicePrivate::refreshDeviceInformation);
 }
 
 bool
 QOnvifDevice::refreshDeviceScopes() {
-    return d_ptr->refreshDeviceScopes();
+    return d_ptr->fresh(
+        "refreshDeviceScopes", &QOnvifDevicePrivate::refreshDeviceScopes);
 }
 
 bool
 QOnvifDevice::resetFactoryDevice(bool isHard) {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->resetFactoryDevice(isHard);
 }
 
 bool
 QOnvifDevice::rebootDevice() {
+    d_ptr->irefreshedAt.clear();
     return d_ptr->rebootDevice();
 }
 
 bool
 QOnvifDevice::refreshVideoConfigs() {
-    bool result = d_ptr->refreshVideoConfigs();
-    refreshVideoConfigsOptions();
-    return result;
+    return d_ptr->fresh(
+        "refreshVideoConfigs", &QOnvifDevicePrivate::refreshVideoConfigs);
 }
 
 bool
 QOnvifDevice::refreshVideoConfigsOptions() {
-    return d_ptr->refreshVideoConfigsOptions();
+    return d_ptr->fresh(
+        "refreshVideoConfigsOptions",
+        &QOnvifDevicePrivate::refreshVideoConfigsOptions);
 }
 
 bool
 QOnvifDevice::refreshStreamUris() {
-    return d_ptr->refreshStreamUris();
+    return d_ptr->fresh(
+        "refreshStreamUris", &QOnvifDevicePrivate::refreshStreamUris);
 }
 
 bool
 QOnvifDevice::refreshAudioConfigs() {
-    return d_ptr->refreshAudioConfigs();
+    return d_ptr->fresh(
+        "refreshAudioConfigs", &QOnvifDevicePrivate::refreshAudioConfigs);
 }
 
 bool
 QOnvifDevice::refreshProfiles() {
-    return d_ptr->refreshProfiles();
+    return d_ptr->fresh(
+        "refreshProfiles", &QOnvifDevicePrivate::refreshProfiles);
+}
+
+bool
+QOnvifDevice::refreshProfile(const QString& _token) {
+    return d_ptr->refreshProfile(_token);
 }
 
 bool
 QOnvifDevice::refreshInterfaces() {
-    return d_ptr->refreshInterfaces();
+    return d_ptr->fresh(
+        "refreshInterfaces", &QOnvifDevicePrivate::refreshInterfaces);
 }
 
 bool
 QOnvifDevice::refreshProtocols() {
-    return d_ptr->refreshProtocols();
+    return d_ptr->fresh(
+        "refreshProtocols", &QOnvifDevicePrivate::refreshProtocols);
 }
 
 bool
 QOnvifDevice::refreshDefaultGateway() {
-    return d_ptr->refreshDefaultGateway();
+    return d_ptr->fresh(
+        "refreshDefaultGateway", &QOnvifDevicePrivate::refreshDefaultGateway);
 }
 
 bool
 QOnvifDevice::refreshDiscoveryMode() {
-    return d_ptr->refreshDiscoveryMode();
+    return d_ptr->fresh(
+        "refreshDiscoveryMode", &QOnvifDevicePrivate::refreshDiscoveryMode);
 }
 
 bool
 QOnvifDevice::refreshDNS() {
-    return d_ptr->refreshDNS();
+    return d_ptr->fresh("refreshDNS", &QOnvifDevicePrivate::refreshDNS);
 }
 
 bool
 QOnvifDevice::refreshHostname() {
-    return d_ptr->refreshHostname();
+    return d_ptr->fresh(
+        "refreshHostname", &QOnvifDevicePrivate::refreshHostname);
 }
 
 bool
 QOnvifDevice::refreshNTP() {
-    return d_ptr->refreshNTP();
+    return d_ptr->fresh("refreshNTP", &QOnvifDevicePrivate::refreshNTP);
 }
 
 bool
 QOnvifDevice::refreshUsers() {
-    return d_ptr->refreshUsers();
+    return d_ptr->fresh("refreshUsers", &QOnvifDevicePrivate::refreshUsers);
 }
 
 bool
 QOnvifDevice::refreshPtzConfiguration() {
-    return d_ptr->refreshPtzConfiguration();
+    return d_ptr->fresh(
+        "refreshPtzConfiguration",
+        &QOnvifDevicePrivate::refreshPtzConfiguration);
 }
 
 bool
 QOnvifDevice::refreshPresets() {
-    return d_ptr->refreshPresets();
+    return d_ptr->fresh("refreshPresets", &QOnvifDevicePrivate::refreshPresets);
 }
 
 bool
@@ -1,23 +1,233 @@
 #include "qonvifmanager.hpp"
+#include "credentialvault.h"
 #include "devicemanagement.h"
 #include "devicesearcher.h"
+#include "devicesnapshot.h"
+#include "eventmultiplexer.h"
+#include "healthmonitor.h"
+#include "metrics.h"
+#include "requesttrace.h"
 #include "systemdateandtime.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QTimer>
 
 using namespace device;
 
+// one SetVideoEncoderConfiguration of applyVideoEncoderPolicy
+struct VideoEncoderJob {
+    // null once refreshDevicesList() deleted the device
+    QPointer<QOnvifDevice>                  device;
+    QString                                 vendor;
+    int                                     index;
+    Data::MediaConfig::Video::EncoderConfig config;
+    VideoEncoderPolicyResult                result;
+};
+
 class QOnvifManagerPrivate
 {
 public:
-    QOnvifManagerPrivate(const QString _username, const QString _password)
-        : iuserName(_username), ipassword(_password) {}
+    QOnvifManagerPrivate(const QString _username, const QString _password) {
+        icredentials.setDefault({_username, _password});
+    }
     ~QOnvifManagerPrivate() {}
 
     QScopedPointer<QOnvifManagerPrivate> d_ptr;
-    QString                              iuserName;
-    QString                              ipassword;
+    // default, per site and per device credentials. found devices with
+    // more than one candidate wait in ipendingDevices for their trial
+    ONVIF::CredentialVault         icredentials;
+    QMap<QString, Data::ProbeData> ipendingDevices;
     QMap<QString, QOnvifDevice*> idevicesMap;
     QHostAddress           ihostAddress;
     ONVIF::DeviceSearcher* ideviceSearcher;
+    QHash<QString, int>    ivendorRateLimits;
+    int                    ifreshnessMsecs       = 0;
+    int                    imaxRequestsPerDevice = 4;
+    // as QOnvifDevice::setRetryPolicy() and setCircuitBreaker()
+    int iretryAttempts = 3, iretryBaseMsecs = 200, iretryMaxMsecs = 5000;
+    int ifailureThreshold = 5, icooldownMsecs = 10000,
+        imaxCooldownMsecs = 300000;
+
+    // as QOnvifDevice::setTlsTrust(), by end point ("": the default)
+    QHash<QString, QPair<QStringList, bool>> itlsTrust;
+
+    // the settings of the manager on a new device
+    void configure(QOnvifDevice* _device, const QString& _endPoint) const {
+        _device->setFreshness(ifreshnessMsecs);
+        _device->setMaxRequestsInFlight(imaxRequestsPerDevice);
+        _device->setRetryPolicy(
+            iretryAttempts, iretryBaseMsecs, iretryMaxMsecs);
+        _device->setCircuitBreaker(
+            ifailureThreshold, icooldownMsecs, imaxCooldownMsecs);
+        QPair<QStringList, bool> trust =
+            itlsTrust.value(_endPoint, itlsTrust.value(QString()));
+        _device->setTlsTrust(trust.first, trust.second);
+    }
+
+    static ONVIF::TlsTrust tlsTrust(const QPair<QStringList, bool>& _trust) {
+        ONVIF::TlsTrust trust;
+        for (const QString& pin : _trust.first)
+            trust.pins.append(pin.toLatin1());
+        trust.trustAny = _trust.second;
+        return trust;
+    }
+
+    // pull point subscriptions of subscribeDeviceEvents(), by end point
+    ONVIF::EventMultiplexer ievents;
+
+    // (again) with the credentials and the tls trust the device has now
+    void subscribeEvents(QOnvifDevice* _device, const QString& _endPoint) {
+        ievents.subscribe(
+            _endPoint,
+            _device->eventsAddress(),
+            _device->data().probeData.deviceServiceAddress,
+            _device->userName(),
+            _device->password(),
+            tlsTrust(itlsTrust.value(_endPoint, itlsTrust.value(QString()))));
+    }
+
+    // liveness of the devices while startHealthMonitor() is in effect
+    ONVIF::HealthMonitor ihealthMonitor;
+    bool                 ihealthMonitoring = false;
+
+    // devices restored by loadSnapshot() and not revalidated yet, true once
+    // their probe answer showed they are stale
+    QMap<QString, bool> irevalidation;
+    QTimer              irevalidationTimer;
+    bool                irevalidating = false;
+    // restored devices that did not answer, asked again after a backoff
+    // that doubles up to kMaxRevalidationBackoffMs
+    QHash<QString, int>    irevalidationFailures;
+    QHash<QString, qint64> irevalidationDueAt; // msecs since the epoch
+    // probe answers of restored devices are awaited this long before they
+    // are asked for their information one at a time
+    static const int kRevalidationGraceMs      = 5000;
+    static const int kMaxRevalidationBackoffMs = 300000;
+
+    void clearRevalidation(const QString& _endPoint) {
+        irevalidation.remove(_endPoint);
+        irevalidationFailures.remove(_endPoint);
+        irevalidationDueAt.remove(_endPoint);
+    }
+
+
+    // ranges the camera reported as 0..0 are unknown and not checked
+    static bool inRange(int _value, int _min, int _max) {
+        if (_value < 0 || (_min == 0 && _max == 0))
+            return true;
+        return _value >= _min && _value <= _max;
+    }
+
+    static QString validatePolicy(
+        const VideoEncoderPolicy&                       _policy,
+        const Data::MediaConfig::Video::EncoderConfigs& _configs,
+        int                                             _index) {
+        if (_index >= _configs.options.length())
+            return "no cached encoder options";
+        const auto& option = _configs.options.at(_index);
+        if (option.qualityRangeMax <= 0 && option.bitRateRangeMax <= 0 &&
+            option.frameRateRangeMaxH264 <= 0 &&
+            option.frameRateRangeMaxJpeg <= 0)
+            return "no cached encoder options";
+
+        bool isH264 = _configs.encoding.value(_index) == "H264";
+        if (!inRange(
+                _policy.bitrateLimit,
+                option.bitRateRangeMin,
+                option.bitRateRangeMax))
+            return "bitrate limit out of range";
+        if (!inRange(
+                _policy.quality,
+                option.qualityRangeMin,
+                option.qualityRangeMax))
+            return "quality out of range";
+        if (isH264 && !inRange(
+                          _policy.govLength,
+                          option.govLengthRangeMin,
+                          option.govLengthRangeMax))
+            return "gov length out of range";
+        if (!inRange(
+                _policy.frameRateLimit,
+                isH264 ? option.frameRateRangeMinH264
+                       : option.frameRateRangeMinJpeg,
+                isH264 ? option.frameRateRangeMaxH264
+                       : option.frameRateRangeMaxJpeg))
+            return "frame rate limit out of range";
+        if (!inRange(
+                _policy.encodingInterval,
+                isH264 ? option.encodingIntervalRangeMinH264
+                       : option.encodingIntervalRangeMinJpeg,
+                isH264 ? option.encodingIntervalRangeMaxH264
+                       : option.encodingIntervalRangeMaxJpeg))
+            return "encoding interval out of range";
+        return QString();
+    }
+
+    static Data::MediaConfig::Video::EncoderConfig encoderConfig(
+        const Data::MediaConfig::Video::EncoderConfigs& _configs,
+        int                                             _index) {
+        Data::MediaConfig::Video::EncoderConfig des;
+        des.token            = _configs.token.value(_index);
+        des.name             = _configs.name.value(_index);
+        des.useCount         = _configs.useCount.value(_index);
+        des.encoding         = _configs.encoding.value(_index);
+        des.width            = _configs.width.value(_index);
+        des.height           = _configs.height.value(_index);
+        des.quality          = _configs.quality.value(_index);
+        des.frameRateLimit   = _configs.frameRateLimit.value(_index);
+        des.encodingInterval = _configs.encodingInterval.value(_index);
+        des.bitrateLimit     = _configs.bitrateLimit.value(_index);
+        des.govLength        = _configs.govLength.value(_index);
+        des.h264Profile      = _configs.h264Profile.value(_index);
+        des.type             = _configs.type.value(_index);
+        des.ipv4Address      = _configs.ipv4Address.value(_index);
+        des.ipv6Address      = _configs.ipv6Address.value(_index);
+        des.port             = _configs.port.value(_index);
+        des.ttl              = _configs.ttl.value(_index);
+        des.autoStart        = _configs.autoStart.value(_index);
+        des.sessionTimeout   = _configs.sessionTimeout.value(_index);
+        return des;
+    }
+
+    static void applyPolicy(
+        const VideoEncoderPolicy&                _policy,
+        Data::MediaConfig::Video::EncoderConfig& _config) {
+        if (_policy.bitrateLimit >= 0)
+            _config.bitrateLimit = _policy.bitrateLimit;
+        if (_policy.govLength >= 0 && _config.encoding == "H264")
+            _config.govLength = _policy.govLength;
+        if (_policy.frameRateLimit >= 0)
+            _config.frameRateLimit = _policy.frameRateLimit;
+        if (_policy.encodingInterval >= 0)
+            _config.encodingInterval = _policy.encodingInterval;
+        if (_policy.quality >= 0)
+            _config.quality = _policy.quality;
+    }
+
+    // keeps the device data in line with what the camera accepted
+    static void storeConfig(
+        const Data::MediaConfig::Video::EncoderConfig& _config,
+        Data::MediaConfig::Video::EncoderConfigs&      _configs,
+        int                                            _index) {
+        if (_index >= _configs.token.length())
+            return;
+        if (_index < _configs.bitrateLimit.length())
+            _configs.bitrateLimit[_index] = _config.bitrateLimit;
+        if (_index < _configs.govLength.length())
+            _configs.govLength[_index] = _config.govLength;
+        if (_index < _configs.frameRateLimit.length())
+            _configs.frameRateLimit[_index] = _config.frameRateLimit;
+        if (_index < _configs.encodingInterval.length())
+            _configs.encodingInterval[_index] = _config.encodingInterval;
+        if (_index < _configs.quality.length())
+            _configs.quality[_index] = _config.quality;
+    }
 };
 
 QOnvifManager::QOnvifManager(
@@ -40,6 +250,63 @@ QOnvifManager::QOnvifManager(
         d->ideviceSearcher,
         &ONVIF::DeviceSearcher::deviceSearchingEnded,
         [this]() { emit deviceSearchingEnded(); });
+
+    connect(
+        &d->irevalidationTimer, &QTimer::timeout, this, [this]() {
+            revalidateNext();
+        });
+    connect(
+        &d->ihealthMonitor,
+        &ONVIF::HealthMonitor::onlineChanged,
+        this,
+        [this](const QString& _endPoint, bool _online) {
+            QOnvifDevice* device = d_ptr->idevicesMap.value(_endPoint);
+            if (device != NULL)
+                emit deviceOnlineChanged(device, _online);
+        });
+    connect(
+        &d->ievents,
+        &ONVIF::EventMultiplexer::eventsReceived,
+        this,
+        [this](const QString& _endPoint, const QList<Data::Event>& _events) {
+            QOnvifDevice* device = d_ptr->idevicesMap.value(_endPoint);
+            if (device != NULL)
+                emit deviceEventsReceived(device, _events);
+        });
+    connect(
+        &d->ievents,
+        &ONVIF::EventMultiplexer::activeChanged,
+        this,
+        [this](const QString& _endPoint, bool _active) {
+            QOnvifDevice* device = d_ptr->idevicesMap.value(_endPoint);
+            if (device != NULL)
+                emit deviceEventsActiveChanged(device, _active);
+        });
+    connect(
+        &d->icredentials,
+        &ONVIF::CredentialVault::trialFinished,
+        this,
+        [this](
+            const QString&                            _endPoint,
+            const ONVIF::CredentialVault::Credential& _credential,
+            bool) {
+            QOnvifManagerPrivate* d      = d_ptr.data();
+            QOnvifDevice*         device = d->idevicesMap.value(_endPoint);
+            if (device != NULL) {
+                if (device->userName() != _credential.username ||
+                    device->password() != _credential.password) {
+                    device->setCredentials(
+                        _credential.username, _credential.password);
+                    if (d->ievents.contains(_endPoint))
+                        d->subscribeEvents(device, _endPoint);
+                }
+            } else if (d->ipendingDevices.contains(_endPoint)) {
+                addDevice(
+                    d->ipendingDevices.take(_endPoint),
+                    _credential.username,
+                    _credential.password);
+            }
+        });
     refreshDevicesList();
 }
 
@@ -50,10 +317,24 @@ QOnvifManager::refreshDevicesList() {
     Q_D(QOnvifManager);
     qDeleteAll(d->idevicesMap);
     d->idevicesMap.clear();
+    d->irevalidation.clear();
+    d->irevalidationFailures.clear();
+    d->irevalidationDueAt.clear();
+    d->irevalidationTimer.stop();
+    d->ihealthMonitor.clear();
+    d->ievents.clear();
+    d->icredentials.cancelTrials();
+    d->ipendingDevices.clear();
     d->ideviceSearcher->sendSearchMsg();
     return true;
 }
 
+void
+QOnvifManager::setDiscoveryTarget(QHostAddress _address, quint16 _port) {
+    Q_D(QOnvifManager);
+    d->ideviceSearcher->setProbeTarget(_address, _port);
+}
+
 bool
 QOnvifManager::refreshDeviceCapabilities(QString _deviceEndPointAddress) {
     if (!cameraExist(_deviceEndPointAddress))
@@ -110,6 +391,15 @@ QOnvifManager::refreshDeviceProfiles(QString _deviceEndPointAddress) {
     return d_ptr->idevicesMap.value(_deviceEndPointAddress)->refreshProfiles();
 }
 
+bool
+QOnvifManager::refreshDeviceProfile(
+    QString _deviceEndPointAddress, QString _profileToken) {
+    if (!cameraExist(_deviceEndPointAddress))
+        return false;
+    return d_ptr->idevicesMap.value(_deviceEndPointAddress)
+        ->refreshProfile(_profileToken);
+}
+
 bool
 QOnvifManager::refreshDeviceInterfaces(QString _deviceEndPointAddress) {
     if (!cameraExist(_deviceEndPointAddress))
@@ -209,9 +499,108 @@ QOnvifManager::cameraExist(const QString& endpoinAddress) {
 void
 QOnvifManager::setDefaulUsernameAndPassword(
     QString _username, QString _password) {
-    d_ptr->iuserName = _username;
-    d_ptr->ipassword = _password;
-    refreshDevicesList();
+    d_ptr->icredentials.setDefault({_username, _password});
+    applyCredentials();
+}
+
+void
+QOnvifManager::setDeviceCredentials(
+    QString _deviceEndPointAddress, QString _username, QString _password) {
+    Q_D(QOnvifManager);
+    d->icredentials.setDevice(_deviceEndPointAddress, {_username, _password});
+    if (d->ipendingDevices.contains(_deviceEndPointAddress))
+        addDevice(
+            d->ipendingDevices.take(_deviceEndPointAddress),
+            _username,
+            _password);
+    else
+        applyCredentials();
+}
+
+void
+QOnvifManager::removeDeviceCredentials(QString _deviceEndPointAddress) {
+    d_ptr->icredentials.removeDevice(_deviceEndPointAddress);
+    applyCredentials();
+}
+
+bool
+QOnvifManager::addSiteCredentials(
+    QString _site, QString _username, QString _password) {
+    if (!d_ptr->icredentials.addSite(_site, {_username, _password}))
+        return false;
+    applyCredentials();
+    return true;
+}
+
+void
+QOnvifManager::removeSiteCredentials(QString _site) {
+    d_ptr->icredentials.removeSite(_site);
+    applyCredentials();
+}
+
+void
+QOnvifManager::setMaxCredentialChecks(int _checks) {
+    d_ptr->icredentials.setMaxInFlight(_checks);
+}
+
+void
+QOnvifManager::setTlsTrust(QStringList _pins, bool _trustAny) {
+    Q_D(QOnvifManager);
+    d->itlsTrust.insert(QString(), qMakePair(_pins, _trustAny));
+    d->icredentials.setTlsTrust(
+        QOnvifManagerPrivate::tlsTrust(qMakePair(_pins, _trustAny)));
+    for (auto it = d->idevicesMap.constBegin();
+         it != d->idevicesMap.constEnd();
+         ++it) {
+        if (d->itlsTrust.contains(it.key()))
+            continue;
+        it.value()->setTlsTrust(_pins, _trustAny);
+        if (d->ievents.contains(it.key()))
+            d->subscribeEvents(it.value(), it.key());
+    }
+}
+
+void
+QOnvifManager::setDeviceTlsTrust(
+    QString _deviceEndPointAddress, QStringList _pins, bool _trustAny) {
+    Q_D(QOnvifManager);
+    d->itlsTrust.insert(_deviceEndPointAddress, qMakePair(_pins, _trustAny));
+    QOnvifDevice* device = d->idevicesMap.value(_deviceEndPointAddress);
+    if (device == NULL)
+        return;
+    device->setTlsTrust(_pins, _trustAny);
+    if (d->ievents.contains(_deviceEndPointAddress))
+        d->subscribeEvents(device, _deviceEndPointAddress);
+}
+
+void
+QOnvifManager::applyCredentials() {
+    Q_D(QOnvifManager);
+    for (auto it = d->idevicesMap.constBegin();
+         it != d->idevicesMap.constEnd();
+         ++it) {
+        QString serviceAddress =
+            it.value()->data().probeData.deviceServiceAddress;
+        QList<ONVIF::CredentialVault::Credential> candidates =
+            d->icredentials.candidates(it.key(), serviceAddress);
+        if (candidates.size() > 1 && !d->icredentials.isSettled(it.key())) {
+            d->icredentials.startTrial(it.key(), serviceAddress);
+            continue;
+        }
+        // only the devices whose credentials changed are touched
+        QOnvifDevice* device = it.value();
+        if (device->userName() == candidates.first().username &&
+            device->password() == candidates.first().password)
+            continue;
+        device->setCredentials(
+            candidates.first().username, candidates.first().password);
+        if (d->ievents.contains(it.key()))
+            d->subscribeEvents(device, it.key());
+    }
+    for (auto it = d->ipendingDevices.constBegin();
+         it != d->ipendingDevices.constEnd();
+         ++it)
+        d->icredentials.startTrial(it.key(), it->deviceServiceAddress);
 }
 
 bool
@@ -229,6 +618,162 @@ QOnvifManager::setDeviceVideoConfig(
         ->setVideoConfig(_videoConfig);
 }
 
+VideoEncoderPolicyReport
+QOnvifManager::applyVideoEncoderPolicy(
+    const VideoEncoderPolicy& _policy,
+    DeviceSelector            _selector,
+    int                       _maxConcurrent) {
+    Q_D(QOnvifManager);
+    int maxConcurrent = qMax(1, _maxConcurrent);
+
+    VideoEncoderPolicyReport                 report;
+    QHash<QString, QQueue<VideoEncoderJob>> pending; // by vendor
+    QStringList                              vendors; // with pending jobs
+
+    foreach (QOnvifDevice* device, d->idevicesMap) {
+        if (_selector && !_selector(device))
+            continue;
+        const auto& configs = device->data().mediaConfig.video.encodingConfigs;
+        for (int i = 0; i < configs.token.length(); i++) {
+            if (!_policy.encoding.isEmpty() &&
+                configs.encoding.value(i) != _policy.encoding)
+                continue;
+            VideoEncoderJob job;
+            job.device = device;
+            job.vendor = device->data().information.manufacturer.toLower();
+            job.index  = i;
+            job.result.endPointAddress =
+                device->data().probeData.endPointAddress;
+            job.result.configToken = configs.token.at(i);
+            job.result.reason =
+                QOnvifManagerPrivate::validatePolicy(_policy, configs, i);
+            if (!job.result.reason.isEmpty()) {
+                job.result.status = VideoEncoderPolicyResult::Rejected;
+                report.append(job.result);
+                continue;
+            }
+            job.config = QOnvifManagerPrivate::encoderConfig(configs, i);
+            QOnvifManagerPrivate::applyPolicy(_policy, job.config);
+            if (!pending.contains(job.vendor))
+                vendors.append(job.vendor);
+            pending[job.vendor].enqueue(job);
+        }
+    }
+
+    QEventLoop             loop;
+    QTimer                 timer;
+    QElapsedTimer          clock;
+    int                    inFlight = 0;
+    QHash<QString, qint64> vendorNextStart; // usecs of clock
+    std::function<void()>  pump;
+    timer.setSingleShot(true);
+    clock.start();
+    connect(&timer, &QTimer::timeout, &loop, [&pump]() { pump(); });
+
+    auto finish = [&](VideoEncoderJob _job, bool _applied, QString _error) {
+        _job.result.status = _applied ? VideoEncoderPolicyResult::Applied
+                                      : VideoEncoderPolicyResult::Failed;
+        if (_applied && !_job.device.isNull())
+            QOnvifManagerPrivate::storeConfig(
+                _job.config,
+                _job.device->data().mediaConfig.video.encodingConfigs,
+                _job.index);
+        else
+            _job.result.reason = _error;
+        report.append(_job.result);
+    };
+
+    // starts what the concurrency and vendor limits allow, one job of each
+    // vendor in turn, and wakes up again when the next rate limited vendor
+    // is allowed to send. a pass costs the vendors with pending jobs, not
+    // the jobs
+    pump = [&]() {
+        qint64 now     = clock.nsecsElapsed() / 1000;
+        qint64 wakeUp  = -1;
+        bool   started = true;
+        while (started && inFlight < maxConcurrent) {
+            started = false;
+            for (int i = 0; i < vendors.length() &&
+                            inFlight < maxConcurrent;) {
+                QString vendor = vendors.at(i);
+                int     rate   = d->ivendorRateLimits.value(vendor, 0);
+                if (rate > 0) {
+                    qint64 next = vendorNextStart.value(vendor, 0);
+                    if (next > now) {
+                        wakeUp = wakeUp < 0 ? next : qMin(wakeUp, next);
+                        i++;
+                        continue;
+                    }
+                    vendorNextStart.insert(
+                        vendor, now + qMax<qint64>(1, 1000000 / rate));
+                }
+
+                QQueue<VideoEncoderJob>& queue = pending[vendor];
+                VideoEncoderJob          job   = queue.dequeue();
+                if (queue.isEmpty()) {
+                    pending.remove(vendor);
+                    vendors.removeAt(i);
+                } else {
+                    i++;
+                }
+                started = true;
+
+                if (job.device.isNull()) {
+                    finish(job, false, "device removed");
+                    continue;
+                }
+                QNetworkReply* reply = job.device->postVideoConfig(job.config);
+                if (reply == NULL) {
+                    finish(job, false, "request not sent");
+                    continue;
+                }
+                inFlight++;
+                QSharedPointer<bool> settled(new bool(false));
+                connect(
+                    reply,
+                    &QNetworkReply::finished,
+                    &loop,
+                    [&, job, reply, settled]() {
+                        *settled = true;
+                        inFlight--;
+                        QString error;
+                        bool    applied =
+                            job.device->videoConfigResult(reply, &error);
+                        finish(job, applied, error);
+                        pump();
+                    });
+                // the reply goes without finishing with the network manager
+                // of a deleted device. the pump runs once the device is gone
+                connect(reply, &QObject::destroyed, &loop, [&, job, settled]() {
+                    if (*settled)
+                        return;
+                    *settled = true;
+                    inFlight--;
+                    finish(job, false, "device removed");
+                    QTimer::singleShot(0, &loop, [&pump]() { pump(); });
+                });
+            }
+        }
+
+        if (pending.isEmpty() && inFlight == 0)
+            loop.quit();
+        else if (wakeUp > 0 && inFlight < maxConcurrent && !timer.isActive())
+            timer.start(int(qMax<qint64>(1, (wakeUp - now + 999) / 1000)));
+    };
+
+    pump();
+    if (!pending.isEmpty() || inFlight > 0)
+        loop.exec();
+    return report;
+}
+
+void
+QOnvifManager::setVendorRateLimit(
+    QString _manufacturer, int _requestsPerSecond) {
+    Q_D(QOnvifManager);
+    d->ivendorRateLimits.insert(_manufacturer.toLower(), _requestsPerSecond);
+}
+
 bool
 QOnvifManager::setDeviceNetworkInterfaces(
     QString _deviceEndPointAddress, Data::Network::Interfaces _interfaces) {
@@ -311,24 +856,349 @@ QOnvifManager::stopMovement(QString _deviceEndPointAddress) {
 }
 
 void
-QOnvifManager::onReciveData(QHash<QString, QString> _deviceHash) {
+QOnvifManager::setRefreshFreshness(int _msecs) {
     Q_D(QOnvifManager);
+    d->ifreshnessMsecs = _msecs;
+    foreach (QOnvifDevice* device, d->idevicesMap)
+        device->setFreshness(_msecs);
+}
 
-    Data::ProbeData probeData;
-    probeData.endPointAddress = _deviceHash.value("ep_address");
+void
+QOnvifManager::setMaxRequestsPerDevice(int _requests) {
+    Q_D(QOnvifManager);
+    d->imaxRequestsPerDevice = _requests;
+    foreach (QOnvifDevice* device, d->idevicesMap)
+        device->setMaxRequestsInFlight(_requests);
+}
+
+void
+QOnvifManager::setRetryPolicy(
+    int _maxAttempts, int _baseDelayMsecs, int _maxDelayMsecs) {
+    Q_D(QOnvifManager);
+    d->iretryAttempts  = _maxAttempts;
+    d->iretryBaseMsecs = _baseDelayMsecs;
+    d->iretryMaxMsecs  = _maxDelayMsecs;
+    foreach (QOnvifDevice* device, d->idevicesMap)
+        device->setRetryPolicy(_maxAttempts, _baseDelayMsecs, _maxDelayMsecs);
+}
+
+void
+QOnvifManager::setCircuitBreaker(
+    int _failureThreshold, int _cooldownMsecs, int _maxCooldownMsecs) {
+    Q_D(QOnvifManager);
+    d->ifailureThreshold = _failureThreshold;
+    d->icooldownMsecs    = _cooldownMsecs;
+    d->imaxCooldownMsecs = _maxCooldownMsecs;
+    foreach (QOnvifDevice* device, d->idevicesMap)
+        device->setCircuitBreaker(
+            _failureThreshold, _cooldownMsecs, _maxCooldownMsecs);
+}
+
+void
+QOnvifManager::startHealthMonitor(int _intervalMsecs, bool _tcpProbe) {
+    Q_D(QOnvifManager);
+    d->ihealthMonitor.setInterval(_intervalMsecs);
+    d->ihealthMonitor.setMaxInterval(qMax(_intervalMsecs, 300000));
+    d->ihealthMonitor.setProbeKind(
+        _tcpProbe ? ONVIF::HealthMonitor::TcpProbe
+                  : ONVIF::HealthMonitor::SoapProbe);
+    d->ihealthMonitoring = true;
+    QMapIterator<QString, QOnvifDevice*> it(d->idevicesMap);
+    while (it.hasNext()) {
+        it.next();
+        d->ihealthMonitor.addDevice(
+            it.key(), it.value()->data().probeData.deviceServiceAddress);
+    }
+}
+
+void
+QOnvifManager::stopHealthMonitor() {
+    Q_D(QOnvifManager);
+    d->ihealthMonitoring = false;
+    d->ihealthMonitor.clear();
+}
+
+bool
+QOnvifManager::isDeviceOnline(QString _deviceEndPointAddress) const {
+    return d_ptr->ihealthMonitor.isOnline(_deviceEndPointAddress);
+}
+
+void
+QOnvifManager::setRequestTracing(bool _enabled) {
+    ONVIF::RequestTrace::setEnabled(_enabled);
+}
+
+bool
+QOnvifManager::saveRequestTrace(QString _fileName) {
+    QFile file(_fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QByteArray trace = _fileName.endsWith(".json", Qt::CaseInsensitive)
+                           ? ONVIF::RequestTrace::toChromeTrace()
+                           : ONVIF::RequestTrace::toCsv();
+    return file.write(trace) == trace.size();
+}
+
+MetricsSnapshot
+QOnvifManager::metrics() const {
+    return ONVIF::Metrics::snapshot();
+}
+
+bool
+QOnvifManager::saveMetrics(QString _fileName) {
+    // written aside and renamed so a scraper never reads a partial file
+    QString temporary = _fileName + ".tmp";
+    QFile   file(temporary);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QByteArray text    = ONVIF::Metrics::toPrometheus();
+    bool       written = file.write(text) == text.size();
+    file.close();
+    QFile::remove(_fileName);
+    return written && QFile::rename(temporary, _fileName);
+}
+
+bool
+QOnvifManager::saveSnapshot(QString _fileName) {
+    Q_D(QOnvifManager);
+    QList<Data> devices;
+    for (QOnvifDevice* device : d->idevicesMap)
+        devices.append(device->data());
+    return ONVIF::DeviceSnapshot::save(_fileName, devices);
+}
+
+bool
+QOnvifManager::loadSnapshot(QString _fileName) {
+    Q_D(QOnvifManager);
+    QList<Data> devices;
+    if (!ONVIF::DeviceSnapshot::load(_fileName, devices))
+        return false;
+
+    for (const Data& data : devices) {
+        const Data::ProbeData& saved = data.probeData;
+        if (saved.endPointAddress.isEmpty())
+            continue;
+
+        QOnvifDevice* device = d->idevicesMap.value(saved.endPointAddress);
+        if (device) {
+            // it answered the probe already, what it said is kept
+            Data::ProbeData probeData = device->data().probeData;
+            if (probeData.deviceServiceAddress != saved.deviceServiceAddress)
+                continue;
+            device->data() = data;
+            device->setDeviceProbeData(probeData);
+            if (probeData.metadataVersion == saved.metadataVersion)
+                emit deviceRevalidated(device, false);
+            else
+                d->irevalidation.insert(saved.endPointAddress, true);
+            continue;
+        }
+
+        // the credential of a restored device is checked with its trial
+        QList<ONVIF::CredentialVault::Credential> candidates =
+            d->icredentials.candidates(
+                saved.endPointAddress, saved.deviceServiceAddress);
+        device = new QOnvifDevice(
+            saved.deviceServiceAddress,
+            candidates.first().username,
+            candidates.first().password,
+            this);
+        d->configure(device, saved.endPointAddress);
+        device->data() = data;
+        if (candidates.size() > 1 &&
+            !d->icredentials.isSettled(saved.endPointAddress))
+            d->icredentials.startTrial(
+                saved.endPointAddress, saved.deviceServiceAddress);
+        d->idevicesMap.insert(saved.endPointAddress, device);
+        if (d->ihealthMonitoring)
+            d->ihealthMonitor.addDevice(
+                saved.endPointAddress, saved.deviceServiceAddress);
+        d->irevalidation.insert(saved.endPointAddress, false);
+        emit newDeviceFinded(device);
+    }
+
+    if (!d->irevalidation.isEmpty() && !d->irevalidationTimer.isActive())
+        d->irevalidationTimer.start(QOnvifManagerPrivate::kRevalidationGraceMs);
+    return true;
+}
+
+bool
+QOnvifManager::subscribeDeviceEvents(QString _deviceEndPointAddress) {
+    Q_D(QOnvifManager);
+    QOnvifDevice* device = d->idevicesMap.value(_deviceEndPointAddress);
+    if (device == NULL)
+        return false;
+    if (device->eventsAddress().isEmpty())
+        device->refreshDeviceCapabilities();
+    if (device->eventsAddress().isEmpty())
+        return false;
+    d->subscribeEvents(device, _deviceEndPointAddress);
+    return true;
+}
 
-    if (d->idevicesMap.contains(probeData.endPointAddress))
+void
+QOnvifManager::unsubscribeDeviceEvents(QString _deviceEndPointAddress) {
+    d_ptr->ievents.unsubscribe(_deviceEndPointAddress);
+}
+
+void
+QOnvifManager::setEventPulling(int _pullTimeoutSecs, int _messageLimit) {
+    d_ptr->ievents.setPull(_pullTimeoutSecs, _messageLimit);
+}
+
+void
+QOnvifManager::revalidateNext() {
+    Q_D(QOnvifManager);
+    // the requests below run a nested event loop
+    if (d->irevalidating)
+        return;
+    if (d->irevalidation.isEmpty()) {
+        d->irevalidationTimer.stop();
+        return;
+    }
+
+    // the first one not waiting for its backoff, or a wake up when that
+    // ends for the earliest
+    qint64  now = QDateTime::currentMSecsSinceEpoch();
+    qint64  due = -1;
+    QString endPointAddress;
+    for (auto it = d->irevalidation.constBegin();
+         it != d->irevalidation.constEnd();
+         ++it) {
+        qint64 dueAt = d->irevalidationDueAt.value(it.key(), 0);
+        if (dueAt <= now) {
+            endPointAddress = it.key();
+            break;
+        }
+        due = due < 0 ? dueAt : qMin(due, dueAt);
+    }
+    if (endPointAddress.isEmpty()) {
+        d->irevalidationTimer.setInterval(int(due - now));
+        return;
+    }
+    d->irevalidationTimer.setInterval(0);
+
+    bool                   stale  = d->irevalidation.take(endPointAddress);
+    QPointer<QOnvifDevice> device = d->idevicesMap.value(endPointAddress);
+    if (!device) {
+        d->clearRevalidation(endPointAddress);
         return;
+    }
 
-    probeData.types    = _deviceHash.value("types");
-    probeData.deviceIp = _deviceHash.value("device_ip");
+    // refreshDevicesList() may delete the device in the nested loops
+    d->irevalidating = true;
+    if (!stale) {
+        // no probe answer: GetDeviceInformation tells whether it is still
+        // the same camera with the same firmware
+        Data::Information saved = device->data().information;
+        device->refreshDeviceInformation();
+        if (!device) {
+            d->irevalidating = false;
+            return;
+        }
+        Data::Information& current = device->data().information;
+        if (current.serialNumber.isEmpty() && current.model.isEmpty()) {
+            // not reachable now, the snapshot is all there is until it
+            // answers a later attempt
+            current          = saved;
+            d->irevalidating = false;
+            if (d->irevalidation.contains(endPointAddress))
+                return; // its probe answer came meanwhile
+            int    failures = ++d->irevalidationFailures[endPointAddress];
+            qint64 backoff  = qMin<qint64>(
+                qint64(QOnvifManagerPrivate::kRevalidationGraceMs)
+                    << qMin(failures - 1, 16),
+                QOnvifManagerPrivate::kMaxRevalidationBackoffMs);
+            d->irevalidation.insert(endPointAddress, false);
+            d->irevalidationDueAt.insert(endPointAddress, now + backoff);
+            return;
+        }
+        stale = current.serialNumber != saved.serialNumber ||
+                current.model != saved.model ||
+                current.firmwareVersion != saved.firmwareVersion;
+    }
+    d->irevalidationFailures.remove(endPointAddress);
+    d->irevalidationDueAt.remove(endPointAddress);
+    if (stale)
+        device->interrogate();
+    d->irevalidating = false;
+    if (device)
+        emit deviceRevalidated(device, stale);
+}
+
+void
+QOnvifManager::onReciveData(QHash<QString, QString> _deviceHash) {
+    Q_D(QOnvifManager);
+
+    Data::ProbeData probeData;
+    probeData.endPointAddress = _deviceHash.value("ep_address");
+    probeData.types           = _deviceHash.value("types");
+    probeData.deviceIp        = _deviceHash.value("device_ip");
     probeData.deviceServiceAddress =
         _deviceHash.value("device_service_address");
     probeData.scopes          = _deviceHash.value("scopes");
     probeData.metadataVersion = _deviceHash.value("metadata_version");
-    QOnvifDevice* device      = new QOnvifDevice(
-        probeData.deviceServiceAddress, d->iuserName, d->ipassword, this);
-    device->setDeviceProbeData(probeData);
-    d->idevicesMap.insert(probeData.endPointAddress, device);
+
+    QOnvifDevice* known = d->idevicesMap.value(probeData.endPointAddress);
+    if (known) {
+        if (!d->irevalidation.contains(probeData.endPointAddress))
+            return;
+        // restored from a snapshot: the same MetadataVersion at the same
+        // address means nothing changed since it was saved
+        const Data::ProbeData& saved = known->data().probeData;
+        if (saved.deviceServiceAddress == probeData.deviceServiceAddress) {
+            bool stale = saved.metadataVersion != probeData.metadataVersion;
+            known->setDeviceProbeData(probeData);
+            if (stale) {
+                // reachable now, no backoff
+                d->clearRevalidation(probeData.endPointAddress);
+                d->irevalidation.insert(probeData.endPointAddress, true);
+                d->irevalidationTimer.setInterval(0);
+            } else {
+                d->clearRevalidation(probeData.endPointAddress);
+                emit deviceRevalidated(known, false);
+            }
+            return;
+        }
+        // moved to another address, found again as a new device
+        d->clearRevalidation(probeData.endPointAddress);
+        d->ievents.unsubscribe(probeData.endPointAddress);
+        d->idevicesMap.remove(probeData.endPointAddress);
+        known->deleteLater();
+    }
+
+    // with several candidate credentials the device is added once the
+    // first one was accepted
+    auto pending = d->ipendingDevices.constFind(probeData.endPointAddress);
+    if (pending != d->ipendingDevices.constEnd() &&
+        pending->deviceServiceAddress == probeData.deviceServiceAddress)
+        return; // found again while its trial runs
+    QList<ONVIF::CredentialVault::Credential> candidates =
+        d->icredentials.candidates(
+            probeData.endPointAddress, probeData.deviceServiceAddress);
+    if (candidates.size() > 1 &&
+        !d->icredentials.isSettled(probeData.endPointAddress)) {
+        d->ipendingDevices.insert(probeData.endPointAddress, probeData);
+        d->icredentials.startTrial(
+            probeData.endPointAddress, probeData.deviceServiceAddress);
+        return;
+    }
+    addDevice(
+        probeData, candidates.first().username, candidates.first().password);
+}
+
+void
+QOnvifManager::addDevice(
+    Data::ProbeData _probeData, QString _username, QString _password) {
+    Q_D(QOnvifManager);
+    QOnvifDevice* device = new QOnvifDevice(
+        _probeData.deviceServiceAddress, _username, _password, this);
+    d->configure(device, _probeData.endPointAddress);
+    device->setDeviceProbeData(_probeData);
+    d->idevicesMap.insert(_probeData.endPointAddress, device);
+    if (d->ihealthMonitoring)
+        d->ihealthMonitor.addDevice(
+            _probeData.endPointAddress, _probeData.deviceServiceAddress);
+    ONVIF::Metrics::discoveredDevice();
     emit newDeviceFinded(device);
 }
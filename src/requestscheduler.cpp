@@ -0,0 +1,111 @@
+#include "requestscheduler.h"
+#include <QEventLoop>
+#include <QNetworkReply>
+
+using namespace ONVIF;
+
+RequestScheduler::RequestScheduler(QObject* _parent)
+    : QObject(_parent), mMaxInFlight(4), mInFlight(0) {}
+
+RequestScheduler::~RequestScheduler() {
+    // nobody is left to release a slot, let every waiter go
+    for (int p = 0; p < PriorityCount; p++) {
+        foreach (Waiter* waiter, mQueues[p]) {
+            waiter->abandoned = true;
+            waiter->loop->quit();
+        }
+        mQueues[p].clear();
+    }
+}
+
+RequestScheduler::Priority
+RequestScheduler::classify(const QString& _service, const QString& _operation) {
+    if (_operation.startsWith("Get"))
+        return Inventory;
+    if (_service == "Ptz" &&
+        (_operation.endsWith("Move") || _operation == "Stop" ||
+         _operation.startsWith("Goto")))
+        return Interactive;
+    return Control;
+}
+
+int
+RequestScheduler::maxInFlight() const {
+    return mMaxInFlight;
+}
+
+void
+RequestScheduler::setMaxInFlight(int _requests) {
+    mMaxInFlight = qMax(1, _requests);
+    wakeWaiters();
+}
+
+int
+RequestScheduler::inFlight() const {
+    return mInFlight;
+}
+
+int
+RequestScheduler::queued(Priority _priority) const {
+    return mQueues[_priority].size();
+}
+
+void
+RequestScheduler::acquire(Priority _priority) {
+    // a waiter queued before is below this frame and can not go first
+    if (admits(_priority)) {
+        mInFlight++;
+        return;
+    }
+
+    QEventLoop loop;
+    Waiter     waiter = {&loop, false};
+    mQueues[_priority].append(&waiter);
+    // exec() returns once this frame runs again after a wake up, the slot
+    // may have been taken by a frame above it meanwhile
+    forever {
+        loop.exec();
+        if (waiter.abandoned)
+            return;
+        if (admits(_priority))
+            break;
+    }
+    mQueues[_priority].removeOne(&waiter);
+    mInFlight++;
+}
+
+void
+RequestScheduler::release() {
+    if (mInFlight > 0)
+        mInFlight--;
+    wakeWaiters();
+}
+
+void
+RequestScheduler::releaseOn(QNetworkReply* _reply) {
+    if (_reply == NULL || _reply->isFinished()) {
+        release();
+        return;
+    }
+    connect(
+        _reply, &QNetworkReply::finished, this, &RequestScheduler::release);
+}
+
+bool
+RequestScheduler::admits(Priority _priority) const {
+    // inventory leaves the last slot to the other classes
+    int limit = mMaxInFlight;
+    if (_priority == Inventory && limit > 1)
+        limit--;
+    return mInFlight < limit;
+}
+
+void
+RequestScheduler::wakeWaiters() {
+    for (int p = 0; p < PriorityCount; p++) {
+        if (!admits(Priority(p)))
+            continue;
+        foreach (Waiter* waiter, mQueues[p])
+            waiter->loop->quit();
+    }
+}
@@ -0,0 +1,290 @@
+#include "requesttrace.h"
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QStringList>
+
+using namespace ONVIF;
+
+namespace {
+struct Watched {
+    TraceSpan span;
+    qint64    sentUsecs     = -1;
+    qint64    headersUsecs  = -1;
+    qint64    finishedUsecs = -1;
+};
+
+QAtomicInt                     gEnabled(0);
+QMutex                         gMutex;
+int                            gCapacity = 10000;
+QList<TraceSpan>               gSpans;
+QList<quint64>                 gSpanIds; // of gSpans, in the same order
+quint64                        gLastSpanId = 0;
+QHash<QNetworkReply*, Watched> gWatched;
+// the span the thread recorded last
+thread_local quint64 tLastRecorded = 0;
+
+QElapsedTimer&
+traceClock() {
+    static QElapsedTimer timer;
+    if (!timer.isValid())
+        timer.start();
+    return timer;
+}
+
+qint64
+since(qint64 _from, qint64 _to) {
+    return (_from < 0 || _to < 0) ? -1 : _to - _from;
+}
+
+// adds a phase event, phases that were not seen are left out
+void
+appendPhase(
+    QJsonArray& _events,
+    const char* _name,
+    qint64      _start,
+    qint64      _duration,
+    int         _tid) {
+    if (_start < 0 || _duration < 0)
+        return;
+    QJsonObject event;
+    event.insert("name", _name);
+    event.insert("cat", "phase");
+    event.insert("ph", "X");
+    event.insert("ts", double(_start));
+    event.insert("dur", double(_duration));
+    event.insert("pid", 1);
+    event.insert("tid", _tid);
+    _events.append(event);
+}
+
+QString
+csvField(const QString& _value) {
+    QString value = _value;
+    return "\"" + value.replace("\"", "\"\"") + "\"";
+}
+}
+
+void
+RequestTrace::setEnabled(bool _enabled) {
+    traceClock();
+    gEnabled.store(_enabled ? 1 : 0);
+}
+
+bool
+RequestTrace::isEnabled() {
+    return gEnabled.load() != 0;
+}
+
+void
+RequestTrace::setCapacity(int _capacity) {
+    QMutexLocker locker(&gMutex);
+    gCapacity = qMax(1, _capacity);
+    while (gSpans.length() > gCapacity) {
+        gSpans.removeFirst();
+        gSpanIds.removeFirst();
+    }
+}
+
+qint64
+RequestTrace::nowUsecs() {
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+void
+RequestTrace::record(const TraceSpan& _span) {
+    QMutexLocker locker(&gMutex);
+    if (gSpans.length() >= gCapacity) {
+        gSpans.removeFirst();
+        gSpanIds.removeFirst();
+    }
+    gSpans.append(_span);
+    gSpanIds.append(++gLastSpanId);
+    tLastRecorded = gLastSpanId;
+}
+
+QList<TraceSpan>
+RequestTrace::spans() {
+    QMutexLocker locker(&gMutex);
+    return gSpans;
+}
+
+void
+RequestTrace::clear() {
+    QMutexLocker locker(&gMutex);
+    gSpans.clear();
+    gSpanIds.clear();
+}
+
+quint64
+RequestTrace::lastRecorded() {
+    return tLastRecorded;
+}
+
+void
+RequestTrace::setApplyUsecs(quint64 _span, qint64 _usecs) {
+    QMutexLocker locker(&gMutex);
+    // a recent span, searched from the end
+    for (int i = gSpanIds.length() - 1; i >= 0; i--) {
+        if (gSpanIds.at(i) == _span) {
+            gSpans[i].applyUsecs = _usecs;
+            return;
+        }
+        if (gSpanIds.at(i) < _span)
+            return;
+    }
+}
+
+void
+RequestTrace::watch(QNetworkReply* _reply, const TraceSpan& _span) {
+    if (_reply == NULL)
+        return;
+    {
+        QMutexLocker locker(&gMutex);
+        gWatched[_reply].span = _span;
+    }
+    QObject::connect(
+        _reply,
+        &QNetworkReply::uploadProgress,
+        [_reply](qint64 _sent, qint64 _total) {
+            QMutexLocker locker(&gMutex);
+            auto         watched = gWatched.find(_reply);
+            if (watched != gWatched.end() && _sent == _total &&
+                watched->sentUsecs < 0)
+                watched->sentUsecs = nowUsecs();
+        });
+    QObject::connect(_reply, &QNetworkReply::metaDataChanged, [_reply]() {
+        QMutexLocker locker(&gMutex);
+        auto         watched = gWatched.find(_reply);
+        if (watched != gWatched.end() && watched->headersUsecs < 0)
+            watched->headersUsecs = nowUsecs();
+    });
+    QObject::connect(_reply, &QNetworkReply::finished, [_reply]() {
+        QMutexLocker locker(&gMutex);
+        auto         watched = gWatched.find(_reply);
+        if (watched != gWatched.end())
+            watched->finishedUsecs = nowUsecs();
+    });
+    QObject::connect(_reply, &QObject::destroyed, [_reply]() {
+        QMutexLocker locker(&gMutex);
+        gWatched.remove(_reply);
+    });
+}
+
+TraceSpan
+RequestTrace::take(QNetworkReply* _reply) {
+    Watched watched;
+    {
+        QMutexLocker locker(&gMutex);
+        watched = gWatched.take(_reply);
+    }
+    TraceSpan& span = watched.span;
+    if (span.startUsecs < 0)
+        return span;
+    span.httpStatus =
+        _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (watched.finishedUsecs < 0)
+        watched.finishedUsecs = nowUsecs();
+    qint64 sent        = watched.sentUsecs;
+    span.connectUsecs  = since(span.postUsecs, sent);
+    span.ttfbUsecs     = since(sent < 0 ? span.postUsecs : sent,
+                               watched.headersUsecs);
+    span.downloadUsecs = since(watched.headersUsecs, watched.finishedUsecs);
+    return span;
+}
+
+QByteArray
+RequestTrace::toChromeTrace() {
+    QList<TraceSpan>    spans = RequestTrace::spans();
+    QHash<QString, int> tids;
+    QJsonArray          events;
+    foreach (const TraceSpan& span, spans) {
+        if (!tids.contains(span.device)) {
+            int tid = tids.size() + 1;
+            tids.insert(span.device, tid);
+            QJsonObject name;
+            name.insert("name", "thread_name");
+            name.insert("ph", "M");
+            name.insert("pid", 1);
+            name.insert("tid", tid);
+            name.insert("args", QJsonObject{{"name", span.device}});
+            events.append(name);
+        }
+        int tid = tids.value(span.device);
+
+        // phases are laid out back to back from the times that were seen
+        qint64 at = span.startUsecs;
+        appendPhase(events, "digest", at, span.digestUsecs, tid);
+        at += qMax<qint64>(0, span.digestUsecs);
+        appendPhase(events, "build", at, span.buildUsecs, tid);
+        at = span.postUsecs < 0 ? at : span.postUsecs;
+        appendPhase(events, "connect", at, span.connectUsecs, tid);
+        at += qMax<qint64>(0, span.connectUsecs);
+        appendPhase(events, "ttfb", at, span.ttfbUsecs, tid);
+        at += qMax<qint64>(0, span.ttfbUsecs);
+        appendPhase(events, "download", at, span.downloadUsecs, tid);
+        at += qMax<qint64>(0, span.downloadUsecs);
+        appendPhase(events, "parse", at, span.parseUsecs, tid);
+        at += qMax<qint64>(0, span.parseUsecs);
+        appendPhase(events, "apply", at, span.applyUsecs, tid);
+        at += qMax<qint64>(0, span.applyUsecs);
+
+        QJsonObject request;
+        request.insert("name", span.operation);
+        request.insert("cat", span.service);
+        request.insert("ph", "X");
+        request.insert("ts", double(span.startUsecs));
+        request.insert("dur", double(at - span.startUsecs));
+        request.insert("pid", 1);
+        request.insert("tid", tid);
+        request.insert(
+            "args",
+            QJsonObject{
+                {"device", span.device},
+                {"service", span.service},
+                {"httpStatus", span.httpStatus}});
+        events.append(request);
+    }
+    QJsonObject trace;
+    trace.insert("traceEvents", events);
+    trace.insert("displayTimeUnit", "ms");
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+QByteArray
+RequestTrace::toCsv() {
+    QByteArray csv("start_us,device,service,operation,http_status,digest_us,"
+                   "build_us,connect_us,ttfb_us,download_us,parse_us,"
+                   "apply_us\n");
+    foreach (const TraceSpan& span, spans()) {
+        QStringList row;
+        row << QString::number(span.startUsecs) << csvField(span.device)
+            << csvField(span.service) << csvField(span.operation)
+            << QString::number(span.httpStatus)
+            << QString::number(span.digestUsecs)
+            << QString::number(span.buildUsecs)
+            << QString::number(span.connectUsecs)
+            << QString::number(span.ttfbUsecs)
+            << QString::number(span.downloadUsecs)
+            << QString::number(span.parseUsecs)
+            << QString::number(span.applyUsecs);
+        csv += row.join(',').toUtf8() + '\n';
+    }
+    return csv;
+}
+
+ApplyTrace::ApplyTrace()
+    : mStartUsecs(
+          RequestTrace::isEnabled() ? RequestTrace::nowUsecs() : qint64(-1)),
+      mSpan(RequestTrace::lastRecorded()) {}
+
+ApplyTrace::~ApplyTrace() {
+    if (mStartUsecs < 0 || mSpan == 0)
+        return;
+    RequestTrace::setApplyUsecs(mSpan, RequestTrace::nowUsecs() - mStartUsecs);
+}
@@ -0,0 +1,145 @@
+#include "responsestatus.h"
+#include "wiretrace.h"
+#include <QNetworkReply>
+#include <QStringList>
+#include <QXmlStreamReader>
+
+using namespace ONVIF;
+
+ResponseStatus::ResponseStatus() : mError(NoError), mHttpStatus(0) {}
+
+ResponseStatus
+ResponseStatus::fromReply(
+    QNetworkReply* _reply,
+    const QString& _expectedNamespace,
+    const QString& _expectedName) {
+    if (_reply == NULL) {
+        ResponseStatus status;
+        status.mError = NetworkError;
+        return status;
+    }
+    int httpStatus =
+        _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray body = _reply->readAll();
+    if (onvifWire().isDebugEnabled())
+        WireTrace::traceResponse(_reply, body);
+    _reply->deleteLater();
+    return classify(httpStatus, body, _expectedNamespace, _expectedName);
+}
+
+ResponseStatus
+ResponseStatus::classify(
+    int               _httpStatus,
+    const QByteArray& _body,
+    const QString&    _expectedNamespace,
+    const QString&    _expectedName) {
+    ResponseStatus status;
+    status.mHttpStatus = _httpStatus;
+    if (_httpStatus == 0 && _body.isEmpty()) {
+        status.mError = NetworkError;
+        return status;
+    }
+
+    QXmlStreamReader xml(_body);
+    bool             inBody = false;
+    while (!xml.atEnd() && !inBody) {
+        if (xml.readNext() == QXmlStreamReader::StartElement &&
+            xml.name() == QLatin1String("Body"))
+            inBody = true;
+    }
+    // first element of the Body, either the response or a Fault
+    while (inBody && !xml.atEnd() &&
+           xml.readNext() != QXmlStreamReader::StartElement) {
+        if (xml.isEndElement())
+            inBody = false;
+    }
+
+    if (!inBody || !xml.isStartElement()) {
+        if (_httpStatus == 401)
+            status.mError = NotAuthorized;
+        else if (_httpStatus >= 400)
+            status.mError = HttpError;
+        else
+            status.mError = MalformedResponse;
+        return status;
+    }
+
+    if (xml.name() != QLatin1String("Fault")) {
+        bool matches = xml.name() == _expectedName &&
+                       (_expectedNamespace.isEmpty() ||
+                        xml.namespaceUri() == _expectedNamespace);
+        if (!matches)
+            status.mError = UnexpectedResponse;
+        else if (_httpStatus >= 400)
+            status.mError = HttpError;
+        return status;
+    }
+
+    // soap 1.2 Code/Value, Code/Subcode/Value and Reason/Text, or soap 1.1
+    // faultcode and faultstring
+    QStringList path;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isEndElement()) {
+            if (path.isEmpty())
+                break;
+            path.removeLast();
+            continue;
+        }
+        if (!xml.isStartElement())
+            continue;
+
+        QString name = xml.name().toString();
+        if (name == "Value" && path.contains("Subcode")) {
+            if (status.mFaultSubcode.isEmpty())
+                status.mFaultSubcode = xml.readElementText().trimmed();
+            else
+                xml.skipCurrentElement();
+        } else if (name == "Value" || name == "faultcode") {
+            status.mFaultCode = xml.readElementText().trimmed();
+        } else if (
+            (name == "Text" && path.contains("Reason")) ||
+            name == "faultstring") {
+            status.mFaultReason = xml.readElementText().trimmed();
+        } else if (
+            name == "Code" || name == "Subcode" || name == "Reason") {
+            path.append(name);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    // ter:NotAuthorized, or the wsse:FailedAuthentication of WS-Security
+    // (as subcode, or the faultcode of soap 1.1)
+    if (_httpStatus == 401 ||
+        status.mFaultSubcode.endsWith(QLatin1String("NotAuthorized")) ||
+        status.mFaultSubcode.endsWith(QLatin1String("FailedAuthentication")) ||
+        status.mFaultCode.endsWith(QLatin1String("FailedAuthentication")))
+        status.mError = NotAuthorized;
+    else
+        status.mError = SoapFault;
+    return status;
+}
+
+QString
+ResponseStatus::errorString() const {
+    switch (mError) {
+    case NoError:
+        return QString();
+    case NetworkError:
+        return "no response from device";
+    case HttpError:
+        return QString("http status %1").arg(mHttpStatus);
+    case NotAuthorized:
+        return "not authorized";
+    case SoapFault:
+        return QString("soap fault %1 %2 %3")
+            .arg(mFaultCode, mFaultSubcode, mFaultReason)
+            .simplified();
+    case UnexpectedResponse:
+        return "unexpected response";
+    case MalformedResponse:
+        return "malformed response";
+    }
+    return QString();
+}
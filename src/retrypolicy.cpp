@@ -0,0 +1,128 @@
+#include "retrypolicy.h"
+#include <QNetworkReply>
+
+using namespace ONVIF;
+
+RetryPolicy::RetryPolicy()
+    : maxAttempts(3), baseDelayMs(200), maxDelayMs(5000) {}
+
+bool
+RetryPolicy::isIdempotent(const QString& _operation) {
+    // SetPreset without a token creates one, the factory default reboots
+    if (_operation == "SetPreset" || _operation == "SetSystemFactoryDefault")
+        return false;
+    return _operation.startsWith("Get") || _operation.startsWith("Set");
+}
+
+bool
+RetryPolicy::isTransient(QNetworkReply* _reply) {
+    if (_reply == NULL)
+        return false;
+    int httpStatus =
+        _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus != 0)
+        return httpStatus == 502 || httpStatus == 503 || httpStatus == 504;
+    // the camera was not reached or dropped the connection. a tls failure
+    // (a pin mismatch), a protocol error or our own abort would only fail
+    // again
+    switch (_reply->error()) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int
+RetryPolicy::delayMs(int _attempt) const {
+    qint64 ceiling = baseDelayMs;
+    for (int i = 0; i < _attempt && ceiling < maxDelayMs; i++)
+        ceiling *= 2;
+    ceiling = qMin<qint64>(ceiling, maxDelayMs);
+    if (ceiling <= 0)
+        return 0;
+    return int(qint64(qrand()) * (ceiling + 1) / (qint64(RAND_MAX) + 1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CircuitBreaker::CircuitBreaker()
+    : mState(Closed), mFailures(0), mThreshold(5), mBaseCooldownMs(10000),
+      mMaxCooldownMs(300000), mCooldownMs(10000), mProbing(false),
+      mOpenUntil(0) {
+    mClock.start();
+}
+
+void
+CircuitBreaker::setFailureThreshold(int _failures) {
+    mThreshold = qMax(1, _failures);
+}
+
+void
+CircuitBreaker::setCooldown(int _msecs, int _maxMsecs) {
+    mBaseCooldownMs = qMax(0, _msecs);
+    mMaxCooldownMs  = qMax(mBaseCooldownMs, _maxMsecs);
+    mCooldownMs     = mBaseCooldownMs;
+}
+
+CircuitBreaker::State
+CircuitBreaker::state() const {
+    if (mState == Open && mClock.elapsed() >= mOpenUntil)
+        return HalfOpen;
+    return mState;
+}
+
+int
+CircuitBreaker::consecutiveFailures() const {
+    return mFailures;
+}
+
+qint64
+CircuitBreaker::retryInMsecs() const {
+    if (mState != Open)
+        return 0;
+    return qMax<qint64>(0, mOpenUntil - mClock.elapsed());
+}
+
+bool
+CircuitBreaker::allowRequest() {
+    if (state() == Closed)
+        return true;
+    if (state() == Open || mProbing)
+        return false;
+    mState   = HalfOpen;
+    mProbing = true;
+    return true;
+}
+
+void
+CircuitBreaker::recordSuccess() {
+    mState      = Closed;
+    mFailures   = 0;
+    mCooldownMs = mBaseCooldownMs;
+    mProbing    = false;
+}
+
+void
+CircuitBreaker::recordFailure() {
+    mFailures++;
+    if (mState == HalfOpen) {
+        // the probe failed, wait longer before the next one
+        mCooldownMs = qMin(mCooldownMs * 2, mMaxCooldownMs);
+        open();
+    } else if (mState == Closed && mFailures >= mThreshold) {
+        open();
+    }
+}
+
+void
+CircuitBreaker::open() {
+    mState     = Open;
+    mProbing   = false;
+    mOpenUntil = mClock.elapsed() + mCooldownMs;
+}
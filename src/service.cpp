@@ -1,14 +1,45 @@
 #include "service.h"
-#include <QDebug>
+#include "elementstream.h"
+#include "metrics.h"
+#include "requesttrace.h"
+#include "wiretrace.h"
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFile>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QUrl>
 
 using namespace ONVIF;
 
+namespace {
+// a 401, or a fault a camera sends for a digest it does not accept
+bool
+isAuthFault(QNetworkReply* _reply) {
+    if (_reply == NULL)
+        return false;
+    int httpStatus =
+        _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus == 401)
+        return true;
+    if (httpStatus < 400)
+        return false;
+    QByteArray body = _reply->peek(_reply->bytesAvailable());
+    return body.contains("NotAuthorized") ||
+           body.contains("FailedAuthentication");
+}
+}
+
 Service::Service(
     const QString& wsdlUrl, const QString& username, const QString& password) {
-    mUsername = username;
-    mPassword = password;
-    mClient   = new Client(wsdlUrl);
+    mUsername  = username;
+    mPassword  = password;
+    mHost      = QUrl(wsdlUrl).host();
+    mClient      = new Client(wsdlUrl);
+    mScheduler   = NULL;
+    mBreaker     = NULL;
+    mClockOffset = NULL;
+    mClient->setCredentials(username, password);
 }
 
 Service::~Service() {
@@ -28,17 +59,432 @@ Service::sendMessage(Message* message, const QString& namespaceKey) {
     if (message == NULL) {
         return NULL;
     }
-    qDebug() << "REQQQQQQQ: " << message->toXmlStr(); // todolog
-    QString result = mClient->sendData(message->toXmlStr());
-    qDebug() << "RESSSSSSS: " << result;
-    if (result == "") {
+    QString   key    = flightKey(message);
+    FlightPtr flight = joinFlight(key);
+    if (flight && !flight->failed)
+        return parseFlight(flight, namespaceKey);
+    QNetworkReply* reply = postMessage(message);
+    startFlight(key, reply);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readMessage(retry(message, key, reply), namespaceKey);
+}
+
+QList<MessageParser*>
+Service::sendMessages(
+    const QList<Message*>& messages, const QString& namespaceKey) {
+    QList<QNetworkReply*> replies;
+    QList<FlightPtr>      joined;
+    foreach (Message* message, messages) {
+        QString   key    = flightKey(message);
+        FlightPtr flight = mFlights.value(key);
+        if (flight) {
+            flight->followers++;
+            joined.append(flight);
+            replies.append(flight->reply);
+        } else {
+            QNetworkReply* reply = postMessage(message);
+            joined.append(FlightPtr());
+            replies.append(reply);
+            startFlight(key, reply);
+        }
+    }
+    Client::waitForReplies(replies);
+
+    // the failed ones are sent again one after the other
+    QList<MessageParser*> parsers;
+    for (int i = 0; i < replies.size(); i++) {
+        Message* message = messages.at(i);
+        if (joined.at(i) && !joined.at(i)->failed) {
+            parsers.append(parseFlight(joined.at(i), namespaceKey));
+        } else if (joined.at(i)) {
+            parsers.append(sendMessage(message, namespaceKey));
+        } else {
+            QNetworkReply* reply =
+                retry(message, flightKey(message), replies.at(i));
+            parsers.append(readMessage(reply, namespaceKey));
+        }
+    }
+    return parsers;
+}
+
+QString
+Service::flightKey(Message* message) const {
+    // only reads are shared, commands always reach the camera
+    if (message == NULL || !message->operation().startsWith("Get"))
+        return QString();
+    return message->bodyXml();
+}
+
+Service::FlightPtr
+Service::joinFlight(const QString& key) {
+    FlightPtr flight = mFlights.value(key);
+    if (flight) {
+        flight->followers++;
+        Client::waitForReplies(QList<QNetworkReply*>() << flight->reply);
+    }
+    return flight;
+}
+
+Service::FlightPtr
+Service::startFlight(const QString& key, QNetworkReply* reply) {
+    if (key.isEmpty() || reply == NULL)
+        return FlightPtr();
+    FlightPtr flight(new Flight);
+    flight->reply = reply;
+    mFlights.insert(key, flight);
+    // runs before the sender reads the reply: the sender only returns from
+    // its event loop after the followers nested in it
+    connect(reply, &QNetworkReply::finished, this, [this, key, flight]() {
+        // the sender answers a challenge or signs again after an auth
+        // fault, the followers send their own rather than share the refusal
+        flight->failed = RetryPolicy::isTransient(flight->reply) ||
+                         Client::isChallenge(flight->reply) ||
+                         isAuthFault(flight->reply);
+        if (flight->followers > 0)
+            flight->response = flight->consumed +
+                               flight->reply->peek(
+                                   flight->reply->bytesAvailable());
+        flight->reply = NULL;
+        if (mFlights.value(key) == flight)
+            mFlights.remove(key);
+    });
+    return flight;
+}
+
+QNetworkReply*
+Service::retry(
+    Message* message, const QString& key, QNetworkReply* reply, int attempt) {
+    bool resigned = false;
+    bool answered = false;
+    forever {
+        // the request was refused before it was carried out, any operation
+        // may go again
+        bool answer = !answered && Client::isChallenge(reply);
+        bool resign = !answer && !resigned && mClockOffset != NULL &&
+                      isAuthFault(reply) && mClockOffset->remeasure();
+        if (!answer && !resign && !shouldRetry(message, reply, attempt))
+            return reply;
+        TraceSpan span;
+        if (RequestTrace::isEnabled())
+            span = RequestTrace::take(reply);
+        if (span.startUsecs >= 0)
+            RequestTrace::record(span);
+        reply->deleteLater();
+        Metrics::requestRetried();
+
+        if (answer) {
+            // the client took the challenge, it is answered by the post
+            answered = true;
+        } else if (resign) {
+            resigned = true;
+            message->setUserInfo(
+                mUsername, mPassword, mClockOffset->lastOffsetMsecs());
+        } else {
+            QEventLoop loop;
+            QTimer::singleShot(
+                mRetryPolicy.delayMs(attempt - 1), &loop, SLOT(quit()));
+            loop.exec();
+            attempt++;
+        }
+
+        reply = postMessage(message);
+        if (reply == NULL)
+            return NULL;
+        startFlight(key, reply);
+        Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    }
+}
+
+bool
+Service::shouldRetry(
+    Message* message, QNetworkReply* reply, int attempt) const {
+    if (reply == NULL || attempt >= mRetryPolicy.maxAttempts ||
+        !RetryPolicy::isTransient(reply) ||
+        !RetryPolicy::isIdempotent(message->operation()))
+        return false;
+    // the device is given up on, no use to wait for the next attempt
+    return mBreaker == NULL || mBreaker->state() == CircuitBreaker::Closed;
+}
+
+MessageParser*
+Service::parseFlight(FlightPtr flight, const QString& namespaceKey) {
+    Metrics::requestCoalesced();
+    if (flight->response.isEmpty())
+        return NULL;
+    QHash<QString, QString> names = namespaces(namespaceKey);
+    return new MessageParser(flight->response, names);
+}
+
+QNetworkReply*
+Service::postMessage(Message* message, const QString& address) {
+    if (message == NULL) {
+        return NULL;
+    }
+    if (mBreaker != NULL && !mBreaker->allowRequest()) {
+        Metrics::requestRejected();
         return NULL;
     }
+    // time spent queued shows in the trace between start and post
+    RequestScheduler::Priority priority =
+        RequestScheduler::classify(serviceName(), message->operation());
+    if (mScheduler != NULL)
+        mScheduler->acquire(priority);
+    QByteArray     request = message->toXml();
+    QNetworkReply* reply   = mClient->postData(
+        request,
+        address.isEmpty() ? mClient->url() : address,
+        priority == RequestScheduler::Interactive
+            ? QNetworkRequest::HighPriority
+            : priority == RequestScheduler::Inventory
+                  ? QNetworkRequest::LowPriority
+                  : QNetworkRequest::NormalPriority);
+    if (mScheduler != NULL)
+        mScheduler->releaseOn(reply);
+    if (mClockOffset != NULL) {
+        // the next message measures again, a synchronous sender already
+        // does in retry()
+        ClockOffset* offset = mClockOffset;
+        connect(reply, &QNetworkReply::finished, this, [offset, reply]() {
+            // a Digest challenge says nothing about our clock
+            if (isAuthFault(reply) && !Client::isChallenge(reply))
+                offset->invalidate();
+        });
+    }
+    if (mBreaker != NULL) {
+        CircuitBreaker* breaker = mBreaker;
+        connect(reply, &QNetworkReply::finished, this, [breaker, reply]() {
+            if (RetryPolicy::isTransient(reply))
+                breaker->recordFailure();
+            else
+                breaker->recordSuccess();
+        });
+    }
+    if (RequestTrace::isEnabled() && message->createdUsecs() >= 0) {
+        TraceSpan span;
+        span.device      = mHost;
+        span.service     = serviceName();
+        span.operation   = message->operation();
+        span.startUsecs  = message->createdUsecs();
+        span.postUsecs   = RequestTrace::nowUsecs();
+        span.digestUsecs = message->digestUsecs();
+        span.buildUsecs  = message->buildUsecs();
+        RequestTrace::watch(reply, span);
+    }
+
+    Metrics::requestStarted(mHost, request.size());
+    QString                host      = mHost;
+    QString                operation = message->operation();
+    QElapsedTimer          timer;
+    QSharedPointer<qint64> received(new qint64(0));
+    timer.start();
+    connect(
+        reply,
+        &QNetworkReply::downloadProgress,
+        [received](qint64 bytesReceived, qint64) {
+            *received = bytesReceived;
+        });
+    connect(reply, &QNetworkReply::finished, [=]() {
+        QNetworkReply::NetworkError error = reply->error();
+        Metrics::requestFinished(
+            host,
+            operation,
+            timer.nsecsElapsed() / 1000,
+            *received,
+            error != QNetworkReply::NoError,
+            error == QNetworkReply::TimeoutError ||
+                error == QNetworkReply::OperationCanceledError);
+    });
+    return reply;
+}
+
+void
+Service::setServiceAddress(const QString& wsdlUrl) {
+    mHost = QUrl(wsdlUrl).host();
+    mClient->setUrl(wsdlUrl);
+}
+
+QString
+Service::serviceAddress() const {
+    return mClient->url();
+}
+
+void
+Service::shareNetworkAccessManager(QNetworkAccessManager* manager) {
+    mClient->shareNetworkAccessManager(manager);
+}
+
+void
+Service::setTlsTrust(const TlsTrust& trust) {
+    mClient->setTlsTrust(trust);
+}
+
+void
+Service::setCredentials(const QString& username, const QString& password) {
+    mUsername = username;
+    mPassword = password;
+    mClient->setCredentials(username, password);
+}
+
+void
+Service::setScheduler(RequestScheduler* scheduler) {
+    mScheduler = scheduler;
+}
+
+void
+Service::setRetryPolicy(const RetryPolicy& policy) {
+    mRetryPolicy = policy;
+}
+
+void
+Service::setCircuitBreaker(CircuitBreaker* breaker) {
+    mBreaker = breaker;
+}
+
+void
+Service::setClockOffset(ClockOffset* offset) {
+    mClockOffset = offset;
+}
+
+void
+Service::setAuthentication(Data::Authentication* authentication) {
+    mClient->setAuthentication(authentication);
+}
+
+MessageParser*
+Service::readMessage(QNetworkReply* reply, const QString& namespaceKey) {
+    TraceSpan span;
+    if (RequestTrace::isEnabled() && reply != NULL)
+        span = RequestTrace::take(reply);
+    QByteArray result = Client::readReply(reply);
+    if (result.isEmpty()) {
+        if (span.startUsecs >= 0)
+            RequestTrace::record(span);
+        return NULL;
+    }
+    QHash<QString, QString> names  = namespaces(namespaceKey);
+    MessageParser*          parser = new MessageParser(result, names);
+    if (span.startUsecs >= 0)
+        parser->setTrace(span);
+    return parser;
+}
+
+ResponseStatus
+Service::sendCommand(Message* message, const QString& responseElement) {
+    QNetworkReply* reply = postMessage(message);
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    return readStatus(retry(message, QString(), reply), responseElement);
+}
+
+ResponseStatus
+Service::readStatus(QNetworkReply* reply, const QString& responseElement) {
+    TraceSpan span;
+    if (RequestTrace::isEnabled() && reply != NULL)
+        span = RequestTrace::take(reply);
+    qint64 parseStart = span.startUsecs < 0 ? -1 : RequestTrace::nowUsecs();
+    ResponseStatus status = ResponseStatus::fromReply(
+        reply,
+        namespaceUri(responseElement),
+        responseElement.section(':', -1));
+    if (parseStart >= 0) {
+        span.parseUsecs = RequestTrace::nowUsecs() - parseStart;
+        RequestTrace::record(span);
+    }
+    return status;
+}
+
+bool
+Service::streamMessage(
+    Message*                            message,
+    const QString&                      element,
+    std::function<void(MessageParser*)> onElement,
+    const QString&                      namespaceKey) {
     QHash<QString, QString> names = namespaces(namespaceKey);
-    return new MessageParser(result, names);
+    ElementStream           stream(
+        namespaceUri(element, namespaceKey), element.section(':', -1));
+    QString   key    = flightKey(message);
+    FlightPtr joined = joinFlight(key);
+    if (joined && !joined->failed) {
+        Metrics::requestCoalesced();
+        stream.addData(joined->response);
+        foreach (const QByteArray& data, stream.takeElements()) {
+            MessageParser parser(data, names);
+            onElement(&parser);
+        }
+        return stream.isFinished() && !stream.hasError();
+    }
+
+    QNetworkReply* reply = postMessage(message);
+    if (reply == NULL) {
+        return false;
+    }
+    FlightPtr flight = startFlight(key, reply);
+
+    bool   traced     = RequestTrace::isEnabled();
+    qint64 parseUsecs = 0;
+    qint64 fed        = 0;
+    auto   feed       = [&](bool _complete) {
+        // a challenge or a fault stays in the reply for retry() to look at
+        int httpStatus =
+            reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (!_complete && (httpStatus < 200 || httpStatus >= 300))
+            return;
+        QByteArray chunk = reply->readAll();
+        fed += chunk.size();
+        if (flight)
+            flight->consumed.append(chunk);
+        if (onvifWire().isDebugEnabled())
+            WireTrace::traceResponse(reply, chunk);
+        qint64 parseStart = traced ? RequestTrace::nowUsecs() : 0;
+        stream.addData(chunk);
+        foreach (const QByteArray& data, stream.takeElements()) {
+            MessageParser parser(data, names);
+            onElement(&parser);
+        }
+        if (traced)
+            parseUsecs += RequestTrace::nowUsecs() - parseStart;
+    };
+    QMetaObject::Connection connection =
+        connect(reply, &QNetworkReply::readyRead, this, [&]() { feed(false); });
+    Client::waitForReplies(QList<QNetworkReply*>() << reply);
+    disconnect(connection);
+    // only sent again when onElement has not seen anything yet, the
+    // response of the retry is parsed once it is complete
+    if (fed == 0) {
+        reply = retry(message, key, reply);
+        if (reply == NULL)
+            return false;
+    }
+    feed(true);
+    if (traced) {
+        // parsing overlaps the download here
+        TraceSpan span = RequestTrace::take(reply);
+        span.parseUsecs = parseUsecs;
+        if (span.startUsecs >= 0)
+            RequestTrace::record(span);
+    }
+    reply->deleteLater();
+    return stream.isFinished() && !stream.hasError();
 }
 
 Message*
 Service::createMessage(QHash<QString, QString>& namespaces) {
-    return Message::getMessageWithUserInfo(namespaces, mUsername, mPassword);
+    qint64 offset = mClockOffset != NULL ? mClockOffset->offsetMsecs() : 0;
+    return Message::getMessageWithUserInfo(
+        namespaces, mUsername, mPassword, offset);
+}
+
+QString
+Service::serviceName() const {
+    QString name = metaObject()->className();
+    return name.section("::", -1).remove("Management");
+}
+
+QString
+Service::namespaceUri(
+    const QString& qualifiedName, const QString& namespaceKey) {
+    QString prefix = qualifiedName.section(':', 0, -2);
+    if (prefix.isEmpty()) {
+        return "";
+    }
+    return namespaces(namespaceKey).value(prefix);
 }
@@ -0,0 +1,61 @@
+#include "timerwheel.h"
+
+using namespace ONVIF;
+
+TimerWheel::TimerWheel(int _tickMs)
+    : mTickMs(qMax(1, _tickMs)), mTick(0), mSize(0) {}
+
+int
+TimerWheel::tickMs() const {
+    return mTickMs;
+}
+
+int
+TimerWheel::horizon() {
+    return 255 * 256;
+}
+
+void
+TimerWheel::schedule(quint64 _cookie, qint64 _delayMs) {
+    qint64 ticks = (qMax<qint64>(0, _delayMs) + mTickMs - 1) / mTickMs;
+    Timer  timer = {_cookie, mTick + qBound<qint64>(1, ticks, horizon())};
+    insert(timer);
+    mSize++;
+}
+
+QVector<quint64>
+TimerWheel::advance(qint64 _nowMs) {
+    QVector<quint64> expired;
+    qint64           target = _nowMs / mTickMs;
+    while (mTick < target) {
+        mTick++;
+        // a new round of the inner wheel, the outer slot of its 256 ticks
+        // is spread over it
+        if ((mTick & 255) == 0) {
+            QVector<Timer> later;
+            later.swap(mOuter[(mTick >> 8) & 255]);
+            foreach (const Timer& timer, later)
+                insert(timer);
+        }
+        QVector<Timer>& slot = mInner[mTick & 255];
+        foreach (const Timer& timer, slot)
+            expired.append(timer.cookie);
+        mSize -= slot.size();
+        // keeps the capacity, the slot fills again next round
+        slot.resize(0);
+    }
+    return expired;
+}
+
+int
+TimerWheel::size() const {
+    return mSize;
+}
+
+void
+TimerWheel::insert(const Timer& _timer) {
+    if (_timer.due - mTick < 256)
+        mInner[_timer.due & 255].append(_timer);
+    else
+        mOuter[(_timer.due >> 8) & 255].append(_timer);
+}
@@ -0,0 +1,102 @@
+#include "tlssessions.h"
+#include <QCryptographicHash>
+#include <QHash>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QSslConfiguration>
+#include <QSslKey>
+#include <QUrl>
+
+using namespace ONVIF;
+
+namespace {
+// session tickets by "host:port", shared by the devices of all threads and
+// only touched under ticketsMutex()
+QHash<QString, QByteArray>&
+tickets() {
+    static QHash<QString, QByteArray> all;
+    return all;
+}
+
+QMutex&
+ticketsMutex() {
+    static QMutex mutex;
+    return mutex;
+}
+
+QString
+hostKey(const QUrl& _url) {
+    return _url.host().toLower() + ':' + QString::number(_url.port(443));
+}
+
+bool
+isPinned(QNetworkReply* _reply, const TlsTrust& _trust) {
+    return _trust.pins.contains(
+        TlsSessions::pin(_reply->sslConfiguration().peerCertificate()));
+}
+}
+
+void
+TlsSessions::prepare(QNetworkRequest& _request) {
+    if (_request.url().scheme() != "https")
+        return;
+    QSslConfiguration configuration = _request.sslConfiguration();
+    configuration.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+    configuration.setSslOption(
+        QSsl::SslOptionDisableSessionPersistence, false);
+    QByteArray ticket;
+    {
+        QMutexLocker locker(&ticketsMutex());
+        ticket = tickets().value(hostKey(_request.url()));
+    }
+    if (!ticket.isEmpty())
+        configuration.setSessionTicket(ticket);
+    _request.setSslConfiguration(configuration);
+}
+
+void
+TlsSessions::watch(QNetworkReply* _reply, const TlsTrust& _trust) {
+    if (_reply == NULL || _reply->url().scheme() != "https")
+        return;
+    TlsTrust trust = _trust;
+    QObject::connect(
+        _reply,
+        &QNetworkReply::sslErrors,
+        _reply,
+        [_reply, trust](const QList<QSslError>&) {
+            if (trust.trustAny ||
+                (!trust.pins.isEmpty() && isPinned(_reply, trust)))
+                _reply->ignoreSslErrors();
+        });
+    QObject::connect(
+        _reply, &QNetworkReply::encrypted, _reply, [_reply, trust]() {
+            if (!trust.trustAny && !trust.pins.isEmpty() &&
+                !isPinned(_reply, trust)) {
+                _reply->abort();
+                return;
+            }
+            QByteArray ticket = _reply->sslConfiguration().sessionTicket();
+            if (ticket.isEmpty())
+                return;
+            QString      key = hostKey(_reply->url());
+            QMutexLocker locker(&ticketsMutex());
+            if (tickets().size() >= kMaxHosts && !tickets().contains(key))
+                tickets().clear();
+            tickets().insert(key, ticket);
+        });
+}
+
+void
+TlsSessions::clear() {
+    QMutexLocker locker(&ticketsMutex());
+    tickets().clear();
+}
+
+QByteArray
+TlsSessions::pin(const QSslCertificate& _certificate) {
+    if (_certificate.isNull())
+        return QByteArray();
+    return QCryptographicHash::hash(
+               _certificate.publicKey().toDer(), QCryptographicHash::Sha256)
+        .toBase64();
+}
@@ -0,0 +1,75 @@
+#include "wiretrace.h"
+#include <QAtomicInt>
+#include <QNetworkReply>
+#include <QRegularExpression>
+
+Q_LOGGING_CATEGORY(onvifWire, "onvif.wire", QtWarningMsg)
+
+using namespace ONVIF;
+
+namespace {
+QAtomicInt  gSampling(1);
+QAtomicInt  gMaxBytes(4096);
+QAtomicInt  gExchanges(0);
+const char* kSampledProperty = "onvifWireSampled";
+
+// the ws-security header (username, password digest, nonce) is cut out
+// before the payload is, an unclosed one up to the end
+QString
+redacted(const QString& _body) {
+    static const QRegularExpression security(
+        "<((?:\\w+:)?)Security\\b[^>]*(?<!/)>.*?(</\\1Security>|$)",
+        QRegularExpression::DotMatchesEverythingOption);
+    QString body = _body;
+    return body.replace(security, "<\\1Security>[redacted]</\\1Security>");
+}
+
+void
+trace(const char* _direction, QNetworkReply* _reply, const QByteArray& _body) {
+    int     max  = gMaxBytes.load();
+    QString line = QString("%1 url=%2 bytes=%3")
+                       .arg(_direction)
+                       .arg(_reply->url().toString())
+                       .arg(_body.size());
+    // the scheme of an http authorization, never its value
+    QByteArray authorization = _reply->request().rawHeader("Authorization");
+    if (!authorization.isEmpty())
+        line += " authorization=" +
+                QString::fromLatin1(authorization.split(' ').first()) +
+                " [redacted]";
+    if (max > 0) {
+        QString body = redacted(QString::fromUtf8(_body));
+        line += " body=" + body.left(max);
+        if (body.size() > max)
+            line += " [truncated]";
+    }
+    qCDebug(onvifWire).noquote() << line;
+}
+}
+
+void
+WireTrace::setSampling(int _every) {
+    gSampling.store(qMax(0, _every));
+}
+
+void
+WireTrace::setMaxBytes(int _maxBytes) {
+    gMaxBytes.store(qMax(0, _maxBytes));
+}
+
+void
+WireTrace::traceRequest(QNetworkReply* _reply, const QByteArray& _body) {
+    int every = gSampling.load();
+    if (_reply == NULL || every == 0 ||
+        gExchanges.fetchAndAddRelaxed(1) % every != 0)
+        return;
+    _reply->setProperty(kSampledProperty, true);
+    trace("request", _reply, _body);
+}
+
+void
+WireTrace::traceResponse(QNetworkReply* _reply, const QByteArray& _body) {
+    if (_reply == NULL || !_reply->property(kSampledProperty).toBool())
+        return;
+    trace("response", _reply, _body);
+}
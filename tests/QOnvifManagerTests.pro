@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Regression tests against the in-process camera simulator
+#
+#   QOnvifManagerTests
+#
+#-------------------------------------------------
+
+QT       += core network xml xmlpatterns testlib
+QT       -= gui
+
+CONFIG   += c++11 console testcase
+CONFIG   -= app_bundle
+
+QMAKE_RPATHDIR += .
+
+DESTDIR  = ../../../bin
+TARGET = QOnvifManagerTests
+TEMPLATE = app
+
+# the corpus shared with the benchmarks and the simulator
+DEFINES += FIXTURES_DIR=\\\"$$PWD/../bench/fixtures\\\"
+
+SOURCES += \
+    qonvifmanagertests.cpp
+
+LIBS += -L$$PWD/../../../bin/ -lQOnvifManager -lQOnvifSimulator
+
+INCLUDEPATH += $$PWD/../include
+INCLUDEPATH += $$PWD/../include/QOnvifManager
+INCLUDEPATH += $$PWD/../include/QOnvifManager/device_management
+INCLUDEPATH += $$PWD/../sim
+DEPENDPATH += $$PWD/../include
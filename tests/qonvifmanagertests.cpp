@@ -0,0 +1,387 @@
+#include "camerasimulator.hpp"
+#include "devicesnapshot.h"
+#include "httpdigest.h"
+#include "metrics.h"
+#include "qonvifdevice.hpp"
+#include "requestscheduler.h"
+#include "responsestatus.h"
+#include "timerwheel.h"
+#include <QtTest>
+
+using namespace device;
+using namespace ONVIF;
+
+namespace {
+const char* kUsername = "admin";
+const char* kPassword = "test-password";
+
+// the example of RFC 7616 section 3.9.1
+const char* kDigestChallenge =
+    "Digest realm=\"http-auth@example.org\", qop=\"auth, auth-int\", "
+    "algorithm=%1, nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcCAzFZH4GiTo0v\", "
+    "opaque=\"FQhe/qaU925kfnzjCev0ciny7QMkPqMAFRtzCUYo5tdS\"";
+const char* kDigestNonce  = "7ypf/xlj9XXwfDPEoM4URrv/xwf94BcCAzFZH4GiTo0v";
+const char* kDigestCnonce = "f2/wE4q74E6zIJEtWaHKaf5wv/H5QzzpXusqGemxURZJ";
+
+QByteArray
+digestChallenge(const QString& _algorithm) {
+    return QString(kDigestChallenge).arg(_algorithm).toUtf8();
+}
+
+QByteArray
+soap12Fault(const QString& _code, const QString& _subcode) {
+    return QString(
+               "<env:Envelope "
+               "xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\" "
+               "xmlns:ter=\"http://www.onvif.org/ver10/error\" "
+               "xmlns:wsse=\"http://docs.oasis-open.org/wss/2004/01/"
+               "oasis-200401-wss-wssecurity-secext-1.0.xsd\">"
+               "<env:Body><env:Fault>"
+               "<env:Code><env:Value>%1</env:Value>"
+               "<env:Subcode><env:Value>%2</env:Value></env:Subcode>"
+               "</env:Code>"
+               "<env:Reason><env:Text xml:lang=\"en\">fault</env:Text>"
+               "</env:Reason>"
+               "</env:Fault></env:Body></env:Envelope>")
+        .arg(_code, _subcode)
+        .toUtf8();
+}
+
+QByteArray
+soap11Fault(const QString& _faultcode) {
+    return QString(
+               "<SOAP-ENV:Envelope "
+               "xmlns:SOAP-ENV=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+               "xmlns:wsse=\"http://docs.oasis-open.org/wss/2004/01/"
+               "oasis-200401-wss-wssecurity-secext-1.0.xsd\">"
+               "<SOAP-ENV:Body><SOAP-ENV:Fault>"
+               "<faultcode>%1</faultcode>"
+               "<faultstring>fault</faultstring>"
+               "</SOAP-ENV:Fault></SOAP-ENV:Body></SOAP-ENV:Envelope>")
+        .arg(_faultcode)
+        .toUtf8();
+}
+}
+
+class QOnvifManagerTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void interrogateWithFewSlots_data();
+    void interrogateWithFewSlots();
+    void authenticationFault_data();
+    void authenticationFault();
+    void snapshotCountBeyondData();
+    void coalescedDigestChallenge();
+    void stopDuringInventorySweep();
+    void prometheusBucketBounds();
+    void digestVectors_data();
+    void digestVectors();
+    void digestNonceCount();
+    void digestWithBasic();
+    void timerWheelTicks_data();
+    void timerWheelTicks();
+
+private:
+    CameraSimulator* isimulator = NULL;
+};
+
+void
+QOnvifManagerTests::initTestCase() {
+    SimulatorOptions options;
+    options.devices       = 1;
+    options.basePort      = 23000;
+    options.discoveryPort = 0;
+    options.fixturesDir   = FIXTURES_DIR;
+    isimulator            = new CameraSimulator(options, this);
+    QVERIFY2(isimulator->start(), qPrintable(isimulator->errorString()));
+}
+
+void
+QOnvifManagerTests::cleanupTestCase() {
+    isimulator->stop();
+}
+
+void
+QOnvifManagerTests::interrogateWithFewSlots_data() {
+    QTest::addColumn<int>("maxRequests");
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+}
+
+// the steps wait for a slot in event loops nested in each other, a slot
+// handed to a buried one used to stall the step above it for good
+void
+QOnvifManagerTests::interrogateWithFewSlots() {
+    QFETCH(int, maxRequests);
+    QOnvifDevice device(
+        isimulator->serviceAddress(0), kUsername, kPassword, NULL);
+    device.setMaxRequestsInFlight(maxRequests);
+
+    bool   returned = false;
+    QTimer watchdog;
+    watchdog.setSingleShot(true);
+    connect(&watchdog, &QTimer::timeout, [&returned]() {
+        if (!returned)
+            qFatal("interrogate() did not return");
+    });
+    watchdog.start(30000);
+    device.interrogate();
+    returned = true;
+
+    QVERIFY(!device.data().information.manufacturer.isEmpty());
+    QVERIFY(!device.data().profiles.toKenPro.isEmpty());
+}
+
+void
+QOnvifManagerTests::authenticationFault_data() {
+    QTest::addColumn<int>("httpStatus");
+    QTest::addColumn<QByteArray>("body");
+    QTest::addColumn<int>("error");
+    QTest::newRow("ter:NotAuthorized")
+        << 400 << soap12Fault("env:Sender", "ter:NotAuthorized")
+        << int(ResponseStatus::NotAuthorized);
+    QTest::newRow("wsse:FailedAuthentication subcode")
+        << 400 << soap12Fault("env:Sender", "wsse:FailedAuthentication")
+        << int(ResponseStatus::NotAuthorized);
+    QTest::newRow("wsse:FailedAuthentication soap 1.1")
+        << 500 << soap11Fault("wsse:FailedAuthentication")
+        << int(ResponseStatus::NotAuthorized);
+    QTest::newRow("ter:InvalidArgVal")
+        << 400 << soap12Fault("env:Sender", "ter:InvalidArgVal")
+        << int(ResponseStatus::SoapFault);
+}
+
+// the credential checks take any fault but NotAuthorized as accepted
+void
+QOnvifManagerTests::authenticationFault() {
+    QFETCH(int, httpStatus);
+    QFETCH(QByteArray, body);
+    QFETCH(int, error);
+    ResponseStatus status = ResponseStatus::classify(
+        httpStatus, body, QString(), "GetDeviceInformationResponse");
+    QCOMPARE(int(status.error()), error);
+}
+
+// a corrupt count must not size an allocation
+void
+QOnvifManagerTests::snapshotCountBeyondData() {
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << DeviceSnapshot::kMagic << DeviceSnapshot::kFormatVersion
+           << quint32(0x7fffffff);
+    file.close();
+
+    QList<Data> devices;
+    QVERIFY(!DeviceSnapshot::load(file.fileName(), devices));
+    QVERIFY(devices.isEmpty());
+}
+
+// a read that joins the first request to a digest camera must not take
+// its 401 for the answer
+void
+QOnvifManagerTests::coalescedDigestChallenge() {
+    SimulatorOptions options;
+    options.devices         = 1;
+    options.basePort        = 23100;
+    options.discoveryPort   = 0;
+    options.fixturesDir     = FIXTURES_DIR;
+    options.latencyMs       = 50; // the second refresh joins the first
+    options.digestChallenge = true;
+    CameraSimulator simulator(options);
+    QVERIFY2(simulator.start(), qPrintable(simulator.errorString()));
+
+    QOnvifDevice device(
+        simulator.serviceAddress(0), kUsername, kPassword, NULL);
+    bool followed = false, follower = false;
+    QTimer::singleShot(0, [&]() {
+        follower = device.refreshProfiles();
+        followed = true;
+    });
+    bool leader = device.refreshProfiles();
+    QTRY_VERIFY(followed);
+
+    QVERIFY(leader);
+    QVERIFY(follower);
+    QVERIFY(!device.data().profiles.toKenPro.isEmpty());
+    QVERIFY(simulator.stats().challenges > 0);
+    simulator.stop();
+}
+
+// a Stop issued while reads queue takes the slot they can not have
+void
+QOnvifManagerTests::stopDuringInventorySweep() {
+    RequestScheduler scheduler;
+    scheduler.setMaxInFlight(2);
+    scheduler.acquire(RequestScheduler::Inventory); // the sweep in flight
+
+    QStringList sent;
+    QTimer::singleShot(0, [&]() {
+        QCOMPARE(scheduler.queued(RequestScheduler::Inventory), 1);
+        scheduler.acquire(RequestScheduler::Interactive);
+        sent << "Stop";
+        scheduler.release();
+        // the first read of the sweep is done, the queued one may go
+        scheduler.release();
+    });
+    scheduler.acquire(RequestScheduler::Inventory);
+    sent << "GetProfiles";
+    scheduler.release();
+
+    QCOMPARE(sent, QStringList() << "Stop" << "GetProfiles");
+    QCOMPARE(scheduler.inFlight(), 0);
+}
+
+// the le buckets do not fall on histogram bucket bounds, the values of
+// the bucket holding the bound are not all left out
+void
+QOnvifManagerTests::prometheusBucketBounds() {
+    Metrics::reset();
+    // 4.5 ms to 5.5 ms: half of them not above le="0.005"
+    for (int usecs = 4500; usecs < 5500; usecs++)
+        Metrics::requestFinished(
+            "camera", "GetProfiles", usecs, 0, false, false);
+
+    QString text = QString::fromUtf8(Metrics::toPrometheus());
+    QRegularExpression bucket(
+        "onvif_request_duration_seconds_bucket\\{operation=\"GetProfiles\","
+        "le=\"0.005\"\\} (\\d+)");
+    QRegularExpressionMatch match = bucket.match(text);
+    QVERIFY2(match.hasMatch(), qPrintable(text));
+    QVERIFY(qAbs(match.captured(1).toInt() - 500) <= 50);
+    QVERIFY(text.contains("le=\"0.01\"} 1000"));
+    Metrics::reset();
+}
+
+void
+QOnvifManagerTests::digestVectors_data() {
+    QTest::addColumn<QString>("algorithm");
+    QTest::addColumn<QByteArray>("response");
+
+    QTest::newRow("MD5") << "MD5"
+                         << QByteArray("8ca523f5e9506fed4657c9700eebdbec");
+    QTest::newRow("SHA-256")
+        << "SHA-256"
+        << QByteArray("753927fa0e85d155564e2e272a28d180"
+                      "2ca10daf4496794697cf8db5856cb6c1");
+}
+
+// the responses of the RFC, with its cnonce
+void
+QOnvifManagerTests::digestVectors() {
+    QFETCH(QString, algorithm);
+    QFETCH(QByteArray, response);
+    Data::Authentication auth = Data::Authentication();
+    QVERIFY(HttpDigest::setChallenge(auth, digestChallenge(algorithm)));
+    QCOMPARE(auth.qop, QString("auth"));
+
+    QByteArray header = HttpDigest::authorization(
+        auth,
+        "GET",
+        "/dir/index.html",
+        "Mufasa",
+        "Circle of Life",
+        kDigestCnonce);
+    QVERIFY2(
+        header.contains("response=\"" + response + "\""),
+        header.constData());
+    QVERIFY(header.contains("nc=00000001"));
+    QVERIFY(header.contains(
+        "opaque=\"FQhe/qaU925kfnzjCev0ciny7QMkPqMAFRtzCUYo5tdS\""));
+}
+
+// the nonce is reused with a growing nc until a stale challenge replaces it
+void
+QOnvifManagerTests::digestNonceCount() {
+    Data::Authentication auth = Data::Authentication();
+    QVERIFY(HttpDigest::setChallenge(auth, digestChallenge("MD5")));
+    QVERIFY(HttpDigest::authorization(auth, "POST", "/onvif", "a", "b")
+                .contains("nc=00000001"));
+    QVERIFY(HttpDigest::authorization(auth, "POST", "/onvif", "a", "b")
+                .contains("nc=00000002"));
+
+    QVERIFY(HttpDigest::setChallenge(
+        auth,
+        "Digest realm=\"http-auth@example.org\", qop=\"auth\", "
+        "nonce=\"fresh\", stale=true"));
+    QByteArray header =
+        HttpDigest::authorization(auth, "POST", "/onvif", "a", "b");
+    QVERIFY2(header.contains("nc=00000001"), header.constData());
+    QVERIFY(header.contains("nonce=\"fresh\""));
+}
+
+// a device offering Basic too, in a header of its own or joined to the
+// Digest one
+void
+QOnvifManagerTests::digestWithBasic() {
+    Data::Authentication auth = Data::Authentication();
+    QVERIFY(!HttpDigest::setChallenge(auth, "Basic realm=\"cam\""));
+    QVERIFY(auth.scheme.isEmpty());
+    QVERIFY(auth.nonce.isEmpty());
+    QVERIFY(HttpDigest::setChallenge(auth, digestChallenge("MD5")));
+    QCOMPARE(auth.realm, QString("http-auth@example.org"));
+
+    auth = Data::Authentication();
+    QVERIFY(HttpDigest::setChallenge(
+        auth, "Basic realm=\"cam\", " + digestChallenge("MD5")));
+    QCOMPARE(auth.scheme, QString("Digest"));
+    QCOMPARE(auth.realm, QString("http-auth@example.org"));
+    QCOMPARE(auth.nonce, QString(kDigestNonce));
+
+    auth = Data::Authentication();
+    QVERIFY(HttpDigest::setChallenge(
+        auth, "Basic realm=\"cam\"\n" + digestChallenge("SHA-256")));
+    QCOMPARE(auth.algorithm, QString("SHA-256"));
+    QCOMPARE(auth.nonce, QString(kDigestNonce));
+}
+
+void
+QOnvifManagerTests::timerWheelTicks_data() {
+    QTest::addColumn<int>("start");
+
+    QTest::newRow("first round") << 200;
+    // the horizon lies past tick 65536, the outer wheel wraps on the way
+    QTest::newRow("outer wrap") << 1000;
+}
+
+// each timer expires on its tick, not a round of the inner wheel early or
+// late
+void
+QOnvifManagerTests::timerWheelTicks() {
+    QFETCH(int, start);
+    const int  tickMs = 10;
+    TimerWheel wheel(tickMs);
+    QVERIFY(wheel.advance(qint64(start) * tickMs).isEmpty());
+
+    QMap<qint64, QVector<quint64>> expected;
+    QList<int> delays;
+    delays << 1 << 255 << 256 << 257 << TimerWheel::horizon();
+    foreach (int delay, delays) {
+        wheel.schedule(delay, qint64(delay) * tickMs);
+        expected[start + delay] << quint64(delay);
+    }
+    // cut to the horizon
+    wheel.schedule(0, qint64(TimerWheel::horizon() + 1000) * tickMs);
+    expected[start + TimerWheel::horizon()] << 0;
+    QCOMPARE(wheel.size(), delays.size() + 1);
+
+    for (qint64 tick = start + 1; tick <= start + TimerWheel::horizon();
+         tick++) {
+        QVector<quint64> expired = wheel.advance(tick * tickMs);
+        if (expired != expected.value(tick))
+            QFAIL(qPrintable(QString("tick %1: %2 expired, %3 expected")
+                                 .arg(tick)
+                                 .arg(expired.size())
+                                 .arg(expected.value(tick).size())));
+    }
+    QCOMPARE(wheel.size(), 0);
+}
+
+QTEST_GUILESS_MAIN(QOnvifManagerTests)
+#include "qonvifmanagertests.moc"